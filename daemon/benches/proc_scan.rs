@@ -0,0 +1,125 @@
+//! Per-process cost of a full /proc scan.
+//!
+//! Builds synthetic proc trees with 5k and 20k PIDs and times
+//! `LinuxProcessCollector::list_processes`, serial and sharded across
+//! workers, against the previous `read_to_string` + `split_whitespace`
+//! parser. Run with:
+//!
+//!     cargo bench --bench proc_scan
+//!
+//! Pass `--live` to also scan the real /proc.
+
+use runaway_daemon::collector::{LinuxProcessCollector, ProcessCollector};
+use std::fs;
+use std::hint::black_box;
+use std::path::Path;
+use std::time::{Duration, Instant};
+
+const SIZES: [usize; 2] = [5_000, 20_000];
+const ITERATIONS: u32 = 20;
+const PARALLEL_WORKERS: [usize; 2] = [4, 16];
+
+fn build_tree(root: &Path, count: usize) {
+    fs::write(root.join("stat"), "cpu  1 2 3 4\nbtime 1700000000\n").unwrap();
+    for pid in 1..=count {
+        let dir = root.join(pid.to_string());
+        fs::create_dir(&dir).unwrap();
+        // Every eighth process has an awkward comm, like real browsers and wine
+        let comm = if pid % 8 == 0 { "Web Content (x)" } else { "worker" };
+        fs::write(
+            dir.join("stat"),
+            format!(
+                "{pid} ({comm}) S 1 {pid} {pid} 0 -1 4194560 1043 2890 0 0 \
+                 {} 7 3 1 20 0 1 0 {} 10182656 {} 18446744073709551615 1 1 0 0 0 0 \
+                 65536 3670020 1266777851 0 0 0 17 2 0 0 0 0 0\n",
+                pid * 3,
+                pid * 11,
+                pid % 4096,
+            ),
+        )
+        .unwrap();
+        fs::write(
+            dir.join("cmdline"),
+            format!("/usr/lib/worker\0--type=renderer\0--id={pid}\0"),
+        )
+        .unwrap();
+    }
+}
+
+/// The parser the collector used before the dirfd scanner, kept for comparison
+fn naive_scan(root: &Path) -> usize {
+    let mut count = 0;
+    for entry in fs::read_dir(root).unwrap().flatten() {
+        let Some(name) = entry.file_name().to_str().map(str::to_string) else { continue };
+        let Ok(pid) = name.parse::<u32>() else { continue };
+        let proc_path = format!("{}/{}", root.display(), pid);
+        let proc_dir = Path::new(&proc_path);
+        if !proc_dir.exists() {
+            continue;
+        }
+        let Ok(stat) = fs::read_to_string(proc_dir.join("stat")) else { continue };
+        let parts: Vec<&str> = stat.split_whitespace().collect();
+        if parts.len() < 24 {
+            continue;
+        }
+        let name = parts[1].trim_matches(|c| c == '(' || c == ')').to_string();
+        let cmdline = fs::read_to_string(proc_dir.join("cmdline"))
+            .unwrap_or_default()
+            .replace('\0', " ")
+            .trim()
+            .to_string();
+        black_box((name, cmdline, parts[13].parse::<u64>().ok()));
+        count += 1;
+    }
+    count
+}
+
+fn time<F: FnMut() -> usize>(mut f: F) -> (Duration, usize) {
+    // One warm-up pass so both variants see a hot dentry cache
+    let processes = f();
+    let start = Instant::now();
+    for _ in 0..ITERATIONS {
+        black_box(f());
+    }
+    (start.elapsed() / ITERATIONS, processes)
+}
+
+fn report(label: &str, elapsed: Duration, processes: usize) {
+    let per_process = elapsed.as_nanos() as f64 / processes.max(1) as f64;
+    println!(
+        "{:<28} {:>6} procs  {:>9.2} ms/scan  {:>8.0} ns/proc",
+        label,
+        processes,
+        elapsed.as_secs_f64() * 1000.0,
+        per_process
+    );
+}
+
+fn main() {
+    for &size in &SIZES {
+        let dir = tempfile::tempdir().unwrap();
+        build_tree(dir.path(), size);
+
+        let collector = LinuxProcessCollector::with_root(dir.path()).unwrap();
+        collector.set_workers(1);
+        let (elapsed, processes) = time(|| collector.list_processes().len());
+        report(&format!("dirfd scanner ({}k)", size / 1000), elapsed, processes);
+
+        for workers in PARALLEL_WORKERS {
+            collector.set_workers(workers);
+            let (elapsed, processes) = time(|| collector.list_processes().len());
+            report(&format!("dirfd x{} workers ({}k)", workers, size / 1000), elapsed, processes);
+        }
+
+        let (elapsed, processes) = time(|| naive_scan(dir.path()));
+        report(&format!("read_to_string ({}k)", size / 1000), elapsed, processes);
+    }
+
+    if std::env::args().any(|arg| arg == "--live") {
+        let collector = LinuxProcessCollector::new();
+        let (elapsed, processes) = time(|| collector.list_processes().len());
+        report("dirfd scanner (/proc)", elapsed, processes);
+        let (elapsed, processes) = time(|| naive_scan(Path::new("/proc")));
+        report("read_to_string (/proc)", elapsed, processes);
+    }
+}
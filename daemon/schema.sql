@@ -24,6 +24,16 @@ CREATE TABLE IF NOT EXISTS alerts (
 );
 CREATE INDEX IF NOT EXISTS idx_alerts_time ON alerts(timestamp DESC);
 
+-- Hourly per-name summaries of raw alerts removed by retention
+CREATE TABLE IF NOT EXISTS alert_rollups (
+    hour INTEGER NOT NULL,
+    name TEXT NOT NULL,
+    reason TEXT NOT NULL,
+    count INTEGER NOT NULL,
+    critical_count INTEGER NOT NULL DEFAULT 0,
+    PRIMARY KEY (hour, name, reason)
+);
+
 -- Process statistics for learning
 CREATE TABLE IF NOT EXISTS process_stats (
     name TEXT PRIMARY KEY,
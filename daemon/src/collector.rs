@@ -1,5 +1,7 @@
 //! Process information collector
 
+use std::time::Instant;
+
 #[derive(Debug, Clone)]
 pub struct ProcessInfo {
     pub pid: u32,
@@ -9,7 +11,59 @@ pub struct ProcessInfo {
     pub memory_mb: f64,
     pub runtime_seconds: u64,
     pub state: char,
+    /// Start time in seconds since the epoch, whole seconds
     pub start_time: u64,
+    /// Start time in clock ticks after boot (field 22 of /proc/<pid>/stat),
+    /// exact enough to tell apart processes started within one second
+    pub start_ticks: u64,
+}
+
+/// One completed scan, shared read-only between the monitoring loop and
+/// client requests so serving a process list never touches /proc.
+#[derive(Debug)]
+pub struct ProcessSnapshot {
+    /// Increments with every published scan; 0 before the first one
+    pub seq: u64,
+    pub taken_at: Instant,
+    pub processes: Vec<ProcessInfo>,
+    /// Fitted memory growth in MB/min, parallel to `processes`; `None` for
+    /// whitelisted processes and those without enough samples yet
+    pub leak_rates: Vec<Option<f64>>,
+    /// Empty unless cgroup monitoring is on
+    pub cgroups: Vec<CgroupInfo>,
+    /// As `leak_rates`, parallel to `cgroups`; `None` for non-leaf cgroups
+    pub cgroup_leak_rates: Vec<Option<f64>>,
+}
+
+impl ProcessSnapshot {
+    pub fn empty() -> Self {
+        Self {
+            seq: 0,
+            taken_at: Instant::now(),
+            processes: Vec::new(),
+            leak_rates: Vec::new(),
+            cgroups: Vec::new(),
+            cgroup_leak_rates: Vec::new(),
+        }
+    }
+}
+
+/// Identifies one process across scans. PIDs are recycled, so per-process
+/// state is keyed by PID plus start time in clock ticks; a reused PID gets a
+/// fresh entry even if it started in the same second as the previous owner.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct ProcessKey {
+    pub pid: u32,
+    pub start_ticks: u64,
+}
+
+impl ProcessInfo {
+    pub fn key(&self) -> ProcessKey {
+        ProcessKey {
+            pid: self.pid,
+            start_ticks: self.start_ticks,
+        }
+    }
 }
 
 pub trait ProcessCollector: Send + Sync {
@@ -17,8 +71,22 @@ pub trait ProcessCollector: Send + Sync {
     fn get_process(&self, pid: u32) -> Option<ProcessInfo>;
 }
 
+mod cgroup;
+mod details;
 #[cfg(target_os = "linux")]
 mod linux;
+#[cfg(target_os = "linux")]
+mod procfs;
+#[cfg(target_os = "linux")]
+mod proc_events;
+mod system;
 
+pub use cgroup::{CgroupCollector, CgroupInfo, MemoryEvents};
+pub use details::{DetailsCollector, ProcessDetails};
+#[cfg(target_os = "linux")]
+pub use linux::{LinuxProcessCollector, Scan};
+#[cfg(target_os = "linux")]
+pub use proc_events::{ProcessEvent, ProcessEventKind};
 #[cfg(target_os = "linux")]
-pub use linux::LinuxProcessCollector;
+pub use procfs::parse_stat;
+pub use system::{SystemCollector, SystemHistory, SystemSample, TopProcess, TOP_PROCESSES};
@@ -0,0 +1,195 @@
+//! cgroup v2 collector
+//!
+//! Reads per-cgroup totals from the unified hierarchy instead of summing
+//! processes: `cpu.stat` (usage_usec), `memory.current`, `memory.events` and
+//! `cgroup.procs`. A host with 20k processes typically has a few hundred
+//! cgroups, and the kernel's counters include children that lived less than
+//! a scan interval.
+
+use std::collections::HashMap;
+use std::fs;
+use std::io;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+use std::time::Instant;
+
+/// Counters from `memory.events`; they only ever increase
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct MemoryEvents {
+    /// Times usage went over memory.high and the group was throttled
+    pub high: u64,
+    /// Times usage hit memory.max
+    pub max: u64,
+    pub oom: u64,
+    pub oom_kill: u64,
+}
+
+#[derive(Debug, Clone)]
+pub struct CgroupInfo {
+    /// Path below the cgroup root, e.g. "system.slice/nginx.service"
+    pub path: String,
+    /// 100% = one core, as for processes
+    pub cpu_percent: f64,
+    /// `None` where the memory controller is not enabled for this cgroup
+    pub memory_mb: Option<f64>,
+    pub memory_events: MemoryEvents,
+    /// Members from `cgroup.procs`
+    pub pids: Vec<u32>,
+    /// Has no child cgroups. Parents include their children's usage, so
+    /// only leaves are run through the detector.
+    pub leaf: bool,
+}
+
+impl CgroupInfo {
+    /// Last path component, used as the alert and whitelist name
+    pub fn name(&self) -> &str {
+        self.path.rsplit('/').next().unwrap_or(&self.path)
+    }
+}
+
+struct CgroupSample {
+    usage_usec: u64,
+    timestamp: Instant,
+    generation: u64,
+}
+
+pub struct CgroupCollector {
+    root: PathBuf,
+    samples: Mutex<HashMap<String, CgroupSample>>,
+    generation: AtomicU64,
+}
+
+impl CgroupCollector {
+    /// Collect from `/sys/fs/cgroup`; fails unless it is a cgroup v2 mount
+    pub fn new() -> io::Result<Self> {
+        Self::with_root(Path::new("/sys/fs/cgroup"))
+    }
+
+    pub fn with_root(root: &Path) -> io::Result<Self> {
+        // Only the unified hierarchy has cgroup.controllers at its root
+        if !root.join("cgroup.controllers").is_file() {
+            return Err(io::Error::new(
+                io::ErrorKind::Unsupported,
+                format!("{} is not a cgroup v2 hierarchy", root.display()),
+            ));
+        }
+        Ok(Self {
+            root: root.to_path_buf(),
+            samples: Mutex::new(HashMap::new()),
+            generation: AtomicU64::new(0),
+        })
+    }
+
+    /// Every cgroup below the root. CPU use is averaged since the previous
+    /// call.
+    pub fn list_cgroups(&self) -> Vec<CgroupInfo> {
+        let generation = self.generation.fetch_add(1, Ordering::Relaxed) + 1;
+        let mut samples = self.samples.lock().unwrap();
+        let mut cgroups = Vec::new();
+
+        let mut stack = vec![(self.root.clone(), String::new())];
+        while let Some((dir, path)) = stack.pop() {
+            let children_before = stack.len();
+            if let Ok(entries) = fs::read_dir(&dir) {
+                for entry in entries.flatten() {
+                    if !entry.file_type().map(|t| t.is_dir()).unwrap_or(false) {
+                        continue;
+                    }
+                    let name = entry.file_name();
+                    let name = name.to_string_lossy();
+                    let child = if path.is_empty() { name.into_owned() } else { format!("{}/{}", path, name) };
+                    stack.push((entry.path(), child));
+                }
+            }
+            if path.is_empty() {
+                continue;
+            }
+            let leaf = stack.len() == children_before;
+            // A cgroup removed mid-walk just drops out of this scan
+            if let Some(info) = Self::read_cgroup(&dir, path, leaf, generation, &mut samples) {
+                cgroups.push(info);
+            }
+        }
+
+        samples.retain(|_, sample| sample.generation == generation);
+        cgroups
+    }
+
+    fn read_cgroup(
+        dir: &Path,
+        path: String,
+        leaf: bool,
+        generation: u64,
+        samples: &mut HashMap<String, CgroupSample>,
+    ) -> Option<CgroupInfo> {
+        // cpu.stat exists whichever controllers are enabled, so its absence
+        // means the cgroup was removed
+        let usage_usec = keyed_value(&fs::read_to_string(dir.join("cpu.stat")).ok()?, "usage_usec").unwrap_or(0);
+        let memory_bytes: Option<u64> = fs::read_to_string(dir.join("memory.current"))
+            .ok()
+            .and_then(|current| current.trim().parse().ok());
+        let memory_events = fs::read_to_string(dir.join("memory.events"))
+            .map(|events| MemoryEvents {
+                high: keyed_value(&events, "high").unwrap_or(0),
+                max: keyed_value(&events, "max").unwrap_or(0),
+                oom: keyed_value(&events, "oom").unwrap_or(0),
+                oom_kill: keyed_value(&events, "oom_kill").unwrap_or(0),
+            })
+            .unwrap_or_default();
+        let pids = fs::read_to_string(dir.join("cgroup.procs"))
+            .map(|procs| procs.lines().filter_map(|line| line.trim().parse().ok()).collect())
+            .unwrap_or_default();
+
+        let now = Instant::now();
+        let cpu_percent = match samples.get_mut(&path) {
+            Some(prev) => {
+                let usage_delta = usage_usec.saturating_sub(prev.usage_usec);
+                let elapsed = now.duration_since(prev.timestamp).as_secs_f64();
+                prev.usage_usec = usage_usec;
+                prev.timestamp = now;
+                prev.generation = generation;
+                if elapsed > 0.0 {
+                    usage_delta as f64 / 1e6 / elapsed * 100.0
+                } else {
+                    0.0
+                }
+            }
+            None => {
+                samples.insert(path.clone(), CgroupSample { usage_usec, timestamp: now, generation });
+                0.0
+            }
+        };
+
+        Some(CgroupInfo {
+            path,
+            cpu_percent,
+            memory_mb: memory_bytes.map(|bytes| bytes as f64 / (1024.0 * 1024.0)),
+            memory_events,
+            pids,
+            leaf,
+        })
+    }
+}
+
+/// Value of the `key value` line in a flat-keyed cgroup file
+fn keyed_value(contents: &str, key: &str) -> Option<u64> {
+    contents.lines().find_map(|line| {
+        let (name, value) = line.split_once(' ')?;
+        if name == key { value.trim().parse().ok() } else { None }
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_keyed_value() {
+        let events = "low 0\nhigh 12\nmax 3\noom 1\noom_kill 1\noom_group_kill 0\n";
+        assert_eq!(keyed_value(events, "high"), Some(12));
+        assert_eq!(keyed_value(events, "oom"), Some(1));
+        assert_eq!(keyed_value(events, "oom_kill"), Some(1));
+        assert_eq!(keyed_value(events, "missing"), None);
+    }
+}
@@ -0,0 +1,168 @@
+//! Details of a single process, read on request
+//!
+//! Nothing here runs during scans: descriptor and thread counts, I/O
+//! counters, cgroup, full command line and environment size are only read
+//! when a client asks for one process with `process_details`. I/O rates are
+//! the counter deltas since that process was last asked about, so they need
+//! two requests (the GUI's detail panel refreshes while open).
+
+use super::{parse_stat, ProcessKey};
+use serde::Serialize;
+use std::collections::HashMap;
+use std::fs;
+use std::path::{Path, PathBuf};
+use std::sync::Mutex;
+use std::time::{Duration, Instant};
+
+/// I/O readings older than this are dropped, so a panel reopened later
+/// starts over instead of averaging across the gap
+const IO_READING_TTL: Duration = Duration::from_secs(60);
+
+#[derive(Debug, Clone, Default, Serialize, PartialEq)]
+pub struct ProcessDetails {
+    /// NUL separators turned into spaces, not truncated
+    pub cmdline: String,
+    /// `None` where /proc denies access (other users' processes)
+    pub fd_count: Option<u32>,
+    pub threads: Option<u32>,
+    /// Bytes that reached or came from storage, from /proc/<pid>/io
+    pub read_bytes: Option<u64>,
+    pub write_bytes: Option<u64>,
+    /// Since the previous request for this process
+    pub read_bytes_per_sec: Option<f64>,
+    pub write_bytes_per_sec: Option<f64>,
+    /// cgroup v2 path (the `0::` line)
+    pub cgroup: Option<String>,
+    pub environ_bytes: Option<u64>,
+    pub environ_vars: Option<u32>,
+}
+
+struct IoReading {
+    at: Instant,
+    read_bytes: u64,
+    write_bytes: u64,
+}
+
+pub struct DetailsCollector {
+    root: PathBuf,
+    io_readings: Mutex<HashMap<ProcessKey, IoReading>>,
+}
+
+impl DetailsCollector {
+    pub fn new() -> Self {
+        Self::with_root(Path::new("/proc"))
+    }
+
+    pub fn with_root(root: &Path) -> Self {
+        Self {
+            root: root.to_path_buf(),
+            io_readings: Mutex::new(HashMap::new()),
+        }
+    }
+
+    /// `None` if the process is gone, including when its PID now belongs
+    /// to a process that started later than `key` says (the snapshot `key`
+    /// came from can be a tier interval old)
+    pub fn details(&self, key: ProcessKey) -> Option<ProcessDetails> {
+        let dir = self.root.join(key.pid.to_string());
+        let stat = fs::read(dir.join("stat")).ok()?;
+        if parse_stat(&stat)?.start_time != key.start_ticks {
+            return None;
+        }
+        let status = fs::read_to_string(dir.join("status")).ok()?;
+
+        let cmdline = fs::read(dir.join("cmdline"))
+            .map(|mut bytes| {
+                for byte in bytes.iter_mut() {
+                    if *byte == 0 {
+                        *byte = b' ';
+                    }
+                }
+                String::from_utf8_lossy(bytes.trim_ascii()).into_owned()
+            })
+            .unwrap_or_default();
+        let environ = fs::read(dir.join("environ")).ok();
+        let io = fs::read_to_string(dir.join("io")).ok();
+        let read_bytes = io.as_deref().and_then(|io| field(io, "read_bytes:"));
+        let write_bytes = io.as_deref().and_then(|io| field(io, "write_bytes:"));
+
+        let mut details = ProcessDetails {
+            cmdline,
+            fd_count: fs::read_dir(dir.join("fd")).ok().map(|entries| entries.count() as u32),
+            threads: field(&status, "Threads:").map(|n| n as u32),
+            read_bytes,
+            write_bytes,
+            cgroup: fs::read_to_string(dir.join("cgroup"))
+                .ok()
+                .and_then(|cgroup| cgroup.lines().find_map(|l| l.strip_prefix("0::").map(str::to_string))),
+            environ_bytes: environ.as_ref().map(|env| env.len() as u64),
+            environ_vars: environ
+                .as_ref()
+                .map(|env| env.split(|&b| b == 0).filter(|var| !var.is_empty()).count() as u32),
+            ..ProcessDetails::default()
+        };
+
+        if let (Some(read_bytes), Some(write_bytes)) = (read_bytes, write_bytes) {
+            let now = Instant::now();
+            let mut readings = self.io_readings.lock().unwrap();
+            readings.retain(|_, reading| now.duration_since(reading.at) < IO_READING_TTL);
+            if let Some(previous) = readings.get(&key) {
+                let secs = now.duration_since(previous.at).as_secs_f64();
+                if secs > 0.0 {
+                    details.read_bytes_per_sec = Some(read_bytes.saturating_sub(previous.read_bytes) as f64 / secs);
+                    details.write_bytes_per_sec =
+                        Some(write_bytes.saturating_sub(previous.write_bytes) as f64 / secs);
+                }
+            }
+            readings.insert(key, IoReading { at: now, read_bytes, write_bytes });
+        }
+        Some(details)
+    }
+}
+
+/// First number after `key` in a "Key: value" file
+fn field(text: &str, key: &str) -> Option<u64> {
+    text.lines().find_map(|line| line.strip_prefix(key)?.split_whitespace().next()?.parse().ok())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_reads_synthetic_process() {
+        let root = tempfile::tempdir().unwrap();
+        let dir = root.path().join("42");
+        fs::create_dir_all(dir.join("fd")).unwrap();
+        for fd in ["0", "1", "2"] {
+            fs::write(dir.join("fd").join(fd), "").unwrap();
+        }
+        fs::write(dir.join("stat"), "42 (make) S 1 42 42 0 -1 0 0 0 0 0 1 1 0 0 20 0 4 0 7 0 16 0\n").unwrap();
+        fs::write(dir.join("status"), "Name:\tmake\nThreads:\t4\n").unwrap();
+        fs::write(dir.join("cmdline"), b"make\0-j8\0").unwrap();
+        fs::write(dir.join("environ"), b"HOME=/root\0PATH=/bin\0").unwrap();
+        fs::write(dir.join("cgroup"), "0::/user.slice/session-2.scope\n").unwrap();
+        fs::write(dir.join("io"), "rchar: 10\nread_bytes: 4096\nwrite_bytes: 0\n").unwrap();
+
+        let collector = DetailsCollector::with_root(root.path());
+        let key = ProcessKey { pid: 42, start_ticks: 7 };
+        let details = collector.details(key).unwrap();
+        assert_eq!(details.cmdline, "make -j8");
+        assert_eq!((details.fd_count, details.threads), (Some(3), Some(4)));
+        assert_eq!(details.cgroup.as_deref(), Some("/user.slice/session-2.scope"));
+        assert_eq!((details.environ_bytes, details.environ_vars), (Some(21), Some(2)));
+        assert_eq!(details.read_bytes, Some(4096));
+        // Rates need a previous reading
+        assert_eq!(details.read_bytes_per_sec, None);
+
+        std::thread::sleep(Duration::from_millis(10));
+        fs::write(dir.join("io"), "read_bytes: 8192\nwrite_bytes: 0\n").unwrap();
+        let details = collector.details(key).unwrap();
+        assert!(details.read_bytes_per_sec.unwrap() > 0.0);
+        assert_eq!(details.write_bytes_per_sec, Some(0.0));
+
+        assert!(collector.details(ProcessKey { pid: 43, start_ticks: 0 }).is_none());
+        // PID 42 reused since the snapshot
+        assert!(collector.details(ProcessKey { pid: 42, start_ticks: 6 }).is_none());
+    }
+}
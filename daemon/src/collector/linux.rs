@@ -1,41 +1,154 @@
+use super::proc_events::{ProcConnector, ProcessEvent, ProcessEventKind, ProcessEventLog};
+use super::procfs::{ProcDir, StatFields};
 use super::{ProcessCollector, ProcessInfo};
-use std::collections::HashMap;
+use std::collections::hash_map::Entry;
+use std::collections::{HashMap, HashSet};
 use std::fs;
-use std::path::Path;
-use std::sync::Mutex;
+use std::io;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU32, AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex, OnceLock};
+use std::thread;
 use std::time::{Instant, SystemTime, UNIX_EPOCH};
+use tracing::{info, warn};
+
+/// CPU samples are split into this many maps by PID so scan workers never
+/// share a lock. A PID always hashes to the same shard across scans.
+const SAMPLE_SHARDS: usize = 64;
+
+/// Upper bound for the automatic worker count; /proc reads stop scaling
+/// well before the core count on large hosts
+const MAX_AUTO_WORKERS: usize = 16;
+
+/// A scan starts one thread per this many due PIDs, up to the worker count.
+/// Most ticks read a handful of hot processes, and those stay on the
+/// calling thread rather than paying for spawning and joining workers.
+const MIN_READS_PER_WORKER: usize = 128;
+
+/// With the proc connector, walk /proc anyway every this many scans in case
+/// an event was lost without the kernel reporting an overrun
+const FULL_RESYNC_SCANS: u32 = 30;
+
+type PendingEvent = (ProcessEventKind, u32, u32, String);
 
 #[derive(Clone)]
 struct CpuSample {
+    /// Tells the owner of a recycled PID apart from the previous one
+    start_ticks: u64,
+    /// `ProcDir::dir_ctime` when polling (0 with the proc connector), so a
+    /// recycled PID is noticed without reading its stat
+    dir_ctime: i64,
     total_ticks: u64,  // utime + stime
     timestamp: Instant,
+    /// Scan that last listed this PID; older samples are swept
+    generation: u64,
+    /// Name at the last read, reported in the exit event
+    name: String,
+}
+
+/// How a read process relates to the sample already held for its PID
+enum Sighting {
+    Known,
+    New,
+    /// The PID was recycled; carries the previous owner's name
+    Replaced(String),
+}
+
+/// Result of `LinuxProcessCollector::scan`
+#[derive(Default)]
+pub struct Scan {
+    /// Processes that were read
+    pub processes: Vec<ProcessInfo>,
+    /// Every PID listed, read or not
+    pub pids: Vec<u32>,
 }
 
 pub struct LinuxProcessCollector {
+    proc_dir: ProcDir,
     page_size: u64,
     clock_ticks: u64,
     boot_time: u64,
     num_cpus: u64,
-    cpu_samples: Mutex<HashMap<u32, CpuSample>>,
+    cpu_samples: Vec<Mutex<HashMap<u32, CpuSample>>>,
+    /// Configured scan threads (0 = automatic)
+    workers: AtomicUsize,
+    generation: AtomicU64,
+    /// PIDs seen in /proc during the last scan that could not be read
+    skipped: AtomicU32,
+    /// PID count of the last scan, used to size the next one
+    last_count: AtomicU32,
+    proc_root: PathBuf,
+    event_log: Arc<ProcessEventLog>,
+    /// Set once the netlink listener is running; scans then stat its live
+    /// PID set instead of walking /proc
+    connector: OnceLock<Arc<ProcConnector>>,
+    scans_since_resync: AtomicU32,
 }
 
 impl LinuxProcessCollector {
     pub fn new() -> Self {
+        Self::with_root(Path::new("/proc")).expect("/proc is not mounted")
+    }
+
+    /// Collect from a proc tree rooted somewhere other than `/proc`
+    /// (a container's procfs, or a synthetic tree in benchmarks).
+    pub fn with_root(root: &Path) -> io::Result<Self> {
         let page_size = unsafe { libc::sysconf(libc::_SC_PAGESIZE) as u64 };
         let clock_ticks = unsafe { libc::sysconf(libc::_SC_CLK_TCK) as u64 };
         let num_cpus = unsafe { libc::sysconf(libc::_SC_NPROCESSORS_ONLN) as u64 }.max(1);
-        let boot_time = Self::get_boot_time();
-        Self {
+        let boot_time = Self::get_boot_time(root);
+        Ok(Self {
+            proc_dir: ProcDir::open(root)?,
             page_size,
             clock_ticks,
             boot_time,
             num_cpus,
-            cpu_samples: Mutex::new(HashMap::new()),
+            cpu_samples: (0..SAMPLE_SHARDS).map(|_| Mutex::new(HashMap::new())).collect(),
+            workers: AtomicUsize::new(0),
+            generation: AtomicU64::new(0),
+            skipped: AtomicU32::new(0),
+            last_count: AtomicU32::new(0),
+            proc_root: root.to_path_buf(),
+            event_log: Arc::new(ProcessEventLog::new()),
+            connector: OnceLock::new(),
+            scans_since_resync: AtomicU32::new(0),
+        })
+    }
+
+    /// Track process lifecycle through the netlink proc connector. Needs
+    /// CAP_NET_ADMIN; on failure the collector keeps polling /proc and the
+    /// error is logged. Returns whether the listener is running.
+    pub fn enable_proc_connector(&self) -> bool {
+        if self.connector.get().is_some() {
+            return true;
         }
+        match ProcConnector::start(&self.proc_root, Arc::clone(&self.event_log)) {
+            Ok(connector) => {
+                let _ = self.connector.set(connector);
+                info!("Tracking processes via the netlink proc connector");
+                true
+            }
+            Err(e) => {
+                warn!("Proc connector unavailable ({}), polling /proc instead", e);
+                false
+            }
+        }
+    }
+
+    /// "netlink" when the proc connector is feeding events, "polling" when
+    /// they are derived from successive scans
+    pub fn event_source(&self) -> &'static str {
+        if self.connector.get().is_some() { "netlink" } else { "polling" }
     }
 
-    fn get_boot_time() -> u64 {
-        let stat = fs::read_to_string("/proc/stat").unwrap_or_default();
+    /// Spawn/exec/exit events newer than `since`, at most `limit` of them,
+    /// with the sequence number of the newest event
+    pub fn process_events(&self, since: u64, limit: usize) -> (Vec<ProcessEvent>, u64) {
+        self.event_log.since(since, limit)
+    }
+
+    fn get_boot_time(root: &Path) -> u64 {
+        let stat = fs::read_to_string(root.join("stat")).unwrap_or_default();
         for line in stat.lines() {
             if line.starts_with("btime ") {
                 return line[6..].trim().parse().unwrap_or(0);
@@ -44,68 +157,301 @@ impl LinuxProcessCollector {
         0
     }
 
-    fn parse_process(&self, pid: u32) -> Option<ProcessInfo> {
-        let proc_path = format!("/proc/{}", pid);
-        let proc_dir = Path::new(&proc_path);
-        if !proc_dir.exists() { return None; }
+    /// Set the number of scan threads; 0 picks one per core up to
+    /// `MAX_AUTO_WORKERS`, 1 scans on the calling thread.
+    pub fn set_workers(&self, workers: usize) {
+        self.workers.store(workers, Ordering::Relaxed);
+    }
 
-        let stat_content = fs::read_to_string(proc_dir.join("stat")).ok()?;
-        let stat_parts: Vec<&str> = stat_content.split_whitespace().collect();
-        if stat_parts.len() < 24 { return None; }
+    fn effective_workers(&self) -> usize {
+        let configured = self.workers.load(Ordering::Relaxed);
+        let workers = if configured == 0 {
+            thread::available_parallelism().map(|n| n.get()).unwrap_or(1).min(MAX_AUTO_WORKERS)
+        } else {
+            configured
+        };
+        workers.clamp(1, SAMPLE_SHARDS)
+    }
 
-        let name = stat_parts[1].trim_matches(|c| c == '(' || c == ')').to_string();
-        let state = stat_parts[2].chars().next().unwrap_or('?');
-        let utime: u64 = stat_parts[13].parse().unwrap_or(0);
-        let stime: u64 = stat_parts[14].parse().unwrap_or(0);
-        let start_time_ticks: u64 = stat_parts[21].parse().unwrap_or(0);
-        let rss_pages: u64 = stat_parts[23].parse().unwrap_or(0);
+    fn shard_of(pid: u32) -> usize {
+        pid as usize % SAMPLE_SHARDS
+    }
+
+    fn now_secs() -> u64 {
+        SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0)
+    }
 
-        let total_ticks = utime + stime;
+    /// Read one process and update its CPU sample. `generation` stamps the
+    /// sample as seen by that scan; `None` leaves an existing stamp alone.
+    fn parse_process(
+        &self,
+        pid: u32,
+        samples: &mut HashMap<u32, CpuSample>,
+        generation: Option<u64>,
+        now: u64,
+    ) -> Option<(ProcessInfo, Sighting)> {
+        // Taken after stat it would miss a PID recycled in between; taken
+        // before, the worst case is one extra read next scan
+        let dir_ctime = match self.connector.get() {
+            None => self.proc_dir.dir_ctime(pid)?,
+            Some(_) => 0,
+        };
+        let (name, state, total_ticks, start_ticks, rss_pages) =
+            self.proc_dir.with_stat(pid, |stat: &StatFields| {
+                (
+                    String::from_utf8_lossy(stat.comm).into_owned(),
+                    stat.state as char,
+                    stat.utime + stat.stime,
+                    stat.start_time,
+                    stat.rss_pages,
+                )
+            })?;
+        // Timestamp each process as it is read, so a long scan doesn't skew
+        // the deltas of PIDs read late in it
         let now_instant = Instant::now();
+        let start_time = self.boot_time + (start_ticks / self.clock_ticks);
+        let fresh = CpuSample {
+            start_ticks,
+            dir_ctime,
+            total_ticks,
+            timestamp: now_instant,
+            generation: generation.unwrap_or(0),
+            name: String::new(),
+        };
 
-        // Calculate CPU percentage from previous sample
-        let cpu_percent = {
-            let mut samples = self.cpu_samples.lock().unwrap();
-            let percent = if let Some(prev) = samples.get(&pid) {
+        // Calculate CPU percentage from previous sample, then update it for
+        // the next calculation
+        let (cpu_percent, sighting) = match samples.entry(pid) {
+            Entry::Occupied(mut entry) if entry.get().start_ticks != start_ticks => {
+                let previous = entry.insert(CpuSample { name: name.clone(), ..fresh });
+                (0.0, Sighting::Replaced(previous.name))
+            }
+            Entry::Occupied(mut entry) => {
+                let prev = entry.get_mut();
                 let tick_delta = total_ticks.saturating_sub(prev.total_ticks);
                 let time_delta = now_instant.duration_since(prev.timestamp).as_secs_f64();
-                if time_delta > 0.0 {
+                prev.total_ticks = total_ticks;
+                prev.timestamp = now_instant;
+                prev.dir_ctime = dir_ctime;
+                if let Some(generation) = generation {
+                    prev.generation = generation;
+                }
+                if prev.name != name {
+                    prev.name.clone_from(&name);
+                }
+                let cpu_percent = if time_delta > 0.0 {
                     // Convert ticks to seconds, then to percentage
                     let cpu_seconds = tick_delta as f64 / self.clock_ticks as f64;
                     (cpu_seconds / time_delta) * 100.0
                 } else {
                     0.0
-                }
-            } else {
-                0.0 // First sample, no previous data
-            };
-            // Update sample for next calculation
-            samples.insert(pid, CpuSample { total_ticks, timestamp: now_instant });
-            percent
+                };
+                (cpu_percent, Sighting::Known)
+            }
+            Entry::Vacant(entry) => {
+                entry.insert(CpuSample { name: name.clone(), ..fresh });
+                (0.0, Sighting::New) // First sample, no previous data
+            }
         };
 
         let memory_mb = (rss_pages * self.page_size) as f64 / (1024.0 * 1024.0);
-        let start_time = self.boot_time + (start_time_ticks / self.clock_ticks);
-        let now = SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0);
         let runtime_seconds = now.saturating_sub(start_time);
+        let cmdline = self.proc_dir.read_cmdline(pid);
 
-        let cmdline = fs::read_to_string(proc_dir.join("cmdline"))
-            .unwrap_or_default()
-            .replace('\0', " ")
-            .trim()
-            .to_string();
+        Some((
+            ProcessInfo {
+                pid, name, cmdline,
+                cpu_percent,
+                memory_mb, runtime_seconds, state, start_time, start_ticks,
+            },
+            sighting,
+        ))
+    }
 
-        Some(ProcessInfo {
-            pid, name, cmdline,
-            cpu_percent,
-            memory_mb, runtime_seconds, state, start_time,
-        })
+    /// Number of processes the last `list_processes` call could not read
+    /// (exited mid-scan or access denied)
+    pub fn skipped_count(&self) -> u32 {
+        self.skipped.load(Ordering::Relaxed)
     }
 
-    /// Remove stale CPU samples for processes that no longer exist
-    pub fn cleanup_stale(&self, active_pids: &[u32]) {
-        let mut samples = self.cpu_samples.lock().unwrap();
-        samples.retain(|pid, _| active_pids.contains(pid));
+    /// Read the PIDs in `pids` (all belonging to `shard`) flagged as due,
+    /// appending to `out`. The others only have their sample marked as still
+    /// listed. Returns the number of PIDs that could not be read.
+    /// With `events` set, PIDs that appeared or vanished since the last scan
+    /// are recorded there.
+    fn scan_shard(
+        &self,
+        shard: usize,
+        pids: &[(u32, bool)],
+        generation: u64,
+        now: u64,
+        out: &mut Vec<ProcessInfo>,
+        mut events: Option<&mut Vec<PendingEvent>>,
+    ) -> u32 {
+        let mut samples = self.cpu_samples[shard].lock().unwrap();
+        let mut skipped = 0;
+        let polling = self.connector.get().is_none();
+        for &(pid, due) in pids {
+            if !due {
+                // A PID never read has no sample and is read regardless, and
+                // so is one whose directory changed since: when polling, that
+                // is how a recycled PID shows up without reading its stat
+                if let Some(sample) = samples.get_mut(&pid) {
+                    if !polling || self.proc_dir.dir_ctime(pid) == Some(sample.dir_ctime) {
+                        sample.generation = generation;
+                        continue;
+                    }
+                }
+            }
+            match self.parse_process(pid, &mut samples, Some(generation), now) {
+                Some((info, sighting)) => {
+                    if let Some(events) = events.as_deref_mut() {
+                        match sighting {
+                            Sighting::Known => {}
+                            Sighting::New => {
+                                events.push((ProcessEventKind::Spawn, pid, 0, info.name.clone()));
+                            }
+                            Sighting::Replaced(previous) => {
+                                events.push((ProcessEventKind::Exit, pid, 0, previous));
+                                events.push((ProcessEventKind::Spawn, pid, 0, info.name.clone()));
+                            }
+                        }
+                    }
+                    out.push(info)
+                }
+                None => skipped += 1,
+            }
+        }
+        // Drop samples for processes that did not show up in this scan. One
+        // pass over the shard, no lookups. Generation 0 samples came from
+        // `get_process` and never had a spawn event, so they get no exit
+        // event either.
+        samples.retain(|&pid, sample| {
+            let alive = sample.generation == generation;
+            if !alive && sample.generation != 0 {
+                if let Some(events) = events.as_deref_mut() {
+                    events.push((ProcessEventKind::Exit, pid, 0, std::mem::take(&mut sample.name)));
+                }
+            }
+            alive
+        });
+        skipped
+    }
+
+    /// Fill `pids` from the connector's live set, or walk /proc when there is
+    /// no connector or it needs resyncing. Returns the connector if this scan
+    /// is a resync whose result must be handed back to it.
+    fn collect_pids(&self, pids: &mut Vec<u32>) -> io::Result<Option<&ProcConnector>> {
+        if let Some(connector) = self.connector.get() {
+            let scans = self.scans_since_resync.fetch_add(1, Ordering::Relaxed) + 1;
+            if scans < FULL_RESYNC_SCANS && connector.live_pids(pids) {
+                return Ok(None);
+            }
+            self.scans_since_resync.store(0, Ordering::Relaxed);
+            connector.begin_resync();
+            if let Err(e) = self.proc_dir.list_pids(pids) {
+                connector.request_resync();
+                return Err(e);
+            }
+            return Ok(Some(connector.as_ref()));
+        }
+        self.proc_dir.list_pids(pids)?;
+        Ok(None)
+    }
+}
+
+impl LinuxProcessCollector {
+    /// List every PID but read only those `read` selects, plus any PID that
+    /// may belong to a new process: seen for the first time, reported by the
+    /// proc connector as forking or exec'ing since the last scan, or, when
+    /// polling, with a changed /proc directory. Unread PIDs keep their CPU
+    /// sample, so their next reading averages over the whole gap.
+    pub fn scan(&self, read: &(dyn Fn(u32) -> bool + Sync)) -> Scan {
+        // Otherwise a recycled PID would wait out the old owner's tier
+        let mut changed = HashSet::new();
+        if let Some(connector) = self.connector.get() {
+            connector.take_changed(&mut changed);
+        }
+        let read = &|pid| changed.contains(&pid) || read(pid);
+
+        let mut pids = Vec::with_capacity(self.last_count.load(Ordering::Relaxed) as usize + 64);
+        let resyncing = match self.collect_pids(&mut pids) {
+            Ok(resyncing) => resyncing,
+            Err(_) => return Scan { processes: Vec::new(), pids },
+        };
+        self.last_count.store(pids.len() as u32, Ordering::Relaxed);
+
+        // `read` is asked once per PID, here, so the due count can size
+        // the scan before any thread starts
+        let mut shards: Vec<Vec<(u32, bool)>> = vec![Vec::new(); SAMPLE_SHARDS];
+        let mut due = 0;
+        for &pid in &pids {
+            let read = read(pid);
+            due += read as usize;
+            shards[Self::shard_of(pid)].push((pid, read));
+        }
+
+        let generation = self.generation.fetch_add(1, Ordering::Relaxed) + 1;
+        let now = Self::now_secs();
+        let workers = self.effective_workers().min(due.div_ceil(MIN_READS_PER_WORKER)).max(1);
+        let mut processes = Vec::with_capacity(pids.len());
+        let mut skipped = 0;
+        // The connector reports events itself; when polling they are
+        // derived here, except on the first scan where everything is new
+        let synthesize = self.connector.get().is_none() && generation > 1;
+        let mut events = Vec::new();
+
+        if workers == 1 {
+            for (shard, shard_pids) in shards.iter().enumerate() {
+                skipped += self.scan_shard(
+                    shard, shard_pids, generation, now, &mut processes,
+                    synthesize.then_some(&mut events),
+                );
+            }
+        } else {
+            // Worker w takes shards w, w + workers, ...; each shard's sample
+            // map is touched by exactly one thread
+            let shards = &shards;
+            thread::scope(|scope| {
+                let handles: Vec<_> = (0..workers)
+                    .map(|worker| {
+                        scope.spawn(move || {
+                            let mut out = Vec::new();
+                            let mut events = Vec::new();
+                            let mut skipped = 0;
+                            for shard in (worker..SAMPLE_SHARDS).step_by(workers) {
+                                skipped += self.scan_shard(
+                                    shard, &shards[shard], generation, now, &mut out,
+                                    synthesize.then_some(&mut events),
+                                );
+                            }
+                            (out, events, skipped)
+                        })
+                    })
+                    .collect();
+                for handle in handles {
+                    let (out, worker_events, worker_skipped) =
+                        handle.join().expect("proc scan worker panicked");
+                    processes.extend(out);
+                    events.extend(worker_events);
+                    skipped += worker_skipped;
+                }
+            });
+        }
+
+        if let Some(connector) = resyncing {
+            // From the samples, which also cover the PIDs that were not read
+            let shards: Vec<_> = self.cpu_samples.iter().map(|s| s.lock().unwrap()).collect();
+            connector.finish_resync(shards.iter().flat_map(|samples| {
+                samples
+                    .iter()
+                    .filter(|(_, sample)| sample.generation == generation)
+                    .map(|(&pid, sample)| (pid, sample.name.as_str()))
+            }));
+        }
+        self.event_log.extend(events);
+        self.skipped.store(skipped, Ordering::Relaxed);
+        Scan { processes, pids }
     }
 }
 
@@ -115,25 +461,13 @@ impl Default for LinuxProcessCollector {
 
 impl ProcessCollector for LinuxProcessCollector {
     fn list_processes(&self) -> Vec<ProcessInfo> {
-        let mut processes = Vec::new();
-        if let Ok(entries) = fs::read_dir("/proc") {
-            for entry in entries.flatten() {
-                if let Some(name) = entry.file_name().to_str() {
-                    if let Ok(pid) = name.parse::<u32>() {
-                        if let Some(info) = self.parse_process(pid) {
-                            processes.push(info);
-                        }
-                    }
-                }
-            }
-        }
-        // Cleanup stale samples
-        let pids: Vec<u32> = processes.iter().map(|p| p.pid).collect();
-        self.cleanup_stale(&pids);
-        processes
+        self.scan(&|_| true).processes
     }
 
     fn get_process(&self, pid: u32) -> Option<ProcessInfo> {
-        self.parse_process(pid)
+        let mut samples = self.cpu_samples[Self::shard_of(pid)].lock().unwrap();
+        // Keep the sample's generation so the lookup doesn't keep a dead PID alive
+        self.parse_process(pid, &mut samples, None, Self::now_secs())
+            .map(|(info, _)| info)
     }
 }
@@ -0,0 +1,505 @@
+//! Process lifecycle events
+//!
+//! `ProcessEventLog` is a bounded feed of spawn/exec/exit events that clients
+//! page through by sequence number. `ProcConnector` subscribes to the kernel's
+//! netlink proc connector (needs CAP_NET_ADMIN) and keeps the live PID set
+//! current between scans, so the collector can stat known PIDs instead of
+//! walking /proc. Without it, the collector derives the same events by
+//! diffing consecutive scans.
+
+use super::procfs::ProcDir;
+use serde::Serialize;
+use std::collections::{HashMap, HashSet, VecDeque};
+use std::io;
+use std::os::fd::{AsRawFd, FromRawFd, OwnedFd};
+use std::path::Path;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread;
+use std::time::{SystemTime, UNIX_EPOCH};
+use tracing::{debug, warn};
+
+/// Events kept for clients; older ones are dropped
+const EVENT_LOG_CAPACITY: usize = 2000;
+
+// <linux/connector.h> and <linux/cn_proc.h>
+const CN_IDX_PROC: u32 = 1;
+const CN_VAL_PROC: u32 = 1;
+const PROC_CN_MCAST_LISTEN: u32 = 1;
+const PROC_EVENT_FORK: u32 = 0x0000_0001;
+const PROC_EVENT_EXEC: u32 = 0x0000_0002;
+const PROC_EVENT_EXIT: u32 = 0x8000_0000;
+
+const NLMSG_HDRLEN: usize = 16;
+const CN_MSG_LEN: usize = 20;
+/// Offset of `event_data` inside `struct proc_event` (what, cpu, timestamp_ns)
+const PROC_EVENT_DATA: usize = 16;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize)]
+#[serde(rename_all = "snake_case")]
+pub enum ProcessEventKind {
+    Spawn,
+    Exec,
+    Exit,
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct ProcessEvent {
+    pub seq: u64,
+    pub kind: ProcessEventKind,
+    pub pid: u32,
+    /// Parent PID for spawn events, 0 when unknown
+    pub ppid: u32,
+    pub name: String,
+    pub timestamp: u64,
+}
+
+struct LogInner {
+    events: VecDeque<ProcessEvent>,
+    next_seq: u64,
+}
+
+pub struct ProcessEventLog {
+    inner: Mutex<LogInner>,
+}
+
+impl ProcessEventLog {
+    pub fn new() -> Self {
+        Self {
+            inner: Mutex::new(LogInner {
+                events: VecDeque::with_capacity(EVENT_LOG_CAPACITY),
+                next_seq: 1,
+            }),
+        }
+    }
+
+    pub fn push(&self, kind: ProcessEventKind, pid: u32, ppid: u32, name: String) {
+        let mut inner = self.inner.lock().unwrap();
+        Self::push_locked(&mut inner, kind, pid, ppid, name, now_secs());
+    }
+
+    /// Append a batch under one lock; used by scan workers
+    pub fn extend(&self, events: Vec<(ProcessEventKind, u32, u32, String)>) {
+        if events.is_empty() {
+            return;
+        }
+        let timestamp = now_secs();
+        let mut inner = self.inner.lock().unwrap();
+        for (kind, pid, ppid, name) in events {
+            Self::push_locked(&mut inner, kind, pid, ppid, name, timestamp);
+        }
+    }
+
+    fn push_locked(
+        inner: &mut LogInner,
+        kind: ProcessEventKind,
+        pid: u32,
+        ppid: u32,
+        name: String,
+        timestamp: u64,
+    ) {
+        if inner.events.len() == EVENT_LOG_CAPACITY {
+            inner.events.pop_front();
+        }
+        let seq = inner.next_seq;
+        inner.next_seq += 1;
+        inner.events.push_back(ProcessEvent {
+            seq,
+            kind,
+            pid,
+            ppid,
+            name,
+            timestamp,
+        });
+    }
+
+    /// Events with a sequence number above `since`, oldest first, capped at
+    /// the newest `limit`. Also returns the sequence number of the newest event.
+    pub fn since(&self, since: u64, limit: usize) -> (Vec<ProcessEvent>, u64) {
+        let inner = self.inner.lock().unwrap();
+        let newer = inner.events.iter().filter(|e| e.seq > since).count();
+        let events = inner
+            .events
+            .iter()
+            .skip(inner.events.len() - newer.min(limit))
+            .cloned()
+            .collect();
+        (events, inner.next_seq - 1)
+    }
+}
+
+impl Default for ProcessEventLog {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+fn now_secs() -> u64 {
+    SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0)
+}
+
+struct ConnectorState {
+    live: HashSet<u32>,
+    names: HashMap<u32, String>,
+    /// PIDs that forked or exec'd since the last scan took them. The
+    /// scheduler may not be due to read them for minutes, and until it does
+    /// a recycled PID would carry its previous owner's schedule and reading.
+    changed: HashSet<u32>,
+    /// Set between `begin_resync` and `finish_resync`: changes that land
+    /// while /proc is being walked, re-applied on top of the walk's result
+    pending: Option<Vec<(u32, Option<String>)>>,
+}
+
+/// Listener on the netlink proc connector.
+pub struct ProcConnector {
+    state: Mutex<ConnectorState>,
+    /// Set when the kernel dropped events (socket overrun); the live set
+    /// must be rebuilt from a full /proc walk
+    needs_resync: AtomicBool,
+}
+
+impl ProcConnector {
+    /// Subscribe to process events and start the listener thread.
+    ///
+    /// Fails with `PermissionDenied` without CAP_NET_ADMIN; callers fall back
+    /// to polling. The live set starts empty and flagged for resync.
+    pub fn start(proc_root: &Path, log: Arc<ProcessEventLog>) -> io::Result<Arc<Self>> {
+        let fd = subscribe()?;
+        let proc_dir = ProcDir::open(proc_root)?;
+        let connector = Arc::new(Self {
+            state: Mutex::new(ConnectorState {
+                live: HashSet::new(),
+                names: HashMap::new(),
+                changed: HashSet::new(),
+                pending: None,
+            }),
+            needs_resync: AtomicBool::new(true),
+        });
+        let listener = Arc::clone(&connector);
+        thread::Builder::new()
+            .name("proc-events".to_string())
+            .spawn(move || listener.run(fd, proc_dir, log))?;
+        Ok(connector)
+    }
+
+    /// Snapshot of the PIDs currently alive, or `None` if a full walk is
+    /// needed first.
+    pub fn live_pids(&self, pids: &mut Vec<u32>) -> bool {
+        if self.needs_resync.load(Ordering::Relaxed) {
+            return false;
+        }
+        pids.extend(self.state.lock().unwrap().live.iter().copied());
+        true
+    }
+
+    /// Move the PIDs that forked or exec'd since the last call into `out`
+    pub fn take_changed(&self, out: &mut HashSet<u32>) {
+        std::mem::swap(&mut self.state.lock().unwrap().changed, out);
+    }
+
+    /// Request a full /proc walk on the next scan.
+    pub fn request_resync(&self) {
+        self.needs_resync.store(true, Ordering::Relaxed);
+    }
+
+    /// Start recording changes that arrive while /proc is being walked.
+    pub fn begin_resync(&self) {
+        self.needs_resync.store(false, Ordering::Relaxed);
+        self.state.lock().unwrap().pending = Some(Vec::new());
+    }
+
+    /// Replace the live set with the walk's result plus anything that
+    /// spawned or exited during the walk.
+    pub fn finish_resync<'a>(&self, scanned: impl Iterator<Item = (u32, &'a str)>) {
+        let mut state = self.state.lock().unwrap();
+        let pending = state.pending.take().unwrap_or_default();
+        state.live.clear();
+        state.names.clear();
+        for (pid, name) in scanned {
+            state.live.insert(pid);
+            state.names.insert(pid, name.to_string());
+        }
+        for (pid, name) in pending {
+            match name {
+                Some(name) => {
+                    state.live.insert(pid);
+                    state.names.insert(pid, name);
+                }
+                None => {
+                    state.live.remove(&pid);
+                    state.names.remove(&pid);
+                }
+            }
+        }
+    }
+
+    fn run(&self, fd: OwnedFd, proc_dir: ProcDir, log: Arc<ProcessEventLog>) {
+        let mut buf = [0u8; 8192];
+        loop {
+            let n = unsafe {
+                libc::recv(fd.as_raw_fd(), buf.as_mut_ptr() as *mut libc::c_void, buf.len(), 0)
+            };
+            if n < 0 {
+                let err = io::Error::last_os_error();
+                match err.raw_os_error() {
+                    Some(libc::EINTR) => continue,
+                    Some(libc::ENOBUFS) => {
+                        // Fork storm outran us; the live set is no longer exact
+                        debug!("Proc connector overrun, scheduling resync");
+                        self.request_resync();
+                        continue;
+                    }
+                    _ => {
+                        warn!("Proc connector stopped: {}", err);
+                        self.request_resync();
+                        return;
+                    }
+                }
+            }
+            for event in parse_messages(&buf[..n as usize]) {
+                self.apply(event, &proc_dir, &log);
+            }
+        }
+    }
+
+    fn apply(&self, event: RawEvent, proc_dir: &ProcDir, log: &ProcessEventLog) {
+        match event {
+            RawEvent::Fork { ppid, pid } => {
+                let name = {
+                    let state = self.state.lock().unwrap();
+                    state.names.get(&ppid).cloned()
+                }
+                .or_else(|| proc_dir.read_comm(pid))
+                .unwrap_or_default();
+                self.record(pid, Some(name.clone()));
+                log.push(ProcessEventKind::Spawn, pid, ppid, name);
+            }
+            RawEvent::Exec { pid } => {
+                let name = proc_dir.read_comm(pid).unwrap_or_default();
+                self.record(pid, Some(name.clone()));
+                log.push(ProcessEventKind::Exec, pid, 0, name);
+            }
+            RawEvent::Exit { pid } => {
+                let name = self.state.lock().unwrap().names.get(&pid).cloned().unwrap_or_default();
+                self.record(pid, None);
+                log.push(ProcessEventKind::Exit, pid, 0, name);
+            }
+        }
+    }
+
+    /// `Some(name)`: process is alive under that name; `None`: it exited
+    fn record(&self, pid: u32, name: Option<String>) {
+        let mut state = self.state.lock().unwrap();
+        if let Some(pending) = state.pending.as_mut() {
+            pending.push((pid, name.clone()));
+        }
+        match name {
+            Some(name) => {
+                state.live.insert(pid);
+                state.names.insert(pid, name);
+                state.changed.insert(pid);
+            }
+            None => {
+                state.live.remove(&pid);
+                state.names.remove(&pid);
+                state.changed.remove(&pid);
+            }
+        }
+    }
+}
+
+/// Open a netlink connector socket and ask for process events.
+fn subscribe() -> io::Result<OwnedFd> {
+    let fd = unsafe {
+        libc::socket(
+            libc::AF_NETLINK,
+            libc::SOCK_DGRAM | libc::SOCK_CLOEXEC,
+            libc::NETLINK_CONNECTOR,
+        )
+    };
+    if fd < 0 {
+        return Err(io::Error::last_os_error());
+    }
+    let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+
+    let mut addr: libc::sockaddr_nl = unsafe { std::mem::zeroed() };
+    addr.nl_family = libc::AF_NETLINK as libc::sa_family_t;
+    addr.nl_groups = CN_IDX_PROC;
+    let rc = unsafe {
+        libc::bind(
+            fd.as_raw_fd(),
+            &addr as *const libc::sockaddr_nl as *const libc::sockaddr,
+            std::mem::size_of::<libc::sockaddr_nl>() as libc::socklen_t,
+        )
+    };
+    if rc < 0 {
+        return Err(io::Error::last_os_error());
+    }
+
+    // nlmsghdr + cn_msg + PROC_CN_MCAST_LISTEN
+    let mut msg = [0u8; NLMSG_HDRLEN + CN_MSG_LEN + 4];
+    let len = msg.len() as u32;
+    msg[0..4].copy_from_slice(&len.to_ne_bytes());
+    msg[4..6].copy_from_slice(&(libc::NLMSG_DONE as u16).to_ne_bytes());
+    msg[12..16].copy_from_slice(&std::process::id().to_ne_bytes());
+    let cn = NLMSG_HDRLEN;
+    msg[cn..cn + 4].copy_from_slice(&CN_IDX_PROC.to_ne_bytes());
+    msg[cn + 4..cn + 8].copy_from_slice(&CN_VAL_PROC.to_ne_bytes());
+    msg[cn + 16..cn + 18].copy_from_slice(&4u16.to_ne_bytes());
+    msg[cn + CN_MSG_LEN..].copy_from_slice(&PROC_CN_MCAST_LISTEN.to_ne_bytes());
+    let sent = unsafe {
+        libc::send(fd.as_raw_fd(), msg.as_ptr() as *const libc::c_void, msg.len(), 0)
+    };
+    if sent < 0 {
+        return Err(io::Error::last_os_error());
+    }
+    Ok(fd)
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum RawEvent {
+    Fork { ppid: u32, pid: u32 },
+    Exec { pid: u32 },
+    Exit { pid: u32 },
+}
+
+fn read_u32(buf: &[u8], offset: usize) -> Option<u32> {
+    buf.get(offset..offset + 4).map(|b| u32::from_ne_bytes([b[0], b[1], b[2], b[3]]))
+}
+
+/// Decode the process-level events in one datagram. Thread forks and
+/// thread exits (pid != tgid) are dropped.
+fn parse_messages(buf: &[u8]) -> Vec<RawEvent> {
+    let mut events = Vec::new();
+    let mut offset = 0;
+    while let Some(len) = read_u32(buf, offset) {
+        let len = len as usize;
+        if len < NLMSG_HDRLEN || offset + len > buf.len() {
+            break;
+        }
+        let event = offset + NLMSG_HDRLEN + CN_MSG_LEN;
+        let data = event + PROC_EVENT_DATA;
+        let parsed = match read_u32(buf, event) {
+            Some(PROC_EVENT_FORK) => match (
+                read_u32(buf, data + 4),
+                read_u32(buf, data + 8),
+                read_u32(buf, data + 12),
+            ) {
+                (Some(parent_tgid), Some(child_pid), Some(child_tgid)) if child_pid == child_tgid => {
+                    Some(RawEvent::Fork { ppid: parent_tgid, pid: child_tgid })
+                }
+                _ => None,
+            },
+            Some(PROC_EVENT_EXEC) => read_u32(buf, data + 4).map(|tgid| RawEvent::Exec { pid: tgid }),
+            Some(PROC_EVENT_EXIT) => match (read_u32(buf, data), read_u32(buf, data + 4)) {
+                (Some(pid), Some(tgid)) if pid == tgid => Some(RawEvent::Exit { pid }),
+                _ => None,
+            },
+            _ => None,
+        };
+        events.extend(parsed);
+        // nlmsg lengths are 4-byte aligned
+        offset += (len + 3) & !3;
+    }
+    events
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn message(what: u32, data: &[u32]) -> Vec<u8> {
+        let mut msg = vec![0u8; NLMSG_HDRLEN + CN_MSG_LEN + PROC_EVENT_DATA];
+        let start = NLMSG_HDRLEN + CN_MSG_LEN;
+        msg[start..start + 4].copy_from_slice(&what.to_ne_bytes());
+        for value in data {
+            msg.extend_from_slice(&value.to_ne_bytes());
+        }
+        let len = msg.len() as u32;
+        msg[0..4].copy_from_slice(&len.to_ne_bytes());
+        msg
+    }
+
+    #[test]
+    fn test_parse_fork_exec_exit() {
+        let mut buf = message(PROC_EVENT_FORK, &[100, 100, 200, 200]);
+        buf.extend(message(PROC_EVENT_EXEC, &[200, 200]));
+        buf.extend(message(PROC_EVENT_EXIT, &[200, 200, 0, 17]));
+        assert_eq!(
+            parse_messages(&buf),
+            vec![
+                RawEvent::Fork { ppid: 100, pid: 200 },
+                RawEvent::Exec { pid: 200 },
+                RawEvent::Exit { pid: 200 },
+            ]
+        );
+    }
+
+    #[test]
+    fn test_parse_ignores_threads() {
+        let mut buf = message(PROC_EVENT_FORK, &[100, 100, 201, 200]);
+        buf.extend(message(PROC_EVENT_EXIT, &[201, 200, 0, 0]));
+        assert!(parse_messages(&buf).is_empty());
+    }
+
+    #[test]
+    fn test_parse_truncated() {
+        let buf = message(PROC_EVENT_FORK, &[100, 100, 200, 200]);
+        assert!(parse_messages(&buf[..buf.len() - 2]).is_empty());
+    }
+
+    #[test]
+    fn test_changed_pids() {
+        let connector = ProcConnector {
+            state: Mutex::new(ConnectorState {
+                live: HashSet::new(),
+                names: HashMap::new(),
+                changed: HashSet::new(),
+                pending: None,
+            }),
+            needs_resync: AtomicBool::new(false),
+        };
+        connector.record(200, Some("sh".to_string()));
+        connector.record(201, Some("sh".to_string()));
+        connector.record(201, Some("make".to_string()));
+        connector.record(202, Some("cc".to_string()));
+        connector.record(202, None);
+
+        let mut changed = HashSet::new();
+        connector.take_changed(&mut changed);
+        assert_eq!(changed, HashSet::from([200, 201]));
+        changed.clear();
+        connector.take_changed(&mut changed);
+        assert!(changed.is_empty());
+    }
+
+    #[test]
+    fn test_event_log_since() {
+        let log = ProcessEventLog::new();
+        for pid in 1..=5 {
+            log.push(ProcessEventKind::Spawn, pid, 1, format!("p{}", pid));
+        }
+        let (events, latest) = log.since(0, 100);
+        assert_eq!(events.len(), 5);
+        assert_eq!(latest, 5);
+
+        let (events, _) = log.since(3, 100);
+        assert_eq!(events.iter().map(|e| e.pid).collect::<Vec<_>>(), vec![4, 5]);
+
+        // Limit keeps the newest events
+        let (events, _) = log.since(0, 2);
+        assert_eq!(events.iter().map(|e| e.pid).collect::<Vec<_>>(), vec![4, 5]);
+    }
+
+    #[test]
+    fn test_event_log_capacity() {
+        let log = ProcessEventLog::new();
+        for pid in 0..(EVENT_LOG_CAPACITY as u32 + 10) {
+            log.push(ProcessEventKind::Exit, pid, 0, String::new());
+        }
+        let (events, latest) = log.since(0, usize::MAX);
+        assert_eq!(events.len(), EVENT_LOG_CAPACITY);
+        assert_eq!(events[0].pid, 10);
+        assert_eq!(latest, EVENT_LOG_CAPACITY as u64 + 10);
+    }
+}
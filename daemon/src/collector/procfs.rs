@@ -0,0 +1,344 @@
+//! Low-level /proc reader
+//!
+//! Keeps a descriptor on the proc root open and reads `<pid>/stat` and
+//! `<pid>/cmdline` with `openat` into per-thread buffers, so a scan does no
+//! path formatting, no `Path` joins and no per-file allocation. Only the
+//! strings handed back to the caller are allocated.
+
+use std::cell::RefCell;
+use std::ffi::{CStr, CString};
+use std::io;
+use std::os::fd::{AsRawFd, FromRawFd, OwnedFd};
+use std::os::unix::ffi::OsStrExt;
+use std::path::Path;
+
+thread_local! {
+    static STAT_BUF: RefCell<Vec<u8>> = RefCell::new(Vec::with_capacity(1024));
+    static CMDLINE_BUF: RefCell<Vec<u8>> = RefCell::new(Vec::with_capacity(4096));
+}
+
+/// The fields of `/proc/<pid>/stat` the collector uses. `comm` borrows the
+/// per-thread read buffer.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StatFields<'a> {
+    pub comm: &'a [u8],
+    pub state: u8,
+    pub utime: u64,
+    pub stime: u64,
+    pub start_time: u64,
+    pub rss_pages: u64,
+}
+
+pub struct ProcDir {
+    fd: OwnedFd,
+}
+
+impl ProcDir {
+    pub fn open(root: &Path) -> io::Result<Self> {
+        let path = CString::new(root.as_os_str().as_bytes())
+            .map_err(|e| io::Error::new(io::ErrorKind::InvalidInput, e))?;
+        let fd = unsafe {
+            libc::open(path.as_ptr(), libc::O_RDONLY | libc::O_DIRECTORY | libc::O_CLOEXEC)
+        };
+        if fd < 0 {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(Self {
+            fd: unsafe { OwnedFd::from_raw_fd(fd) },
+        })
+    }
+
+    /// Append every numeric entry of the proc root to `pids`.
+    pub fn list_pids(&self, pids: &mut Vec<u32>) -> io::Result<()> {
+        // A fresh descriptor per scan: readdir state lives on the open file
+        let fd = unsafe {
+            libc::openat(
+                self.fd.as_raw_fd(),
+                c".".as_ptr(),
+                libc::O_RDONLY | libc::O_DIRECTORY | libc::O_CLOEXEC,
+            )
+        };
+        if fd < 0 {
+            return Err(io::Error::last_os_error());
+        }
+        let dir = unsafe { libc::fdopendir(fd) };
+        if dir.is_null() {
+            let err = io::Error::last_os_error();
+            unsafe { libc::close(fd) };
+            return Err(err);
+        }
+        loop {
+            let entry = unsafe { libc::readdir(dir) };
+            if entry.is_null() {
+                break;
+            }
+            let name = unsafe { CStr::from_ptr((*entry).d_name.as_ptr()) };
+            if let Some(pid) = parse_pid(name.to_bytes()) {
+                pids.push(pid);
+            }
+        }
+        unsafe { libc::closedir(dir) };
+        Ok(())
+    }
+
+    /// Read and parse `<pid>/stat`, passing the fields to `f` while the
+    /// buffer is borrowed. Returns `None` if the process is gone or unreadable.
+    pub fn with_stat<R>(&self, pid: u32, f: impl FnOnce(&StatFields) -> R) -> Option<R> {
+        STAT_BUF.with(|cell| {
+            let mut buf = cell.borrow_mut();
+            if !self.read_file(pid, b"stat", &mut buf) {
+                return None;
+            }
+            parse_stat(&buf).map(|fields| f(&fields))
+        })
+    }
+
+    /// Read `<pid>/cmdline` with the NUL separators turned into spaces.
+    /// Kernel threads and zombies have an empty command line.
+    pub fn read_cmdline(&self, pid: u32) -> String {
+        CMDLINE_BUF.with(|cell| {
+            let mut buf = cell.borrow_mut();
+            if !self.read_file(pid, b"cmdline", &mut buf) {
+                return String::new();
+            }
+            for byte in buf.iter_mut() {
+                if *byte == 0 {
+                    *byte = b' ';
+                }
+            }
+            String::from_utf8_lossy(buf.trim_ascii()).into_owned()
+        })
+    }
+
+    /// Read `<pid>/comm`, the short process name.
+    pub fn read_comm(&self, pid: u32) -> Option<String> {
+        STAT_BUF.with(|cell| {
+            let mut buf = cell.borrow_mut();
+            if !self.read_file(pid, b"comm", &mut buf) {
+                return None;
+            }
+            Some(String::from_utf8_lossy(buf.trim_ascii_end()).into_owned())
+        })
+    }
+
+    /// Change time of the `<pid>` directory in nanoseconds. procfs stamps it
+    /// when the directory's inode is created, so a recycled PID shows a new
+    /// one; one `fstatat`, much cheaper than reading `stat`. `None` if the
+    /// process is gone.
+    pub fn dir_ctime(&self, pid: u32) -> Option<i64> {
+        let mut path = [0u8; 32];
+        if !pid_path(&mut path, pid, b".") {
+            return None;
+        }
+        let mut st: libc::stat = unsafe { std::mem::zeroed() };
+        let rc = unsafe {
+            libc::fstatat(self.fd.as_raw_fd(), path.as_ptr() as *const libc::c_char, &mut st, 0)
+        };
+        (rc == 0).then(|| st.st_ctime * 1_000_000_000 + st.st_ctime_nsec)
+    }
+
+    /// Read the whole of `<pid>/<file>` into `buf`, replacing its contents.
+    fn read_file(&self, pid: u32, file: &[u8], buf: &mut Vec<u8>) -> bool {
+        let mut path = [0u8; 32];
+        if !pid_path(&mut path, pid, file) {
+            return false;
+        }
+        let fd = unsafe {
+            libc::openat(
+                self.fd.as_raw_fd(),
+                path.as_ptr() as *const libc::c_char,
+                libc::O_RDONLY | libc::O_CLOEXEC,
+            )
+        };
+        if fd < 0 {
+            return false;
+        }
+
+        buf.clear();
+        let ok = loop {
+            if buf.len() == buf.capacity() {
+                buf.reserve(buf.capacity().max(1024));
+            }
+            let spare = buf.capacity() - buf.len();
+            let n = unsafe {
+                libc::read(fd, buf.as_mut_ptr().add(buf.len()) as *mut libc::c_void, spare)
+            };
+            if n < 0 {
+                if io::Error::last_os_error().kind() == io::ErrorKind::Interrupted {
+                    continue;
+                }
+                break false;
+            }
+            if n == 0 {
+                break true;
+            }
+            unsafe { buf.set_len(buf.len() + n as usize) };
+        };
+        unsafe { libc::close(fd) };
+        ok
+    }
+}
+
+/// Write the NUL-terminated relative path `<pid>/<file>` into `out`.
+fn pid_path(out: &mut [u8; 32], pid: u32, file: &[u8]) -> bool {
+    let mut digits = [0u8; 10];
+    let mut n = pid;
+    let mut i = digits.len();
+    loop {
+        i -= 1;
+        digits[i] = b'0' + (n % 10) as u8;
+        n /= 10;
+        if n == 0 {
+            break;
+        }
+    }
+    let digits = &digits[i..];
+    let len = digits.len() + 1 + file.len();
+    if len + 1 > out.len() {
+        return false;
+    }
+    out[..digits.len()].copy_from_slice(digits);
+    out[digits.len()] = b'/';
+    out[digits.len() + 1..len].copy_from_slice(file);
+    out[len] = 0;
+    true
+}
+
+fn parse_pid(name: &[u8]) -> Option<u32> {
+    if name.is_empty() || name.len() > 10 {
+        return None;
+    }
+    let mut pid: u64 = 0;
+    for &b in name {
+        if !b.is_ascii_digit() {
+            return None;
+        }
+        pid = pid * 10 + (b - b'0') as u64;
+    }
+    u32::try_from(pid).ok()
+}
+
+/// Parse the contents of `/proc/<pid>/stat`.
+///
+/// `comm` is delimited by the first `(` and the *last* `)`: a process can
+/// name itself `a) S (b` and the fields after it are only unambiguous when
+/// counted from the closing paren.
+pub fn parse_stat(buf: &[u8]) -> Option<StatFields<'_>> {
+    let open = buf.iter().position(|&b| b == b'(')?;
+    let close = buf.iter().rposition(|&b| b == b')')?;
+    if close < open {
+        return None;
+    }
+    let comm = &buf[open + 1..close];
+
+    // Field numbers below follow proc(5), where comm is field 2
+    let mut cursor = FieldCursor { rest: &buf[close + 1..] };
+    let state = *cursor.next()?.first()?; // 3
+    cursor.skip(10); // 4..=13
+    let utime = cursor.next_u64()?; // 14
+    let stime = cursor.next_u64()?; // 15
+    cursor.skip(6); // 16..=21
+    let start_time = cursor.next_u64()?; // 22
+    cursor.skip(1); // 23 vsize
+    let rss_pages = cursor.next_u64()?; // 24
+
+    Some(StatFields {
+        comm,
+        state,
+        utime,
+        stime,
+        start_time,
+        rss_pages,
+    })
+}
+
+/// Walks space-separated fields without splitting into a Vec.
+struct FieldCursor<'a> {
+    rest: &'a [u8],
+}
+
+impl<'a> FieldCursor<'a> {
+    fn next(&mut self) -> Option<&'a [u8]> {
+        let start = self.rest.iter().position(|b| !b.is_ascii_whitespace())?;
+        let rest = &self.rest[start..];
+        let end = rest.iter().position(|b| b.is_ascii_whitespace()).unwrap_or(rest.len());
+        self.rest = &rest[end..];
+        Some(&rest[..end])
+    }
+
+    fn skip(&mut self, count: usize) {
+        for _ in 0..count {
+            if self.next().is_none() {
+                return;
+            }
+        }
+    }
+
+    /// Next field as an unsigned number; malformed or negative values read as 0
+    fn next_u64(&mut self) -> Option<u64> {
+        let field = self.next()?;
+        let mut value: u64 = 0;
+        for &b in field {
+            if !b.is_ascii_digit() {
+                return Some(0);
+            }
+            value = value.wrapping_mul(10).wrapping_add((b - b'0') as u64);
+        }
+        Some(value)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const STAT: &[u8] = b"1234 (bash) S 1 1234 1234 34816 1234 4194560 1043 2890 0 0 \
+        5 7 3 1 20 0 1 0 4517 10182656 1234 18446744073709551615 1 1 0 0 0 0 65536 \
+        3670020 1266777851 0 0 0 17 2 0 0 0 0 0\n";
+
+    #[test]
+    fn test_parse_stat_fields() {
+        let fields = parse_stat(STAT).unwrap();
+        assert_eq!(fields.comm, b"bash");
+        assert_eq!(fields.state, b'S');
+        assert_eq!(fields.utime, 5);
+        assert_eq!(fields.stime, 7);
+        assert_eq!(fields.start_time, 4517);
+        assert_eq!(fields.rss_pages, 1234);
+    }
+
+    #[test]
+    fn test_parse_stat_comm_with_spaces_and_parens() {
+        let stat = b"42 (a) R (b c) Z 1 42 42 0 -1 4194560 0 0 0 0 \
+            9 11 0 0 20 0 1 0 77 0 5 18446744073709551615\n";
+        let fields = parse_stat(stat).unwrap();
+        assert_eq!(fields.comm, b"a) R (b c");
+        assert_eq!(fields.state, b'Z');
+        assert_eq!(fields.utime, 9);
+        assert_eq!(fields.stime, 11);
+        assert_eq!(fields.start_time, 77);
+        assert_eq!(fields.rss_pages, 5);
+    }
+
+    #[test]
+    fn test_parse_stat_truncated() {
+        assert!(parse_stat(b"1 (init) S 0 1 1").is_none());
+        assert!(parse_stat(b"garbage").is_none());
+    }
+
+    #[test]
+    fn test_pid_path() {
+        let mut path = [0u8; 32];
+        assert!(pid_path(&mut path, 4194304, b"cmdline"));
+        assert_eq!(&path[..16], b"4194304/cmdline\0");
+    }
+
+    #[test]
+    fn test_parse_pid() {
+        assert_eq!(parse_pid(b"1"), Some(1));
+        assert_eq!(parse_pid(b"4194304"), Some(4194304));
+        assert_eq!(parse_pid(b"self"), None);
+        assert_eq!(parse_pid(b""), None);
+        assert_eq!(parse_pid(b"99999999999"), None);
+    }
+}
@@ -0,0 +1,238 @@
+//! System-wide CPU, memory and load
+//!
+//! CPU use per core comes from the deltas of the `cpu`/`cpuN` lines of
+//! /proc/stat between two samples; memory and swap from /proc/meminfo (used
+//! = total - available); load from /proc/loadavg. The monitoring loop takes
+//! one sample per tick into a `SystemHistory` that clients page through by
+//! sequence number, like the process event log.
+
+use serde::Serialize;
+use std::collections::VecDeque;
+use std::fs;
+use std::path::{Path, PathBuf};
+use std::sync::Mutex;
+use std::time::{SystemTime, UNIX_EPOCH};
+
+/// Samples kept for `get_system_stats`; an hour at the default 2 s tick
+const HISTORY_CAPACITY: usize = 1800;
+
+/// Heaviest processes recorded with each sample
+pub const TOP_PROCESSES: usize = 3;
+
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct TopProcess {
+    pub pid: u32,
+    pub name: String,
+    pub cpu_percent: f64,
+    pub memory_mb: f64,
+}
+
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct SystemSample {
+    /// Assigned by `SystemHistory::push`
+    pub seq: u64,
+    pub timestamp: u64,
+    /// All cores together, 0-100
+    pub cpu_percent: f64,
+    /// Each core, 0-100
+    pub cores: Vec<f64>,
+    pub memory_total_mb: f64,
+    pub memory_used_mb: f64,
+    pub swap_total_mb: f64,
+    pub swap_used_mb: f64,
+    /// 1, 5 and 15 minute load averages
+    pub load: [f64; 3],
+    /// By CPU use, heaviest first
+    pub top: Vec<TopProcess>,
+}
+
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+struct CpuTimes {
+    busy: u64,
+    total: u64,
+}
+
+pub struct SystemCollector {
+    root: PathBuf,
+    /// Aggregate line first, then one per core, from the previous sample
+    previous: Mutex<Vec<CpuTimes>>,
+}
+
+impl SystemCollector {
+    pub fn new() -> Self {
+        Self::with_root(Path::new("/proc"))
+    }
+
+    pub fn with_root(root: &Path) -> Self {
+        Self {
+            root: root.to_path_buf(),
+            previous: Mutex::new(Vec::new()),
+        }
+    }
+
+    /// CPU use is averaged since the previous call (0 on the first). The
+    /// caller fills in `top`.
+    pub fn sample(&self) -> SystemSample {
+        let read = |name: &str| fs::read_to_string(self.root.join(name)).unwrap_or_default();
+
+        let times = parse_cpu_times(&read("stat"));
+        let mut previous = self.previous.lock().unwrap();
+        let usage: Vec<f64> = times
+            .iter()
+            .enumerate()
+            .map(|(i, now)| match previous.get(i) {
+                Some(prev) if now.total > prev.total => {
+                    now.busy.saturating_sub(prev.busy) as f64 / (now.total - prev.total) as f64 * 100.0
+                }
+                _ => 0.0,
+            })
+            .collect();
+        *previous = times;
+        drop(previous);
+
+        let meminfo = read("meminfo");
+        let kb = |key: &str| meminfo_kb(&meminfo, key).unwrap_or(0) as f64 / 1024.0;
+        let memory_total_mb = kb("MemTotal:");
+        let swap_total_mb = kb("SwapTotal:");
+
+        let loadavg = read("loadavg");
+        let mut fields = loadavg.split_whitespace().map(|f| f.parse().unwrap_or(0.0));
+        let load = [
+            fields.next().unwrap_or(0.0),
+            fields.next().unwrap_or(0.0),
+            fields.next().unwrap_or(0.0),
+        ];
+
+        SystemSample {
+            seq: 0,
+            timestamp: SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0),
+            cpu_percent: usage.first().copied().unwrap_or(0.0),
+            cores: usage.iter().skip(1).copied().collect(),
+            memory_total_mb,
+            memory_used_mb: (memory_total_mb - kb("MemAvailable:")).max(0.0),
+            swap_total_mb,
+            swap_used_mb: (swap_total_mb - kb("SwapFree:")).max(0.0),
+            load,
+            top: Vec::new(),
+        }
+    }
+}
+
+impl Default for SystemCollector {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+pub struct SystemHistory {
+    samples: VecDeque<SystemSample>,
+    next_seq: u64,
+}
+
+impl SystemHistory {
+    pub fn new() -> Self {
+        Self {
+            samples: VecDeque::with_capacity(HISTORY_CAPACITY),
+            next_seq: 1,
+        }
+    }
+
+    pub fn push(&mut self, mut sample: SystemSample) {
+        if self.samples.len() == HISTORY_CAPACITY {
+            self.samples.pop_front();
+        }
+        sample.seq = self.next_seq;
+        self.next_seq += 1;
+        self.samples.push_back(sample);
+    }
+
+    /// Samples with a sequence number above `since`, oldest first, capped at
+    /// the newest `limit`. Also returns the sequence number of the newest one.
+    pub fn since(&self, since: u64, limit: usize) -> (Vec<SystemSample>, u64) {
+        let newer = self.samples.iter().filter(|s| s.seq > since).count();
+        let samples = self
+            .samples
+            .iter()
+            .skip(self.samples.len() - newer.min(limit))
+            .cloned()
+            .collect();
+        (samples, self.next_seq - 1)
+    }
+}
+
+impl Default for SystemHistory {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Busy and total jiffies of the `cpu` line and each `cpuN` line
+fn parse_cpu_times(stat: &str) -> Vec<CpuTimes> {
+    stat.lines()
+        .take_while(|line| line.starts_with("cpu"))
+        .map(|line| {
+            // user nice system idle iowait irq softirq steal; guest time is
+            // already counted in user
+            let values: Vec<u64> = line
+                .split_whitespace()
+                .skip(1)
+                .take(8)
+                .map(|v| v.parse().unwrap_or(0))
+                .collect();
+            let total: u64 = values.iter().sum();
+            let idle = values.get(3).copied().unwrap_or(0) + values.get(4).copied().unwrap_or(0);
+            CpuTimes { busy: total - idle, total }
+        })
+        .collect()
+}
+
+fn meminfo_kb(meminfo: &str, key: &str) -> Option<u64> {
+    meminfo
+        .lines()
+        .find_map(|line| line.strip_prefix(key))?
+        .split_whitespace()
+        .next()?
+        .parse()
+        .ok()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_cpu_times() {
+        let stat = "cpu  100 0 50 800 50 0 0 0 0 0\n\
+                    cpu0 60 0 20 400 20 0 0 0 0 0\n\
+                    cpu1 40 0 30 400 30 0 0 0 0 0\n\
+                    intr 12345\n";
+        let times = parse_cpu_times(stat);
+        assert_eq!(times.len(), 3);
+        assert_eq!(times[0], CpuTimes { busy: 150, total: 1000 });
+        assert_eq!(times[2], CpuTimes { busy: 70, total: 500 });
+    }
+
+    #[test]
+    fn test_meminfo_kb() {
+        let meminfo = "MemTotal:       16000000 kB\nMemFree:  100 kB\nMemAvailable:    8000000 kB\n";
+        assert_eq!(meminfo_kb(meminfo, "MemTotal:"), Some(16_000_000));
+        assert_eq!(meminfo_kb(meminfo, "MemAvailable:"), Some(8_000_000));
+        assert_eq!(meminfo_kb(meminfo, "SwapTotal:"), None);
+    }
+
+    #[test]
+    fn test_history_pages_by_seq() {
+        let collector = SystemCollector::with_root(Path::new("/nonexistent"));
+        let mut history = SystemHistory::new();
+        for _ in 0..(HISTORY_CAPACITY + 5) {
+            history.push(collector.sample());
+        }
+        let (all, latest) = history.since(0, usize::MAX);
+        assert_eq!(all.len(), HISTORY_CAPACITY);
+        assert_eq!(latest, HISTORY_CAPACITY as u64 + 5);
+        let (newer, _) = history.since(latest - 2, usize::MAX);
+        assert_eq!(newer.iter().map(|s| s.seq).collect::<Vec<_>>(), vec![latest - 1, latest]);
+        let (limited, _) = history.since(0, 1);
+        assert_eq!(limited[0].seq, latest);
+    }
+}
@@ -10,6 +10,8 @@ pub struct Config {
     pub detection: DetectionConfig,
     pub learning: LearningConfig,
     #[serde(default)]
+    pub retention: RetentionConfig,
+    #[serde(default)]
     pub rules: Vec<Rule>,
 }
 
@@ -19,6 +21,32 @@ pub struct GeneralConfig {
     pub sample_interval_normal: u64,
     pub sample_interval_alert: u64,
     pub notification_method: String,
+    /// Threads used to scan /proc: 0 picks one per core (capped), 1 scans serially
+    #[serde(default)]
+    pub collector_workers: usize,
+    /// Follow process spawn/exit through the netlink proc connector when the
+    /// daemon has CAP_NET_ADMIN; otherwise /proc is polled
+    #[serde(default = "default_true")]
+    pub proc_events: bool,
+    #[serde(default)]
+    pub monitor_mode: MonitorMode,
+}
+
+fn default_true() -> bool {
+    true
+}
+
+/// What the monitoring loop samples and runs the detectors on
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(rename_all = "lowercase")]
+pub enum MonitorMode {
+    /// Individual processes from /proc
+    #[default]
+    Process,
+    /// cgroup v2 totals only; /proc is not scanned
+    Cgroup,
+    /// Both, e.g. to catch a runaway unit and name the process inside it
+    Both,
 }
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
@@ -61,6 +89,33 @@ pub struct LearningConfig {
     pub suggest_whitelist: bool,
 }
 
+/// Alert history retention: old raw alerts are rolled up into hourly
+/// per-name summaries and deleted in small batches
+#[derive(Debug, Clone, Serialize, Deserialize)]
+#[serde(default)]
+pub struct RetentionConfig {
+    pub enabled: bool,
+    /// Raw alerts older than this are rolled up and deleted
+    pub raw_alert_days: u64,
+    /// Hourly summaries older than this are deleted (0 keeps them forever)
+    pub rollup_days: u64,
+    /// Rows rolled up per transaction
+    pub batch_size: u32,
+    pub interval_minutes: u64,
+}
+
+impl Default for RetentionConfig {
+    fn default() -> Self {
+        RetentionConfig {
+            enabled: true,
+            raw_alert_days: 30,
+            rollup_days: 365,
+            batch_size: 500,
+            interval_minutes: 60,
+        }
+    }
+}
+
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct Rule {
     pub name: String,
@@ -81,6 +136,9 @@ impl Default for Config {
                 sample_interval_normal: 10,
                 sample_interval_alert: 2,
                 notification_method: "both".to_string(),
+                collector_workers: 0,
+                proc_events: true,
+                monitor_mode: MonitorMode::Process,
             },
             detection: DetectionConfig {
                 cpu: CpuDetectionConfig {
@@ -104,6 +162,7 @@ impl Default for Config {
                 min_history_days: 7,
                 suggest_whitelist: true,
             },
+            retention: RetentionConfig::default(),
             rules: vec![],
         }
     }
@@ -1,8 +1,12 @@
 //! SQLite database operations
 
+use crate::detector::Alert;
 use rusqlite::{Connection, params};
-use std::path::Path;
-use std::time::{SystemTime, UNIX_EPOCH};
+use std::path::{Path, PathBuf};
+use std::time::{Duration, SystemTime, UNIX_EPOCH};
+
+/// How long a connection waits on another connection's write lock
+const BUSY_TIMEOUT: Duration = Duration::from_secs(5);
 
 pub struct Database {
     conn: Connection,
@@ -21,6 +25,24 @@ pub struct AlertRecord {
     pub action_taken: Option<String>,
 }
 
+#[derive(Debug, Clone, Default)]
+pub struct DbStats {
+    pub size_bytes: i64,
+    pub free_bytes: i64,
+    pub alert_count: i64,
+    pub rollup_count: i64,
+    pub sample_count: i64,
+}
+
+/// One batch of `rollup_expired_alerts`
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct RollupBatch {
+    /// Raw alerts removed
+    pub deleted: usize,
+    /// How many of them were still unacknowledged, as (warning, critical)
+    pub unresolved: (u32, u32),
+}
+
 #[derive(Debug, Clone)]
 pub struct WhitelistEntry {
     pub id: i64,
@@ -35,14 +57,26 @@ impl Database {
             std::fs::create_dir_all(parent).ok();
         }
         let conn = Connection::open(path)?;
+        // auto_vacuum must be set before WAL initializes a new file to take
+        // effect. WAL lets readers run alongside the writer thread; NORMAL sync
+        // only fsyncs at checkpoints, which is durable enough for alert history
+        conn.execute_batch(
+            "PRAGMA auto_vacuum = INCREMENTAL;
+             PRAGMA journal_mode = WAL;
+             PRAGMA synchronous = NORMAL;",
+        )?;
+        conn.busy_timeout(BUSY_TIMEOUT)?;
         Ok(Self { conn })
     }
 
-    pub fn open_default() -> rusqlite::Result<Self> {
-        let path = directories::ProjectDirs::from("", "", "runaway-guard")
+    pub fn default_path() -> PathBuf {
+        directories::ProjectDirs::from("", "", "runaway-guard")
             .map(|dirs| dirs.data_dir().join("runaway-guard.db"))
-            .unwrap_or_else(|| std::path::PathBuf::from("runaway-guard.db"));
-        Self::open(&path)
+            .unwrap_or_else(|| PathBuf::from("runaway-guard.db"))
+    }
+
+    pub fn open_default() -> rusqlite::Result<Self> {
+        Self::open(&Self::default_path())
     }
 
     pub fn init_schema(&self) -> rusqlite::Result<()> {
@@ -54,21 +88,42 @@ impl Database {
     }
 
     pub fn insert_alert(&self, pid: u32, name: &str, cmdline: &str, reason: &str, severity: &str) -> rusqlite::Result<i64> {
-        self.conn.execute(
+        self.conn.prepare_cached(
             "INSERT INTO alerts (timestamp, pid, name, cmdline, reason, severity) VALUES (?1, ?2, ?3, ?4, ?5, ?6)",
-            params![Self::now(), pid, name, cmdline, reason, severity],
-        )?;
+        )?.execute(params![Self::now(), pid, name, cmdline, reason, severity])?;
         Ok(self.conn.last_insert_rowid())
     }
 
+    /// Insert a batch of alerts in a single transaction.
+    pub fn insert_alerts(&self, alerts: &[Alert]) -> rusqlite::Result<usize> {
+        let tx = self.conn.unchecked_transaction()?;
+        {
+            let mut stmt = tx.prepare_cached(
+                "INSERT INTO alerts (timestamp, pid, name, cmdline, reason, severity) VALUES (?1, ?2, ?3, ?4, ?5, ?6)"
+            )?;
+            for alert in alerts {
+                stmt.execute(params![
+                    alert.timestamp as i64,
+                    alert.pid,
+                    alert.name,
+                    alert.cmdline,
+                    alert.reason.as_str(),
+                    alert.severity.as_str(),
+                ])?;
+            }
+        }
+        tx.commit()?;
+        Ok(alerts.len())
+    }
+
     pub fn get_alerts(&self, limit: u32, since: Option<i64>) -> rusqlite::Result<Vec<AlertRecord>> {
         let mut stmt = if since.is_some() {
-            self.conn.prepare(
+            self.conn.prepare_cached(
                 "SELECT id, timestamp, pid, name, cmdline, reason, severity, resolved, action_taken
                  FROM alerts WHERE timestamp >= ?1 ORDER BY timestamp DESC LIMIT ?2"
             )?
         } else {
-            self.conn.prepare(
+            self.conn.prepare_cached(
                 "SELECT id, timestamp, pid, name, cmdline, reason, severity, resolved, action_taken
                  FROM alerts ORDER BY timestamp DESC LIMIT ?1"
             )?
@@ -82,6 +137,29 @@ impl Database {
         rows.collect()
     }
 
+    /// Fetch one page of alerts, newest first, for streaming exports.
+    ///
+    /// Paging is keyset-based on `id` so each page costs the same no matter how
+    /// deep into the history the export is.
+    pub fn get_alerts_page(
+        &self,
+        limit: u32,
+        from: Option<i64>,
+        to: Option<i64>,
+        before_id: Option<i64>,
+    ) -> rusqlite::Result<Vec<AlertRecord>> {
+        let mut stmt = self.conn.prepare_cached(
+            "SELECT id, timestamp, pid, name, cmdline, reason, severity, resolved, action_taken
+             FROM alerts
+             WHERE (?1 IS NULL OR timestamp >= ?1)
+               AND (?2 IS NULL OR timestamp <= ?2)
+               AND (?3 IS NULL OR id < ?3)
+             ORDER BY id DESC LIMIT ?4"
+        )?;
+        let rows = stmt.query_map(params![from, to, before_id, limit], Self::map_alert)?;
+        rows.collect()
+    }
+
     fn map_alert(row: &rusqlite::Row) -> rusqlite::Result<AlertRecord> {
         Ok(AlertRecord {
             id: row.get(0)?,
@@ -101,6 +179,21 @@ impl Database {
         Ok(())
     }
 
+    /// Acknowledge every outstanding alert, returning how many were cleared.
+    pub fn resolve_all_alerts(&self) -> rusqlite::Result<usize> {
+        self.conn.execute("UPDATE alerts SET resolved = 1 WHERE resolved = 0", [])
+    }
+
+    /// Count unacknowledged alerts as (warning, critical).
+    pub fn unresolved_counts(&self) -> rusqlite::Result<(u32, u32)> {
+        self.conn.query_row(
+            "SELECT COALESCE(SUM(severity = 'warning'), 0), COALESCE(SUM(severity = 'critical'), 0)
+             FROM alerts WHERE resolved = 0",
+            [],
+            |row| Ok((row.get(0)?, row.get(1)?)),
+        )
+    }
+
     pub fn add_whitelist(&self, pattern: &str, match_type: &str, reason: Option<&str>) -> rusqlite::Result<i64> {
         self.conn.execute(
             "INSERT INTO whitelist (pattern, match_type, reason, created_at) VALUES (?1, ?2, ?3, ?4)",
@@ -115,7 +208,7 @@ impl Database {
     }
 
     pub fn get_whitelist(&self) -> rusqlite::Result<Vec<WhitelistEntry>> {
-        let mut stmt = self.conn.prepare("SELECT id, pattern, match_type, reason FROM whitelist")?;
+        let mut stmt = self.conn.prepare_cached("SELECT id, pattern, match_type, reason FROM whitelist")?;
         let rows = stmt.query_map([], |row| {
             Ok(WhitelistEntry {
                 id: row.get(0)?,
@@ -151,4 +244,73 @@ impl Database {
         self.conn.execute("DELETE FROM alerts WHERE timestamp < ?1 AND resolved = 1", params![alerts_cutoff])?;
         Ok(())
     }
+
+    /// Roll one batch of alerts older than `cutoff` into `alert_rollups` and
+    /// delete them. Callers loop until nothing is deleted, releasing the
+    /// database between batches, and take the unacknowledged alerts removed
+    /// off their counters.
+    pub fn rollup_expired_alerts(&self, cutoff: i64, batch_size: u32) -> rusqlite::Result<RollupBatch> {
+        let tx = self.conn.unchecked_transaction()?;
+        let unresolved = tx.query_row(
+            "SELECT COALESCE(SUM(severity = 'warning'), 0), COALESCE(SUM(severity = 'critical'), 0)
+             FROM alerts
+             WHERE id IN (SELECT id FROM alerts WHERE timestamp < ?1 ORDER BY id LIMIT ?2) AND resolved = 0",
+            params![cutoff, batch_size],
+            |row| Ok((row.get(0)?, row.get(1)?)),
+        )?;
+        tx.execute(
+            "INSERT INTO alert_rollups (hour, name, reason, count, critical_count)
+             SELECT (timestamp / 3600) * 3600, name, reason, COUNT(*), SUM(severity = 'critical')
+             FROM alerts
+             WHERE id IN (SELECT id FROM alerts WHERE timestamp < ?1 ORDER BY id LIMIT ?2)
+             GROUP BY 1, 2, 3
+             ON CONFLICT (hour, name, reason) DO UPDATE SET
+                 count = count + excluded.count,
+                 critical_count = critical_count + excluded.critical_count",
+            params![cutoff, batch_size],
+        )?;
+        let deleted = tx.execute(
+            "DELETE FROM alerts WHERE id IN (SELECT id FROM alerts WHERE timestamp < ?1 ORDER BY id LIMIT ?2)",
+            params![cutoff, batch_size],
+        )?;
+        tx.commit()?;
+        Ok(RollupBatch { deleted, unresolved })
+    }
+
+    pub fn delete_rollups_before(&self, cutoff: i64) -> rusqlite::Result<usize> {
+        self.conn.execute("DELETE FROM alert_rollups WHERE hour < ?1", params![cutoff])
+    }
+
+    /// Switch an existing database to incremental auto-vacuum. SQLite only
+    /// honours the change after a full VACUUM, so this runs at most once.
+    pub fn ensure_incremental_vacuum(&self) -> rusqlite::Result<bool> {
+        let mode: i32 = self.conn.pragma_query_value(None, "auto_vacuum", |row| row.get(0))?;
+        if mode == 2 {
+            return Ok(false);
+        }
+        self.conn.pragma_update(None, "auto_vacuum", "INCREMENTAL")?;
+        self.conn.execute_batch("VACUUM")?;
+        Ok(true)
+    }
+
+    /// Return up to `pages` free pages to the filesystem
+    pub fn incremental_vacuum(&self, pages: u32) -> rusqlite::Result<()> {
+        self.conn.execute_batch(&format!("PRAGMA incremental_vacuum({})", pages))
+    }
+
+    pub fn stats(&self) -> rusqlite::Result<DbStats> {
+        let page_size: i64 = self.conn.pragma_query_value(None, "page_size", |row| row.get(0))?;
+        let page_count: i64 = self.conn.pragma_query_value(None, "page_count", |row| row.get(0))?;
+        let freelist: i64 = self.conn.pragma_query_value(None, "freelist_count", |row| row.get(0))?;
+        let count = |table: &str| -> rusqlite::Result<i64> {
+            self.conn.query_row(&format!("SELECT COUNT(*) FROM {}", table), [], |row| row.get(0))
+        };
+        Ok(DbStats {
+            size_bytes: page_size * page_count,
+            free_bytes: page_size * freelist,
+            alert_count: count("alerts")?,
+            rollup_count: count("alert_rollups")?,
+            sample_count: count("process_samples")?,
+        })
+    }
 }
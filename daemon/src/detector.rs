@@ -1,8 +1,10 @@
 //! Anomaly detection engine
 
-use crate::collector::ProcessInfo;
+use crate::collector::{CgroupInfo, ProcessInfo, ProcessKey};
 use crate::config::DetectionConfig;
-use std::collections::HashMap;
+use crate::whitelist::WhitelistMatcher;
+use serde::Serialize;
+use std::collections::{HashMap, VecDeque};
 use std::time::{SystemTime, UNIX_EPOCH};
 
 #[derive(Debug, Clone, PartialEq)]
@@ -13,12 +15,34 @@ pub enum AlertReason {
     Timeout,
 }
 
+impl AlertReason {
+    /// Wire/database name of the reason
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            AlertReason::CpuHigh => "cpu_high",
+            AlertReason::Hang => "hang",
+            AlertReason::MemoryLeak => "memory_leak",
+            AlertReason::Timeout => "timeout",
+        }
+    }
+}
+
 #[derive(Debug, Clone, PartialEq)]
 pub enum Severity {
     Warning,
     Critical,
 }
 
+impl Severity {
+    /// Wire/database name of the severity
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            Severity::Warning => "warning",
+            Severity::Critical => "critical",
+        }
+    }
+}
+
 #[derive(Debug, Clone)]
 pub struct Alert {
     pub pid: u32,
@@ -33,21 +57,164 @@ pub trait Detector: Send + Sync {
     fn check(&mut self, process: &ProcessInfo) -> Option<Alert>;
 }
 
+/// CPU/RSS samples kept per process for `process_details`. A process is
+/// only sampled when the scheduler reads it, so for idle processes these
+/// reach further back than for busy ones.
+const RECENT_CAPACITY: usize = 60;
+
+/// One reading of a process as the detector saw it
+#[derive(Debug, Clone, Copy, PartialEq, Serialize)]
+pub struct ProcessSample {
+    pub timestamp: u64,
+    pub cpu_percent: f32,
+    pub memory_mb: f32,
+}
+
+/// Memory samples kept per process, whatever the leak window. Samples are
+/// spaced `window / TREND_CAPACITY` apart so the ring always spans the window.
+const TREND_CAPACITY: usize = 32;
+
+/// Fixed ring of (time, memory) samples with running least-squares sums, so
+/// adding a sample and reading the fitted slope are both O(1).
+#[derive(Debug, Clone)]
+struct MemoryTrend {
+    /// (seconds since `origin`, memory_mb)
+    samples: [(f64, f64); TREND_CAPACITY],
+    /// Index of the oldest sample
+    head: usize,
+    len: usize,
+    origin: u64,
+    last_push: u64,
+    sum_t: f64,
+    sum_m: f64,
+    sum_tt: f64,
+    sum_tm: f64,
+}
+
+impl MemoryTrend {
+    fn new(origin: u64) -> Self {
+        Self {
+            samples: [(0.0, 0.0); TREND_CAPACITY],
+            head: 0,
+            len: 0,
+            origin,
+            last_push: 0,
+            sum_t: 0.0,
+            sum_m: 0.0,
+            sum_tt: 0.0,
+            sum_tm: 0.0,
+        }
+    }
+
+    fn push(&mut self, now: u64, memory_mb: f64, window_seconds: u64) {
+        // Expire samples that fell out of the window
+        let cutoff = now.saturating_sub(window_seconds).saturating_sub(self.origin) as f64;
+        while self.len > 0 && self.samples[self.head].0 < cutoff {
+            self.pop_front();
+        }
+
+        let spacing = window_seconds / TREND_CAPACITY as u64;
+        if self.len > 0 && now.saturating_sub(self.last_push) < spacing {
+            return;
+        }
+        if self.len == TREND_CAPACITY {
+            self.pop_front();
+        }
+
+        let t = now.saturating_sub(self.origin) as f64;
+        let tail = (self.head + self.len) % TREND_CAPACITY;
+        self.samples[tail] = (t, memory_mb);
+        self.len += 1;
+        self.last_push = now;
+        self.sum_t += t;
+        self.sum_m += memory_mb;
+        self.sum_tt += t * t;
+        self.sum_tm += t * memory_mb;
+    }
+
+    fn pop_front(&mut self) {
+        let (t, m) = self.samples[self.head];
+        self.head = (self.head + 1) % TREND_CAPACITY;
+        self.len -= 1;
+        if self.head == 0 || self.len == 0 {
+            // Once per lap, recompute exactly so subtraction error can't build up
+            self.recompute_sums();
+        } else {
+            self.sum_t -= t;
+            self.sum_m -= m;
+            self.sum_tt -= t * t;
+            self.sum_tm -= t * m;
+        }
+    }
+
+    fn recompute_sums(&mut self) {
+        self.sum_t = 0.0;
+        self.sum_m = 0.0;
+        self.sum_tt = 0.0;
+        self.sum_tm = 0.0;
+        for i in 0..self.len {
+            let (t, m) = self.samples[(self.head + i) % TREND_CAPACITY];
+            self.sum_t += t;
+            self.sum_m += m;
+            self.sum_tt += t * t;
+            self.sum_tm += t * m;
+        }
+    }
+
+    /// Least-squares slope in MB per second, once there are two samples at
+    /// different times
+    fn slope(&self) -> Option<f64> {
+        if self.len < 2 {
+            return None;
+        }
+        let n = self.len as f64;
+        let denominator = n * self.sum_tt - self.sum_t * self.sum_t;
+        if denominator <= f64::EPSILON {
+            return None;
+        }
+        Some((n * self.sum_tm - self.sum_t * self.sum_m) / denominator)
+    }
+
+    /// Seconds between the oldest and newest sample
+    fn span(&self) -> f64 {
+        if self.len < 2 {
+            return 0.0;
+        }
+        let newest = (self.head + self.len - 1) % TREND_CAPACITY;
+        self.samples[newest].0 - self.samples[self.head].0
+    }
+}
+
 /// Tracks process state over time for anomaly detection
 #[derive(Debug, Clone)]
 struct ProcessHistory {
     first_seen: u64,
     last_state: char,
     state_unchanged_since: u64,
-    memory_samples: Vec<(u64, f64)>, // (timestamp, memory_mb)
+    memory: MemoryTrend,
+    cpu_high_since: Option<u64>,
+    /// Oldest first, at most RECENT_CAPACITY
+    recent: VecDeque<ProcessSample>,
+    /// Tick that last checked this process; older entries are swept
+    generation: u64,
+}
+
+/// Tracks a cgroup over time; only the CPU and memory checks apply
+#[derive(Debug, Clone)]
+struct CgroupHistory {
+    memory: MemoryTrend,
     cpu_high_since: Option<u64>,
+    generation: u64,
 }
 
 /// Main anomaly detector combining all detection modes
 pub struct AnomalyDetector {
     config: DetectionConfig,
-    history: HashMap<u32, ProcessHistory>,
-    whitelisted_names: Vec<String>,
+    history: HashMap<ProcessKey, ProcessHistory>,
+    /// Keyed by path below the cgroup root
+    cgroup_history: HashMap<String, CgroupHistory>,
+    whitelist: WhitelistMatcher,
+    generation: u64,
 }
 
 impl AnomalyDetector {
@@ -55,18 +222,32 @@ impl AnomalyDetector {
         Self {
             config,
             history: HashMap::new(),
-            whitelisted_names: Vec::new(),
+            cgroup_history: HashMap::new(),
+            whitelist: WhitelistMatcher::new(),
+            generation: 0,
         }
     }
 
+    pub fn set_config(&mut self, config: DetectionConfig) {
+        self.config = config;
+    }
+
+    pub fn config(&self) -> &DetectionConfig {
+        &self.config
+    }
+
+    /// Whitelist a process name (exact match)
     pub fn add_whitelist(&mut self, name: String) {
-        if !self.whitelisted_names.contains(&name) {
-            self.whitelisted_names.push(name);
-        }
+        self.whitelist.add_name(name);
     }
 
-    pub fn is_whitelisted(&self, name: &str) -> bool {
-        self.whitelisted_names.iter().any(|w| name.contains(w))
+    /// Swap in a freshly compiled whitelist
+    pub fn set_whitelist(&mut self, whitelist: WhitelistMatcher) {
+        self.whitelist = whitelist;
+    }
+
+    pub fn is_whitelisted(&self, process: &ProcessInfo) -> bool {
+        self.whitelist.matches(&process.name, &process.cmdline)
     }
 
     fn now() -> u64 {
@@ -76,7 +257,7 @@ impl AnomalyDetector {
             .unwrap_or(0)
     }
 
-    fn check_cpu_for_pid(&mut self, process: &ProcessInfo, pid: u32, now: u64) -> Option<Alert> {
+    fn check_cpu_for_pid(&mut self, process: &ProcessInfo, key: ProcessKey, now: u64) -> Option<Alert> {
         if !self.config.cpu.enabled {
             return None;
         }
@@ -84,7 +265,7 @@ impl AnomalyDetector {
         let threshold = self.config.cpu.threshold_percent as f64;
         let duration = self.config.cpu.duration_seconds;
 
-        let history = self.history.get_mut(&pid)?;
+        let history = self.history.get_mut(&key)?;
 
         if process.cpu_percent >= threshold {
             let high_since = history.cpu_high_since.get_or_insert(now);
@@ -141,23 +322,10 @@ impl AnomalyDetector {
             return None;
         }
 
-        let window_seconds = self.config.memory.window_minutes * 60;
         let now = Self::now();
-        let cutoff = now.saturating_sub(window_seconds);
-
-        // Find oldest sample within window
-        let samples_in_window: Vec<_> = history
-            .memory_samples
-            .iter()
-            .filter(|(ts, _)| *ts >= cutoff)
-            .collect();
-
-        if samples_in_window.len() < 2 {
-            return None;
-        }
-
-        let oldest = samples_in_window.first().map(|(_, m)| *m).unwrap_or(0.0);
-        let growth = process.memory_mb - oldest;
+        // Growth along the fitted line across the samples in the window; a
+        // single spike moves the fit far less than it moves (last - first)
+        let growth = history.memory.slope()? * history.memory.span();
 
         if growth >= self.config.memory.growth_mb as f64 {
             return Some(Alert {
@@ -176,30 +344,122 @@ impl AnomalyDetector {
         None
     }
 
-    /// Clean up history for processes that no longer exist
-    pub fn cleanup(&mut self, active_pids: &[u32]) {
-        self.history.retain(|pid, _| active_pids.contains(pid));
+    /// Fitted memory growth of a process over the leak window, in MB per
+    /// minute. `None` until there are enough samples.
+    pub fn leak_rate(&self, key: &ProcessKey) -> Option<f64> {
+        self.history.get(key)?.memory.slope().map(|per_second| per_second * 60.0)
+    }
+
+    /// The last samples of a process, oldest first. Empty for whitelisted
+    /// processes and ones not checked yet.
+    pub fn recent_samples(&self, key: &ProcessKey) -> Vec<ProcessSample> {
+        self.history.get(key).map(|history| history.recent.iter().copied().collect()).unwrap_or_default()
+    }
+
+    /// Run the CPU and memory leak checks against a cgroup's totals. The
+    /// whitelist applies with the last path component as the name and the
+    /// full path as the command line. Alerts carry pid 0 and the path in
+    /// `cmdline`.
+    pub fn check_cgroup(&mut self, cgroup: &CgroupInfo) -> Option<Alert> {
+        let name = cgroup.name();
+        if self.whitelist.matches(name, &cgroup.path) {
+            return None;
+        }
+
+        let now = Self::now();
+        let generation = self.generation;
+        let window_seconds = self.config.memory.window_minutes * 60;
+        let history = self
+            .cgroup_history
+            .entry(cgroup.path.clone())
+            .or_insert_with(|| CgroupHistory {
+                memory: MemoryTrend::new(now),
+                cpu_high_since: None,
+                generation,
+            });
+        history.generation = generation;
+        if let Some(memory_mb) = cgroup.memory_mb {
+            history.memory.push(now, memory_mb, window_seconds);
+        }
+
+        let alert = |reason, critical| Alert {
+            pid: 0,
+            name: name.to_string(),
+            cmdline: cgroup.path.clone(),
+            reason,
+            severity: if critical { Severity::Critical } else { Severity::Warning },
+            timestamp: now,
+        };
+
+        if self.config.cpu.enabled && cgroup.cpu_percent >= self.config.cpu.threshold_percent as f64 {
+            let high_for = now - *history.cpu_high_since.get_or_insert(now);
+            let duration = self.config.cpu.duration_seconds;
+            if high_for >= duration {
+                return Some(alert(AlertReason::CpuHigh, high_for >= duration * 2));
+            }
+        } else {
+            history.cpu_high_since = None;
+        }
+
+        if self.config.memory.enabled {
+            let growth = history.memory.slope()? * history.memory.span();
+            let threshold = self.config.memory.growth_mb as f64;
+            if growth >= threshold {
+                return Some(alert(AlertReason::MemoryLeak, growth >= threshold * 2.0));
+            }
+        }
+        None
+    }
+
+    /// As `leak_rate`, for a cgroup checked with `check_cgroup`
+    pub fn cgroup_leak_rate(&self, path: &str) -> Option<f64> {
+        self.cgroup_history.get(path)?.memory.slope().map(|per_second| per_second * 60.0)
+    }
+
+    /// Start a monitoring tick. Every process checked until the next
+    /// `sweep` is stamped with this tick.
+    pub fn begin_tick(&mut self) {
+        self.generation += 1;
+    }
+
+    /// Keep a live process's history through a tick it was not sampled on
+    pub fn touch(&mut self, key: &ProcessKey) {
+        if let Some(history) = self.history.get_mut(key) {
+            history.generation = self.generation;
+        }
+    }
+
+    /// Drop history for processes not checked since `begin_tick`: exited
+    /// processes and the previous owners of recycled PIDs.
+    pub fn sweep(&mut self) {
+        let generation = self.generation;
+        self.history.retain(|_, history| history.generation == generation);
+        self.cgroup_history.retain(|_, history| history.generation == generation);
     }
 }
 
 impl Detector for AnomalyDetector {
     fn check(&mut self, process: &ProcessInfo) -> Option<Alert> {
-        if self.is_whitelisted(&process.name) {
+        if self.is_whitelisted(process) {
             return None;
         }
 
         let now = Self::now();
-        let pid = process.pid;
+        let key = process.key();
+        let generation = self.generation;
 
         // Update history first
         {
-            let history = self.history.entry(pid).or_insert_with(|| ProcessHistory {
+            let history = self.history.entry(key).or_insert_with(|| ProcessHistory {
                 first_seen: now,
                 last_state: process.state,
                 state_unchanged_since: now,
-                memory_samples: Vec::new(),
+                memory: MemoryTrend::new(now),
                 cpu_high_since: None,
+                recent: VecDeque::with_capacity(RECENT_CAPACITY),
+                generation,
             });
+            history.generation = generation;
 
             // Update state tracking
             if history.last_state != process.state {
@@ -207,21 +467,25 @@ impl Detector for AnomalyDetector {
                 history.state_unchanged_since = now;
             }
 
-            // Add memory sample (keep last 60 samples)
-            history.memory_samples.push((now, process.memory_mb));
-            if history.memory_samples.len() > 60 {
-                history.memory_samples.remove(0);
+            history.memory.push(now, process.memory_mb, self.config.memory.window_minutes * 60);
+            if history.recent.len() == RECENT_CAPACITY {
+                history.recent.pop_front();
             }
+            history.recent.push_back(ProcessSample {
+                timestamp: now,
+                cpu_percent: process.cpu_percent as f32,
+                memory_mb: process.memory_mb as f32,
+            });
         }
 
         // Run checks with separate borrows
         // CPU check (needs mutable access to update cpu_high_since)
-        if let Some(alert) = self.check_cpu_for_pid(process, pid, now) {
+        if let Some(alert) = self.check_cpu_for_pid(process, key, now) {
             return Some(alert);
         }
 
         // Get immutable history for other checks
-        if let Some(history) = self.history.get(&pid) {
+        if let Some(history) = self.history.get(&key) {
             if let Some(alert) = self.check_hang(process, history) {
                 return Some(alert);
             }
@@ -269,6 +533,7 @@ mod tests {
             runtime_seconds: 100,
             state: 'S',
             start_time: 0,
+            start_ticks: 0,
         }
     }
 
@@ -300,7 +565,7 @@ mod tests {
         detector.check(&process);
 
         // Manually set state_unchanged_since to simulate time passing
-        if let Some(h) = detector.history.get_mut(&1) {
+        if let Some(h) = detector.history.get_mut(&process.key()) {
             h.state_unchanged_since = AnomalyDetector::now() - 10;
         }
 
@@ -309,4 +574,144 @@ mod tests {
         let a = alert.unwrap();
         assert_eq!(a.reason, AlertReason::Hang);
     }
+
+    #[test]
+    fn test_recent_samples_are_bounded() {
+        let mut detector = AnomalyDetector::new(test_config());
+        let mut process = test_process(1);
+        for i in 0..RECENT_CAPACITY + 5 {
+            process.memory_mb = i as f64;
+            detector.check(&process);
+        }
+        let recent = detector.recent_samples(&process.key());
+        assert_eq!(recent.len(), RECENT_CAPACITY);
+        assert_eq!(recent[0].memory_mb, 5.0);
+        assert_eq!(recent[RECENT_CAPACITY - 1].memory_mb, (RECENT_CAPACITY + 4) as f32);
+        assert!(detector.recent_samples(&test_process(2).key()).is_empty());
+    }
+
+    #[test]
+    fn test_recycled_pid_starts_fresh_history() {
+        let mut detector = AnomalyDetector::new(test_config());
+        let mut process = test_process(1);
+        process.cpu_percent = 100.0;
+        detector.begin_tick();
+        detector.check(&process);
+        detector.history.get_mut(&process.key()).unwrap().cpu_high_since =
+            Some(AnomalyDetector::now() - 10);
+
+        // Same PID, different start time: a new process, no inherited CPU history
+        let mut reused = process.clone();
+        reused.start_ticks = 50;
+        detector.begin_tick();
+        assert!(detector.check(&reused).is_none());
+        detector.sweep();
+        assert_eq!(detector.history.len(), 1);
+        assert!(detector.history.contains_key(&reused.key()));
+    }
+
+    #[test]
+    fn test_sweep_drops_unchecked_processes() {
+        let mut detector = AnomalyDetector::new(test_config());
+        detector.begin_tick();
+        detector.check(&test_process(1));
+        detector.check(&test_process(2));
+        detector.sweep();
+        assert_eq!(detector.history.len(), 2);
+
+        detector.begin_tick();
+        detector.check(&test_process(2));
+        detector.sweep();
+        assert_eq!(detector.history.len(), 1);
+        assert!(detector.history.contains_key(&test_process(2).key()));
+    }
+
+    #[test]
+    fn test_memory_trend_fits_linear_growth() {
+        let mut trend = MemoryTrend::new(1000);
+        for i in 0..10u64 {
+            // 2 MB every 10 s = 12 MB/min
+            trend.push(1000 + i * 10, 100.0 + 2.0 * i as f64, 300);
+        }
+        assert!((trend.slope().unwrap() * 60.0 - 12.0).abs() < 1e-9);
+        assert_eq!(trend.span(), 90.0);
+    }
+
+    #[test]
+    fn test_memory_trend_is_bounded_and_windowed() {
+        let window = 600;
+        let mut trend = MemoryTrend::new(0);
+        for i in 0..10_000u64 {
+            trend.push(i, (i % 7) as f64, window);
+            assert!(trend.len <= TREND_CAPACITY);
+        }
+        // Only samples inside the window remain, spaced to cover it
+        assert!(trend.span() <= window as f64);
+        assert!(trend.span() >= window as f64 * 0.9);
+
+        // Flat after the sawtooth: running sums must agree with a fresh fit
+        for i in 10_000..10_000 + 2 * window {
+            trend.push(i, 50.0, window);
+        }
+        assert!(trend.slope().unwrap().abs() < 1e-9);
+    }
+
+    #[test]
+    fn test_memory_leak_alert_from_trend() {
+        let mut detector = AnomalyDetector::new(test_config());
+        let mut process = test_process(1);
+        detector.check(&process);
+
+        // Pretend the first sample was taken 50 s ago, then report 150 MB more
+        let key = process.key();
+        {
+            let trend = &mut detector.history.get_mut(&key).unwrap().memory;
+            trend.origin -= 50;
+            trend.last_push -= 50;
+        }
+        process.memory_mb += 150.0;
+        let alert = detector.check(&process).expect("leak alert");
+        assert_eq!(alert.reason, AlertReason::MemoryLeak);
+        assert!(detector.leak_rate(&key).unwrap() > 100.0);
+    }
+
+    #[test]
+    fn test_cgroup_checks() {
+        let mut detector = AnomalyDetector::new(test_config());
+        let mut cgroup = CgroupInfo {
+            path: "system.slice/leaky.service".to_string(),
+            cpu_percent: 100.0,
+            memory_mb: Some(200.0),
+            memory_events: Default::default(),
+            pids: vec![10, 11],
+            leaf: true,
+        };
+        detector.begin_tick();
+        assert!(detector.check_cgroup(&cgroup).is_none());
+
+        // Memory: as for processes, from the fitted trend
+        {
+            let history = detector.cgroup_history.get_mut(&cgroup.path).unwrap();
+            history.memory.origin -= 50;
+            history.memory.last_push -= 50;
+            history.cpu_high_since = Some(AnomalyDetector::now() - 1);
+        }
+        cgroup.memory_mb = Some(350.0);
+        let alert = detector.check_cgroup(&cgroup).expect("leak alert");
+        assert_eq!(alert.reason, AlertReason::MemoryLeak);
+        assert_eq!((alert.pid, alert.name.as_str()), (0, "leaky.service"));
+        assert!(detector.cgroup_leak_rate(&cgroup.path).unwrap() > 100.0);
+
+        // CPU: high for longer than the configured duration
+        detector.cgroup_history.get_mut(&cgroup.path).unwrap().cpu_high_since =
+            Some(AnomalyDetector::now() - 10);
+        assert_eq!(detector.check_cgroup(&cgroup).unwrap().reason, AlertReason::CpuHigh);
+
+        // Whitelisted by path, and swept once no longer checked
+        detector.set_whitelist(WhitelistMatcher::build([("system.slice/", "cmdline")]));
+        assert!(detector.check_cgroup(&cgroup).is_none());
+        detector.begin_tick();
+        detector.sweep();
+        assert!(detector.cgroup_history.is_empty());
+    }
 }
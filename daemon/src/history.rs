@@ -0,0 +1,486 @@
+//! Persistent round-robin history of system totals and top processes
+//!
+//! One fixed-size file per resolution under the data directory, each mapped
+//! with mmap and used as a ring of slots: the slot for time `t` is
+//! `(t / secs) % slots`, so a write is a few stores into the mapping and the
+//! files never grow. Every tick's system sample is folded into the current
+//! slot of each file (sums, so a slot holds the mean of its samples), along
+//! with the heaviest processes; a slot keeps the `SLOT_TOP` processes with
+//! the most CPU over its interval. A slot whose stored timestamp is not the
+//! one being read is stale (from an earlier lap) and treated as empty.
+//!
+//! Layout, little-endian: a 32-byte header (magic, version, resolution,
+//! slot count, slot size), then the slots. A file whose header does not
+//! match the current layout is cleared.
+
+use crate::collector::SystemSample;
+use serde::Serialize;
+use std::fs::{self, File, OpenOptions};
+use std::io;
+use std::os::fd::AsRawFd;
+use std::path::{Path, PathBuf};
+
+const MAGIC: &[u8; 4] = b"RGTS";
+const VERSION: u32 = 1;
+const HEADER_SIZE: usize = 32;
+
+/// Processes kept per slot
+pub const SLOT_TOP: usize = 5;
+/// Process names are truncated to this many bytes, as in /proc/<pid>/comm
+const NAME_LEN: usize = 16;
+/// pid, CPU sum, memory max, name
+const TOP_SIZE: usize = 4 + 4 + 4 + NAME_LEN;
+/// timestamp, count, reserved, CPU/memory/swap/load sums, top processes
+const SLOT_SIZE: usize = 8 + 4 + 4 + 4 * 4 + SLOT_TOP * TOP_SIZE;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Resolution {
+    pub name: &'static str,
+    pub secs: u64,
+    pub slots: u64,
+}
+
+impl Resolution {
+    pub fn retention_secs(&self) -> u64 {
+        self.secs * self.slots
+    }
+}
+
+/// Finest first: an hour of seconds, a day of minutes, 90 days of hours
+pub const RESOLUTIONS: [Resolution; 3] = [
+    Resolution { name: "1s", secs: 1, slots: 3600 },
+    Resolution { name: "1m", secs: 60, slots: 1440 },
+    Resolution { name: "1h", secs: 3600, slots: 2160 },
+];
+
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct HistoryProcess {
+    pub pid: u32,
+    pub name: String,
+    /// Mean over the slot, counting samples where it was not on top as 0
+    pub cpu_percent: f64,
+    /// Largest seen in the slot
+    pub memory_mb: f64,
+}
+
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct HistoryPoint {
+    /// Start of the slot
+    pub timestamp: u64,
+    /// Ticks folded into the slot
+    pub samples: u32,
+    pub cpu_percent: f64,
+    pub memory_used_mb: f64,
+    pub swap_used_mb: f64,
+    pub load: f64,
+    /// Heaviest first
+    pub top: Vec<HistoryProcess>,
+}
+
+/// One process's share of a slot
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct ProcessPoint {
+    pub timestamp: u64,
+    pub pid: u32,
+    pub cpu_percent: f64,
+    pub memory_mb: f64,
+}
+
+#[derive(Debug, Clone, Default)]
+struct TopEntry {
+    pid: u32,
+    cpu_sum: f32,
+    memory_max: f32,
+    name: String,
+}
+
+#[derive(Debug, Clone, Default)]
+struct Slot {
+    timestamp: u64,
+    count: u32,
+    cpu_sum: f32,
+    memory_sum: f32,
+    swap_sum: f32,
+    load_sum: f32,
+    top: Vec<TopEntry>,
+}
+
+impl Slot {
+    fn decode(bytes: &[u8]) -> Slot {
+        let u32_at = |at: usize| u32::from_le_bytes(bytes[at..at + 4].try_into().unwrap());
+        let f32_at = |at: usize| f32::from_le_bytes(bytes[at..at + 4].try_into().unwrap());
+        let mut top = Vec::new();
+        for i in 0..SLOT_TOP {
+            let at = 32 + i * TOP_SIZE;
+            let name = &bytes[at + 12..at + TOP_SIZE];
+            let len = name.iter().position(|&b| b == 0).unwrap_or(NAME_LEN);
+            if len == 0 {
+                break;
+            }
+            top.push(TopEntry {
+                pid: u32_at(at),
+                cpu_sum: f32_at(at + 4),
+                memory_max: f32_at(at + 8),
+                name: String::from_utf8_lossy(&name[..len]).into_owned(),
+            });
+        }
+        Slot {
+            timestamp: u64::from_le_bytes(bytes[0..8].try_into().unwrap()),
+            count: u32_at(8),
+            cpu_sum: f32_at(16),
+            memory_sum: f32_at(20),
+            swap_sum: f32_at(24),
+            load_sum: f32_at(28),
+            top,
+        }
+    }
+
+    fn encode(&self, bytes: &mut [u8]) {
+        bytes.fill(0);
+        bytes[0..8].copy_from_slice(&self.timestamp.to_le_bytes());
+        bytes[8..12].copy_from_slice(&self.count.to_le_bytes());
+        bytes[16..20].copy_from_slice(&self.cpu_sum.to_le_bytes());
+        bytes[20..24].copy_from_slice(&self.memory_sum.to_le_bytes());
+        bytes[24..28].copy_from_slice(&self.swap_sum.to_le_bytes());
+        bytes[28..32].copy_from_slice(&self.load_sum.to_le_bytes());
+        for (i, entry) in self.top.iter().take(SLOT_TOP).enumerate() {
+            let at = 32 + i * TOP_SIZE;
+            bytes[at..at + 4].copy_from_slice(&entry.pid.to_le_bytes());
+            bytes[at + 4..at + 8].copy_from_slice(&entry.cpu_sum.to_le_bytes());
+            bytes[at + 8..at + 12].copy_from_slice(&entry.memory_max.to_le_bytes());
+            let name = truncate_name(&entry.name);
+            bytes[at + 12..at + 12 + name.len()].copy_from_slice(name);
+        }
+    }
+
+    fn fold(&mut self, sample: &SystemSample) {
+        self.count += 1;
+        self.cpu_sum += sample.cpu_percent as f32;
+        self.memory_sum += sample.memory_used_mb as f32;
+        self.swap_sum += sample.swap_used_mb as f32;
+        self.load_sum += sample.load[0] as f32;
+        for process in &sample.top {
+            // Names are compared as stored, so a long name still matches
+            let name = String::from_utf8_lossy(truncate_name(&process.name)).into_owned();
+            match self.top.iter_mut().find(|e| e.pid == process.pid && e.name == name) {
+                Some(entry) => {
+                    entry.cpu_sum += process.cpu_percent as f32;
+                    entry.memory_max = entry.memory_max.max(process.memory_mb as f32);
+                }
+                None => self.top.push(TopEntry {
+                    pid: process.pid,
+                    cpu_sum: process.cpu_percent as f32,
+                    memory_max: process.memory_mb as f32,
+                    name,
+                }),
+            }
+        }
+        self.top.sort_by(|a, b| b.cpu_sum.total_cmp(&a.cpu_sum));
+        self.top.truncate(SLOT_TOP);
+    }
+
+    fn point(&self) -> HistoryPoint {
+        let n = self.count.max(1) as f64;
+        HistoryPoint {
+            timestamp: self.timestamp,
+            samples: self.count,
+            cpu_percent: self.cpu_sum as f64 / n,
+            memory_used_mb: self.memory_sum as f64 / n,
+            swap_used_mb: self.swap_sum as f64 / n,
+            load: self.load_sum as f64 / n,
+            top: self
+                .top
+                .iter()
+                .map(|e| HistoryProcess {
+                    pid: e.pid,
+                    name: e.name.clone(),
+                    cpu_percent: e.cpu_sum as f64 / n,
+                    memory_mb: e.memory_max as f64,
+                })
+                .collect(),
+        }
+    }
+}
+
+/// At most NAME_LEN bytes, cut on a character boundary
+fn truncate_name(name: &str) -> &[u8] {
+    let mut end = name.len().min(NAME_LEN);
+    while !name.is_char_boundary(end) {
+        end -= 1;
+    }
+    &name.as_bytes()[..end]
+}
+
+/// A file mapped read-write for its whole length
+struct RingFile {
+    resolution: Resolution,
+    ptr: *mut u8,
+    len: usize,
+    _file: File,
+}
+
+// The mapping is only reached through &self/&mut self of the store, which
+// callers keep behind a mutex
+unsafe impl Send for RingFile {}
+
+impl RingFile {
+    fn open(path: &Path, resolution: Resolution) -> io::Result<Self> {
+        let len = HEADER_SIZE + resolution.slots as usize * SLOT_SIZE;
+        let file = OpenOptions::new().read(true).write(true).create(true).truncate(false).open(path)?;
+        let header = Self::header(resolution);
+        let mut existing = [0u8; HEADER_SIZE];
+        let valid = file.metadata()?.len() == len as u64
+            && std::os::unix::fs::FileExt::read_exact_at(&file, &mut existing, 0).is_ok()
+            && existing == header;
+        if !valid {
+            // New, or written with another layout: start empty
+            file.set_len(0)?;
+            file.set_len(len as u64)?;
+            std::os::unix::fs::FileExt::write_all_at(&file, &header, 0)?;
+        }
+
+        let ptr = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_SHARED,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(Self { resolution, ptr: ptr as *mut u8, len, _file: file })
+    }
+
+    fn header(resolution: Resolution) -> [u8; HEADER_SIZE] {
+        let mut header = [0u8; HEADER_SIZE];
+        header[0..4].copy_from_slice(MAGIC);
+        header[4..8].copy_from_slice(&VERSION.to_le_bytes());
+        header[8..16].copy_from_slice(&resolution.secs.to_le_bytes());
+        header[16..24].copy_from_slice(&resolution.slots.to_le_bytes());
+        header[24..28].copy_from_slice(&(SLOT_SIZE as u32).to_le_bytes());
+        header
+    }
+
+    fn slot_range(&self, timestamp: u64) -> std::ops::Range<usize> {
+        let index = (timestamp / self.resolution.secs % self.resolution.slots) as usize;
+        let start = HEADER_SIZE + index * SLOT_SIZE;
+        start..start + SLOT_SIZE
+    }
+
+    fn bytes(&self) -> &[u8] {
+        unsafe { std::slice::from_raw_parts(self.ptr, self.len) }
+    }
+
+    fn bytes_mut(&mut self) -> &mut [u8] {
+        unsafe { std::slice::from_raw_parts_mut(self.ptr, self.len) }
+    }
+
+    /// The slot starting at `aligned`, if it holds data for that interval
+    fn read(&self, aligned: u64) -> Option<Slot> {
+        let slot = Slot::decode(&self.bytes()[self.slot_range(aligned)]);
+        (slot.timestamp == aligned && slot.count > 0).then_some(slot)
+    }
+
+    fn record(&mut self, sample: &SystemSample) {
+        let aligned = sample.timestamp - sample.timestamp % self.resolution.secs;
+        let mut slot = self.read(aligned).unwrap_or(Slot { timestamp: aligned, ..Slot::default() });
+        slot.fold(sample);
+        let range = self.slot_range(aligned);
+        slot.encode(&mut self.bytes_mut()[range]);
+    }
+}
+
+impl Drop for RingFile {
+    fn drop(&mut self) {
+        unsafe {
+            libc::munmap(self.ptr as *mut libc::c_void, self.len);
+        }
+    }
+}
+
+pub struct HistoryStore {
+    rings: Vec<RingFile>,
+}
+
+impl HistoryStore {
+    /// `history/` next to the database
+    pub fn default_dir() -> PathBuf {
+        directories::ProjectDirs::from("", "", "runaway-guard")
+            .map(|dirs| dirs.data_dir().join("history"))
+            .unwrap_or_else(|| PathBuf::from("history"))
+    }
+
+    pub fn open(dir: &Path) -> io::Result<Self> {
+        fs::create_dir_all(dir)?;
+        let rings = RESOLUTIONS
+            .iter()
+            .map(|&resolution| RingFile::open(&dir.join(format!("{}.rrd", resolution.name)), resolution))
+            .collect::<io::Result<_>>()?;
+        Ok(Self { rings })
+    }
+
+    /// Fold one tick's sample (with its top processes) into every resolution
+    pub fn record(&mut self, sample: &SystemSample) {
+        for ring in &mut self.rings {
+            ring.record(sample);
+        }
+    }
+
+    /// Resolution for a query: the named one, or else the finest whose
+    /// retention still reaches back to `from`
+    pub fn resolution_for(name: Option<&str>, from: u64, now: u64) -> Option<Resolution> {
+        match name {
+            Some(name) => RESOLUTIONS.iter().find(|r| r.name == name).copied(),
+            None => Some(
+                RESOLUTIONS
+                    .iter()
+                    .find(|r| now.saturating_sub(from) < r.retention_secs())
+                    .copied()
+                    .unwrap_or(RESOLUTIONS[RESOLUTIONS.len() - 1]),
+            ),
+        }
+    }
+
+    /// Stored slots between `from` and `to` (inclusive), oldest first.
+    /// Slots with no samples are left out.
+    pub fn query(&self, resolution: Resolution, from: u64, to: u64, now: u64) -> Vec<HistoryPoint> {
+        let Some(ring) = self.rings.iter().find(|r| r.resolution == resolution) else {
+            return Vec::new();
+        };
+        // Older slots have been overwritten
+        let earliest = now.saturating_sub(resolution.retention_secs() - resolution.secs);
+        let from = from.max(earliest);
+        let mut points = Vec::new();
+        let mut aligned = from - from % resolution.secs;
+        while aligned <= to.min(now) {
+            if let Some(slot) = ring.read(aligned) {
+                points.push(slot.point());
+            }
+            aligned += resolution.secs;
+        }
+        points
+    }
+}
+
+/// A process's CPU and memory from history points, matching by PID or by
+/// name. A process only appears in slots where it was among the heaviest.
+pub fn process_points(points: &[HistoryPoint], pid: Option<u32>, name: Option<&str>) -> Vec<ProcessPoint> {
+    let name = name.map(|name| String::from_utf8_lossy(truncate_name(name)).into_owned());
+    points
+        .iter()
+        .filter_map(|point| {
+            let process = point.top.iter().find(|p| {
+                pid.map_or(true, |pid| p.pid == pid) && name.as_ref().map_or(true, |name| &p.name == name)
+            })?;
+            Some(ProcessPoint {
+                timestamp: point.timestamp,
+                pid: process.pid,
+                cpu_percent: process.cpu_percent,
+                memory_mb: process.memory_mb,
+            })
+        })
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::collector::TopProcess;
+
+    fn sample(timestamp: u64, cpu: f64, top: &[(u32, &str, f64)]) -> SystemSample {
+        SystemSample {
+            seq: 0,
+            timestamp,
+            cpu_percent: cpu,
+            cores: Vec::new(),
+            memory_total_mb: 8192.0,
+            memory_used_mb: 4096.0,
+            swap_total_mb: 0.0,
+            swap_used_mb: 0.0,
+            load: [1.0, 0.0, 0.0],
+            top: top
+                .iter()
+                .map(|&(pid, name, cpu_percent)| TopProcess {
+                    pid,
+                    name: name.to_string(),
+                    cpu_percent,
+                    memory_mb: 100.0,
+                })
+                .collect(),
+        }
+    }
+
+    #[test]
+    fn test_slot_round_trip() {
+        let mut slot = Slot { timestamp: 120, ..Slot::default() };
+        slot.fold(&sample(120, 50.0, &[(1, "a-very-long-process-name", 40.0), (2, "b", 10.0)]));
+        let mut bytes = vec![0u8; SLOT_SIZE];
+        slot.encode(&mut bytes);
+        let point = Slot::decode(&bytes).point();
+        assert_eq!((point.timestamp, point.samples, point.cpu_percent), (120, 1, 50.0));
+        assert_eq!(point.top.len(), 2);
+        assert_eq!(point.top[0].name, "a-very-long-proc");
+    }
+
+    #[test]
+    fn test_records_and_queries_each_resolution() {
+        let dir = tempfile::tempdir().unwrap();
+        let base = 1_700_000_000 - 1_700_000_000 % 3600;
+        {
+            let mut store = HistoryStore::open(dir.path()).unwrap();
+            // Two minutes of 2 s ticks: make is heavy in the first, idle in the second
+            for t in (0..120).step_by(2) {
+                let top: &[(u32, &str, f64)] =
+                    if t < 60 { &[(42, "make", 90.0), (7, "bash", 1.0)] } else { &[(7, "bash", 1.0)] };
+                store.record(&sample(base + t, if t < 60 { 95.0 } else { 5.0 }, top));
+            }
+        }
+
+        // Reopened from disk
+        let store = HistoryStore::open(dir.path()).unwrap();
+        let now = base + 120;
+        let seconds = store.query(RESOLUTIONS[0], base, now, now);
+        assert_eq!(seconds.len(), 60);
+        let minutes = store.query(RESOLUTIONS[1], base, now, now);
+        assert_eq!(minutes.len(), 2);
+        assert_eq!((minutes[0].samples, minutes[0].cpu_percent), (30, 95.0));
+        assert_eq!(minutes[0].top[0].name, "make");
+        assert_eq!(minutes[1].cpu_percent, 5.0);
+        let hours = store.query(RESOLUTIONS[2], base, now, now);
+        assert_eq!(hours.len(), 1);
+        // make ran 90% for half the hour's samples
+        assert_eq!(hours[0].top[0].cpu_percent, 45.0);
+
+        let make = process_points(&minutes, None, Some("make"));
+        assert_eq!(make.len(), 1);
+        assert_eq!((make[0].pid, make[0].cpu_percent), (42, 90.0));
+        assert_eq!(process_points(&minutes, Some(7), None).len(), 2);
+    }
+
+    #[test]
+    fn test_wrapped_slots_are_stale() {
+        let dir = tempfile::tempdir().unwrap();
+        let mut store = HistoryStore::open(dir.path()).unwrap();
+        store.record(&sample(1000, 10.0, &[]));
+        // Same 1 s slot one lap later
+        store.record(&sample(1000 + 3600, 20.0, &[]));
+        let now = 1000 + 3600;
+        let points = store.query(RESOLUTIONS[0], 0, now, now);
+        assert_eq!(points.len(), 1);
+        assert_eq!(points[0].cpu_percent, 20.0);
+    }
+
+    #[test]
+    fn test_resolution_for() {
+        let now = 100_000;
+        assert_eq!(HistoryStore::resolution_for(None, now - 600, now).unwrap().name, "1s");
+        assert_eq!(HistoryStore::resolution_for(None, now - 7200, now).unwrap().name, "1m");
+        assert_eq!(HistoryStore::resolution_for(None, 0, now).unwrap().name, "1h");
+        assert_eq!(HistoryStore::resolution_for(Some("1m"), 0, now).unwrap().secs, 60);
+        assert!(HistoryStore::resolution_for(Some("5m"), 0, now).is_none());
+    }
+}
@@ -3,7 +3,14 @@ pub mod config;
 pub mod db;
 pub mod detector;
 pub mod executor;
+pub mod history;
 pub mod learner;
+pub mod metrics;
 pub mod notifier;
+pub mod pidfile;
+pub mod pressure;
 pub mod protocol;
+pub mod scheduler;
 pub mod socket;
+pub mod whitelist;
+pub mod writer;
@@ -1,89 +1,272 @@
 use anyhow::Result;
 use runaway_daemon::{
-    collector::{ProcessCollector, LinuxProcessCollector},
-    config::Config,
+    collector::{
+        CgroupCollector, DetailsCollector, LinuxProcessCollector, ProcessSnapshot, Scan, SystemCollector,
+        SystemHistory, TopProcess, TOP_PROCESSES,
+    },
+    config::{Config, MonitorMode},
     db::Database,
-    detector::{Alert, AlertReason, AnomalyDetector, Detector, Severity},
+    detector::{Alert, AnomalyDetector, Detector, Severity},
+    history::{self, HistoryStore},
+    metrics::{Metrics, Phase},
     notifier::Notifier,
+    pidfile::PidFile,
+    pressure::PressureMonitor,
     protocol::{
-        AlertData, ConfigData, CpuHighConfig, GeneralConfig, HangConfig, MemoryLeakConfig,
-        Request, Response, StatusData,
+        AlertData, AlertsBatchData, ConfigData, CpuHighConfig, GeneralConfig, HangConfig,
+        MemoryLeakConfig, Request, Response, RetentionConfig, SamplingMode, StatusData,
     },
+    scheduler::{SamplingScheduler, Tier},
     socket::{handle_client, RequestHandler, SocketServer},
+    whitelist::WhitelistMatcher,
+    writer::AlertWriter,
 };
-use std::sync::Arc;
-use std::time::Duration;
-use tokio::sync::{broadcast, Mutex, RwLock};
+use std::path::Path;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex as StdMutex, RwLock as StdRwLock};
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+use tokio::sync::{broadcast, Mutex, Notify, RwLock};
 use tracing::{error, info, warn};
 
+/// Free pages returned to the filesystem per retention run
+const RETENTION_VACUUM_PAGES: u32 = 2048;
+
+/// An unchanged status is re-sent this often so clients can tell the daemon is alive
+const STATUS_HEARTBEAT: Duration = Duration::from_secs(60);
+
+/// Every process is read on every tick for this long after a PSI trigger
+const STALL_FAST_SAMPLING: Duration = Duration::from_secs(10);
+
+/// A stall lasting longer than this is treated as the steady state: tiered
+/// sampling resumes until pressure has calmed down once
+const STALL_MODE_MAX: Duration = Duration::from_secs(60);
+
+/// Pressure shares in the status frame are rounded to this many percent
+const PRESSURE_STEP_PERCENT: f64 = 10.0;
+
+/// Without triggers (no write access to /proc/pressure), a 10 s average
+/// stall share above this percentage counts as stalling
+const STALL_AVG10_PERCENT: f64 = 10.0;
+
+/// Status counters, kept up to date as alerts arrive and ticks complete.
+/// Only broadcast when they differ from what clients last saw.
+struct StatusTracker {
+    current: StatusData,
+    last_sent: Option<StatusData>,
+    last_sent_at: Instant,
+}
+
 struct DaemonState {
     collector: LinuxProcessCollector,
+    /// Present when `monitor_mode` includes cgroups and cgroup v2 is mounted
+    cgroup_collector: Option<CgroupCollector>,
+    /// False in cgroup-only mode, where /proc is not scanned at all
+    scan_processes: bool,
+    /// Latest scan published by the monitoring loop; requests read this
+    /// instead of scanning, which would also shorten the CPU sampling window
+    snapshot: StdRwLock<Arc<ProcessSnapshot>>,
+    /// System CPU/memory/load, one sample per tick, for `get_system_stats`
+    system_collector: SystemCollector,
+    system_history: StdMutex<SystemHistory>,
+    /// Round-robin files of system totals and top processes, for
+    /// `query_history`; None if they could not be opened
+    history: Option<StdMutex<HistoryStore>>,
+    /// fd/thread counts, I/O and cgroup of one process, for `process_details`
+    details_collector: DetailsCollector,
     detector: Mutex<AnomalyDetector>,
+    /// Read connection for client queries; alert inserts go through `writer`
     db: Mutex<Database>,
+    writer: AlertWriter,
     notifier: Notifier,
     config: RwLock<Config>,
     broadcast_tx: broadcast::Sender<String>,
-    alert_count: Mutex<u32>,
+    status: Mutex<StatusTracker>,
+    paused: AtomicBool,
+    retention_trigger: Notify,
+    /// Set when the whitelist or thresholds change so the monitoring loop
+    /// re-reads every process and re-tiers it
+    reschedule: AtomicBool,
+    /// None on kernels without PSI
+    pressure: Option<Arc<PressureMonitor>>,
+    /// Woken by PSI triggers so the loop samples without waiting for its tick
+    stall_wake: Arc<Notify>,
+    /// Per-phase tick timings and the daemon's own CPU/RSS, for `get_metrics`
+    metrics: Arc<Metrics>,
 }
 
 impl DaemonState {
-    fn new(config: Config, db: Database, broadcast_tx: broadcast::Sender<String>) -> Self {
+    fn new(
+        config: Config,
+        db: Database,
+        writer: AlertWriter,
+        metrics: Arc<Metrics>,
+        broadcast_tx: broadcast::Sender<String>,
+    ) -> Self {
+        let mode = config.general.monitor_mode;
+        let cgroup_collector = match mode {
+            MonitorMode::Process => None,
+            MonitorMode::Cgroup | MonitorMode::Both => CgroupCollector::new()
+                .map_err(|e| warn!("cgroup monitoring unavailable ({}), monitoring processes", e))
+                .ok(),
+        };
+        // Fall back to processes rather than monitor nothing
+        let scan_processes = mode != MonitorMode::Cgroup || cgroup_collector.is_none();
+
+        let stall_wake = Arc::new(Notify::new());
+        let wake = Arc::clone(&stall_wake);
+        let pressure = match PressureMonitor::start(Path::new("/proc/pressure"), move |_| wake.notify_one()) {
+            Ok(monitor) => {
+                info!("Watching PSI with {} stall triggers", monitor.trigger_count());
+                Some(monitor)
+            }
+            Err(e) => {
+                info!("PSI unavailable ({}), sampling on the timer only", e);
+                None
+            }
+        };
+
+        let history_dir = HistoryStore::default_dir();
+        let history = match HistoryStore::open(&history_dir) {
+            Ok(store) => Some(StdMutex::new(store)),
+            Err(e) => {
+                warn!("History disabled, cannot open {}: {}", history_dir.display(), e);
+                None
+            }
+        };
+
+        let collector = LinuxProcessCollector::new();
+        collector.set_workers(config.general.collector_workers);
+        if scan_processes && config.general.proc_events {
+            collector.enable_proc_connector();
+        }
         Self {
-            collector: LinuxProcessCollector::new(),
+            collector,
+            cgroup_collector,
+            scan_processes,
+            snapshot: StdRwLock::new(Arc::new(ProcessSnapshot::empty())),
+            system_collector: SystemCollector::new(),
+            system_history: StdMutex::new(SystemHistory::new()),
+            history,
+            details_collector: DetailsCollector::new(),
             detector: Mutex::new(AnomalyDetector::new(config.detection.clone())),
             db: Mutex::new(db),
+            writer,
             notifier: Notifier::new(),
             config: RwLock::new(config),
             broadcast_tx,
-            alert_count: Mutex::new(0),
+            status: Mutex::new(StatusTracker {
+                current: StatusData::default(),
+                last_sent: None,
+                last_sent_at: Instant::now(),
+            }),
+            paused: AtomicBool::new(false),
+            retention_trigger: Notify::new(),
+            reschedule: AtomicBool::new(false),
+            pressure,
+            stall_wake,
+            metrics,
         }
     }
 
-    async fn handle_alert(&self, alert: Alert) {
-        let reason_str = match alert.reason {
-            AlertReason::CpuHigh => "cpu_high",
-            AlertReason::Hang => "hang",
-            AlertReason::MemoryLeak => "memory_leak",
-            AlertReason::Timeout => "timeout",
-        };
-        let severity_str = match alert.severity {
-            Severity::Warning => "warning",
-            Severity::Critical => "critical",
-        };
+    fn snapshot(&self) -> Arc<ProcessSnapshot> {
+        Arc::clone(&self.snapshot.read().unwrap())
+    }
 
-        // Save to database
-        {
-            let db = self.db.lock().await;
-            if let Err(e) = db.insert_alert(
-                alert.pid,
-                &alert.name,
-                &alert.cmdline,
-                reason_str,
-                severity_str,
-            ) {
-                error!("Failed to save alert: {}", e);
-            }
+    /// Replace the shared snapshot with a completed scan, numbering and
+    /// timestamping it, and return it.
+    fn publish_snapshot(&self, mut snapshot: ProcessSnapshot) -> Arc<ProcessSnapshot> {
+        let mut current = self.snapshot.write().unwrap();
+        snapshot.seq = current.seq + 1;
+        snapshot.taken_at = Instant::now();
+        let snapshot = Arc::new(snapshot);
+        *current = Arc::clone(&snapshot);
+        snapshot
+    }
+
+    /// Recompile the whitelist from the database and swap it into the
+    /// detector. The detector lock is only held for the swap.
+    async fn reload_whitelist(&self) -> rusqlite::Result<()> {
+        let entries = self.db.lock().await.get_whitelist()?;
+        let matcher = WhitelistMatcher::build(
+            entries.iter().map(|e| (e.pattern.as_str(), e.match_type.as_str())),
+        );
+        self.detector.lock().await.set_whitelist(matcher);
+        self.reschedule.store(true, Ordering::Relaxed);
+        Ok(())
+    }
+
+    /// Persist, notify and broadcast all alerts raised during one tick.
+    ///
+    /// A fork bomb can raise hundreds of alerts at once, so they are coalesced
+    /// into a single digest notification and a single `alerts_batch` frame.
+    async fn handle_alerts(&self, alerts: Vec<Alert>) {
+        if alerts.is_empty() {
+            return;
         }
 
-        // Send desktop notification
-        let title = format!("RunawayGuard: {} ({})", alert.name, severity_str);
-        let body = format!("PID {} - {}", alert.pid, reason_str);
-        self.notifier.send(&title, &body);
+        // Queue for the writer thread; the tick's alerts commit as one transaction
+        let queued = self.writer.submit(alerts.clone());
+
+        // Send one desktop notification for the whole tick ("popup" leaves it to the GUI)
+        let notification_method = self.config.read().await.general.notification_method.clone();
+        if notification_method != "popup" {
+            self.notifier.send_digest(&alerts);
+        }
+
+        // Update unacknowledged counters, which mirror the database: a batch
+        // dropped on a full queue is still notified but never stored
+        if queued {
+            let mut status = self.status.lock().await;
+            for alert in &alerts {
+                match alert.severity {
+                    Severity::Warning => status.current.warning_count += 1,
+                    Severity::Critical => status.current.critical_count += 1,
+                }
+            }
+            status.current.alert_count =
+                status.current.warning_count + status.current.critical_count;
+        }
 
         // Broadcast to connected clients
-        let alert_data = AlertData {
-            pid: alert.pid,
-            name: alert.name,
-            reason: reason_str.to_string(),
-            severity: severity_str.to_string(),
+        let batch = Response::AlertsBatch {
+            data: AlertsBatchData {
+                alerts: alerts
+                    .into_iter()
+                    .map(|alert| AlertData {
+                        pid: alert.pid,
+                        name: alert.name,
+                        reason: alert.reason.as_str().to_string(),
+                        severity: alert.severity.as_str().to_string(),
+                    })
+                    .collect(),
+            },
         };
-        let alert_response = Response::Alert { data: alert_data };
-        if let Ok(json) = serde_json::to_string(&alert_response) {
+        if let Ok(json) = serde_json::to_string(&batch) {
             let _ = self.broadcast_tx.send(json);
         }
+    }
 
-        // Update alert count
-        *self.alert_count.lock().await += 1;
+    /// Broadcast the status frame if a counter changed, or as a heartbeat.
+    async fn publish_status(&self) {
+        let mut status = self.status.lock().await;
+        let changed = status.last_sent.as_ref() != Some(&status.current);
+        if !changed && status.last_sent_at.elapsed() < STATUS_HEARTBEAT {
+            return;
+        }
+        let frame = Response::Status {
+            data: status.current.clone(),
+        };
+        if let Ok(json) = serde_json::to_string(&frame) {
+            let _ = self.broadcast_tx.send(json);
+        }
+        status.last_sent = Some(status.current.clone());
+        status.last_sent_at = Instant::now();
+    }
+
+    async fn set_paused(&self, paused: bool) {
+        self.paused.store(paused, Ordering::Relaxed);
+        self.status.lock().await.current.paused = paused;
+        self.publish_status().await;
     }
 }
 
@@ -94,10 +277,12 @@ impl RequestHandler for DaemonState {
             Request::Ping => Response::Pong,
 
             Request::ListProcesses => {
-                let processes = self.collector.list_processes();
-                let data: Vec<_> = processes
+                let snapshot = self.snapshot();
+                let processes: Vec<_> = snapshot
+                    .processes
                     .iter()
-                    .map(|p| {
+                    .zip(&snapshot.leak_rates)
+                    .map(|(p, leak_rate)| {
                         serde_json::json!({
                             "pid": p.pid,
                             "name": p.name,
@@ -106,19 +291,50 @@ impl RequestHandler for DaemonState {
                             "memory_mb": p.memory_mb,
                             "runtime_seconds": p.runtime_seconds,
                             "state": p.state.to_string(),
+                            "leak_rate_mb_per_min": leak_rate,
                         })
                     })
                     .collect();
-                Response::Response {
-                    id: None,
-                    data: serde_json::json!(data),
+                let mut data = serde_json::json!({
+                    "seq": snapshot.seq,
+                    "age_ms": snapshot.taken_at.elapsed().as_millis() as u64,
+                    "processes": processes,
+                });
+                if self.cgroup_collector.is_some() {
+                    let cgroups: Vec<_> = snapshot
+                        .cgroups
+                        .iter()
+                        .zip(&snapshot.cgroup_leak_rates)
+                        .map(|(c, leak_rate)| {
+                            serde_json::json!({
+                                "path": c.path,
+                                "cpu_percent": c.cpu_percent,
+                                "memory_mb": c.memory_mb,
+                                "memory_high_events": c.memory_events.high,
+                                "memory_max_events": c.memory_events.max,
+                                "oom_kills": c.memory_events.oom_kill,
+                                "pids": c.pids,
+                                "leaf": c.leaf,
+                                "leak_rate_mb_per_min": leak_rate,
+                            })
+                        })
+                        .collect();
+                    data["cgroups"] = serde_json::json!(cgroups);
                 }
+                Response::Response { id: None, data }
             }
 
             Request::GetAlerts { params } => {
                 let limit = params.limit.unwrap_or(50);
                 let db = self.db.lock().await;
-                match db.get_alerts(limit, None) {
+                let paged =
+                    params.from.is_some() || params.to.is_some() || params.before_id.is_some();
+                let result = if paged {
+                    db.get_alerts_page(limit, params.from, params.to, params.before_id)
+                } else {
+                    db.get_alerts(limit, None)
+                };
+                match result {
                     Ok(alerts) => {
                         let data: Vec<_> = alerts
                             .iter()
@@ -127,6 +343,7 @@ impl RequestHandler for DaemonState {
                                     "id": a.id,
                                     "pid": a.pid,
                                     "name": a.name,
+                                    "cmdline": a.cmdline,
                                     "reason": a.reason,
                                     "severity": a.severity,
                                     "timestamp": a.timestamp,
@@ -146,6 +363,14 @@ impl RequestHandler for DaemonState {
             }
 
             Request::KillProcess { params } => {
+                // kill(0) would signal the daemon's own process group; cgroup
+                // alerts carry pid 0
+                if params.pid == 0 {
+                    return Response::Response {
+                        id: None,
+                        data: serde_json::json!({"error": "Invalid pid"}),
+                    };
+                }
                 let signal = match params.signal.to_uppercase().as_str() {
                     "SIGTERM" | "TERM" | "15" => libc::SIGTERM,
                     "SIGKILL" | "KILL" | "9" => libc::SIGKILL,
@@ -200,10 +425,14 @@ impl RequestHandler for DaemonState {
             }
 
             Request::AddWhitelist { params } => {
-                let mut detector = self.detector.lock().await;
-                detector.add_whitelist(params.pattern.clone());
-                let db = self.db.lock().await;
-                match db.add_whitelist(&params.pattern, &params.match_type, None) {
+                if let Err(e) = WhitelistMatcher::validate(&params.pattern, &params.match_type) {
+                    return Response::Response {
+                        id: None,
+                        data: serde_json::json!({"error": format!("Invalid whitelist pattern: {}", e)}),
+                    };
+                }
+                let added = self.db.lock().await.add_whitelist(&params.pattern, &params.match_type, None);
+                match added.and(self.reload_whitelist().await) {
                     Ok(_) => Response::Response {
                         id: None,
                         data: serde_json::json!({"success": true}),
@@ -216,15 +445,12 @@ impl RequestHandler for DaemonState {
             }
 
             Request::RemoveWhitelist { params } => {
-                let db = self.db.lock().await;
-                match db.remove_whitelist(params.id) {
-                    Ok(_) => {
-                        // Also remove from detector (would need pattern lookup in real impl)
-                        Response::Response {
-                            id: None,
-                            data: serde_json::json!({"success": true}),
-                        }
-                    }
+                let removed = self.db.lock().await.remove_whitelist(params.id);
+                match removed.and(self.reload_whitelist().await) {
+                    Ok(_) => Response::Response {
+                        id: None,
+                        data: serde_json::json!({"success": true}),
+                    },
                     Err(e) => Response::Response {
                         id: None,
                         data: serde_json::json!({"error": e.to_string()}),
@@ -232,43 +458,43 @@ impl RequestHandler for DaemonState {
                 }
             }
 
-            Request::UpdateConfig { params: _ } => {
-                // TODO: Implement config update
-                Response::Response {
-                    id: None,
-                    data: serde_json::json!({"error": "Not implemented"}),
+            Request::UpdateConfig { params } => {
+                let data: ConfigData = match serde_json::from_value(params) {
+                    Ok(data) => data,
+                    Err(e) => {
+                        return Response::Response {
+                            id: None,
+                            data: serde_json::json!({"error": e.to_string()}),
+                        }
+                    }
+                };
+                let mut config = self.config.write().await;
+                apply_config_data(&mut config, data);
+                self.detector.lock().await.set_config(config.detection.clone());
+                self.collector.set_workers(config.general.collector_workers);
+                self.reschedule.store(true, Ordering::Relaxed);
+                match config.save(&Config::config_path()) {
+                    Ok(_) => Response::Response {
+                        id: None,
+                        data: serde_json::json!({"success": true}),
+                    },
+                    Err(e) => Response::Response {
+                        id: None,
+                        data: serde_json::json!({"error": e.to_string()}),
+                    },
                 }
             }
 
             Request::GetConfig => {
-                // TODO: Return actual config from daemon state
+                let config = self.config.read().await;
                 Response::Config {
-                    data: ConfigData {
-                        cpu_high: CpuHighConfig {
-                            enabled: true,
-                            threshold_percent: 90,
-                            duration_seconds: 60,
-                        },
-                        hang: HangConfig {
-                            enabled: true,
-                            duration_seconds: 300,
-                        },
-                        memory_leak: MemoryLeakConfig {
-                            enabled: true,
-                            growth_threshold_mb: 500,
-                            window_minutes: 30,
-                        },
-                        general: GeneralConfig {
-                            sample_interval_normal: 10,
-                            sample_interval_alert: 2,
-                            notification_method: "dbus".to_string(),
-                        },
-                    },
+                    data: config_data(&config),
                 }
             }
 
             Request::PauseMonitoring => {
-                // TODO: Implement pause monitoring
+                self.set_paused(true).await;
+                info!("Monitoring paused");
                 Response::Response {
                     id: None,
                     data: serde_json::json!({"success": true, "message": "Monitoring paused"}),
@@ -276,7 +502,8 @@ impl RequestHandler for DaemonState {
             }
 
             Request::ResumeMonitoring => {
-                // TODO: Implement resume monitoring
+                self.set_paused(false).await;
+                info!("Monitoring resumed");
                 Response::Response {
                     id: None,
                     data: serde_json::json!({"success": true, "message": "Monitoring resumed"}),
@@ -284,68 +511,510 @@ impl RequestHandler for DaemonState {
             }
 
             Request::ClearAlerts => {
-                // TODO: Implement clear alerts from database
+                // Alerts are acknowledged rather than deleted so history survives.
+                // On the writer, so alerts still queued are cleared too
+                let result = self.writer.resolve_all().await;
+                match result {
+                    Ok(cleared) => {
+                        {
+                            let mut status = self.status.lock().await;
+                            status.current.alert_count = 0;
+                            status.current.warning_count = 0;
+                            status.current.critical_count = 0;
+                        }
+                        self.publish_status().await;
+                        Response::Response {
+                            id: None,
+                            data: serde_json::json!({
+                                "success": true,
+                                "message": "Alerts cleared",
+                                "cleared": cleared,
+                            }),
+                        }
+                    }
+                    Err(e) => Response::Response {
+                        id: None,
+                        data: serde_json::json!({"error": e.to_string()}),
+                    },
+                }
+            }
+
+            Request::GetStatus => Response::Status {
+                data: self.status.lock().await.current.clone(),
+            },
+
+            Request::GetProcessEvents { params } => {
+                let limit = params.limit.unwrap_or(200).min(1000) as usize;
+                let (events, next_seq) =
+                    self.collector.process_events(params.since.unwrap_or(0), limit);
                 Response::Response {
                     id: None,
-                    data: serde_json::json!({"success": true, "message": "Alerts cleared"}),
+                    data: serde_json::json!({
+                        "source": self.collector.event_source(),
+                        "next_seq": next_seq,
+                        "events": events,
+                    }),
+                }
+            }
+
+            Request::GetSystemStats { params } => {
+                let limit = params.limit.map_or(usize::MAX, |limit| limit as usize);
+                let (samples, next_seq) =
+                    self.system_history.lock().unwrap().since(params.since.unwrap_or(0), limit);
+                Response::Response {
+                    id: None,
+                    data: serde_json::json!({
+                        "next_seq": next_seq,
+                        "samples": samples,
+                    }),
+                }
+            }
+
+            Request::QueryHistory { params } => {
+                let Some(history) = &self.history else {
+                    return Response::Response {
+                        id: None,
+                        data: serde_json::json!({"error": "History is not available"}),
+                    };
+                };
+                let now = SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0);
+                let to = params.to.map_or(now, |to| to.max(0) as u64);
+                let from = params.from.map_or(now.saturating_sub(3600), |from| from.max(0) as u64);
+                let Some(resolution) =
+                    HistoryStore::resolution_for(params.resolution.as_deref(), from, now)
+                else {
+                    return Response::Response {
+                        id: None,
+                        data: serde_json::json!({
+                            "error": format!("Unknown resolution: {}", params.resolution.unwrap_or_default())
+                        }),
+                    };
+                };
+                let points = history.lock().unwrap().query(resolution, from, to, now);
+                let points = if params.pid.is_some() || params.name.is_some() {
+                    serde_json::to_value(history::process_points(&points, params.pid, params.name.as_deref()))
+                } else {
+                    serde_json::to_value(points)
+                };
+                Response::Response {
+                    id: None,
+                    data: serde_json::json!({
+                        "resolution": resolution.secs,
+                        "points": points.unwrap_or_default(),
+                    }),
+                }
+            }
+
+            Request::ProcessDetails { params } => {
+                // Keyed by the scanned process so a recycled PID gets fresh I/O rates
+                let snapshot = self.snapshot();
+                let found = snapshot
+                    .processes
+                    .iter()
+                    .zip(&snapshot.leak_rates)
+                    .find(|(p, _)| p.pid == params.pid)
+                    .and_then(|(p, leak_rate)| Some((p, leak_rate, self.details_collector.details(p.key())?)));
+                let Some((process, leak_rate, details)) = found else {
+                    // "details" is still present so clients can tell the panel its process exited
+                    return Response::Response {
+                        id: None,
+                        data: serde_json::json!({
+                            "details": null,
+                            "pid": params.pid,
+                            "error": format!("Process {} not found", params.pid),
+                        }),
+                    };
+                };
+                let history = self.detector.lock().await.recent_samples(&process.key());
+                let mut data = serde_json::to_value(details).unwrap_or_default();
+                if let Some(fields) = data.as_object_mut() {
+                    fields.insert("pid".into(), process.pid.into());
+                    fields.insert("name".into(), process.name.clone().into());
+                    fields.insert("state".into(), process.state.to_string().into());
+                    fields.insert("cpu_percent".into(), process.cpu_percent.into());
+                    fields.insert("memory_mb".into(), process.memory_mb.into());
+                    fields.insert("runtime_seconds".into(), process.runtime_seconds.into());
+                    fields.insert("leak_rate_mb_per_min".into(), serde_json::json!(leak_rate));
+                    fields.insert("history".into(), serde_json::json!(history));
+                }
+                Response::Response {
+                    id: None,
+                    data: serde_json::json!({"details": data}),
+                }
+            }
+
+            Request::GetDbStats => {
+                let db = self.db.lock().await;
+                match db.stats() {
+                    Ok(stats) => Response::Response {
+                        id: None,
+                        data: serde_json::json!({
+                            "db_size_bytes": stats.size_bytes,
+                            "db_free_bytes": stats.free_bytes,
+                            "alert_count": stats.alert_count,
+                            "rollup_count": stats.rollup_count,
+                            "sample_count": stats.sample_count,
+                        }),
+                    },
+                    Err(e) => Response::Response {
+                        id: None,
+                        data: serde_json::json!({"error": e.to_string()}),
+                    },
+                }
+            }
+
+            Request::GetMetrics => match serde_json::to_value(self.metrics.report()) {
+                Ok(data) => Response::Response { id: None, data },
+                Err(e) => Response::Response {
+                    id: None,
+                    data: serde_json::json!({"error": e.to_string()}),
+                },
+            },
+
+            Request::CompactDatabase => {
+                // Runs on the retention task, not on this client's connection.
+                // Frees pages even with retention disabled; expired alerts
+                // are only rolled up when it is enabled
+                self.retention_trigger.notify_one();
+                Response::Response {
+                    id: None,
+                    data: serde_json::json!({"success": true, "message": "Compaction started"}),
                 }
             }
         }
     }
 }
 
-async fn monitoring_loop(state: Arc<DaemonState>) {
-    let mut interval = tokio::time::interval(Duration::from_secs(10));
-    let mut in_alert_mode = false;
+fn config_data(config: &Config) -> ConfigData {
+    let detection = &config.detection;
+    ConfigData {
+        cpu_high: CpuHighConfig {
+            enabled: detection.cpu.enabled,
+            threshold_percent: detection.cpu.threshold_percent as u32,
+            duration_seconds: detection.cpu.duration_seconds as u32,
+        },
+        hang: HangConfig {
+            enabled: detection.hang.enabled,
+            duration_seconds: detection.hang.duration_seconds as u32,
+        },
+        memory_leak: MemoryLeakConfig {
+            enabled: detection.memory.enabled,
+            growth_threshold_mb: detection.memory.growth_mb as u32,
+            window_minutes: detection.memory.window_minutes as u32,
+        },
+        general: GeneralConfig {
+            sample_interval_normal: config.general.sample_interval_normal as u32,
+            sample_interval_alert: config.general.sample_interval_alert as u32,
+            notification_method: config.general.notification_method.clone(),
+            collector_workers: config.general.collector_workers as u32,
+        },
+        retention: RetentionConfig {
+            enabled: config.retention.enabled,
+            raw_alert_days: config.retention.raw_alert_days as u32,
+            rollup_days: config.retention.rollup_days as u32,
+        },
+    }
+}
+
+fn apply_config_data(config: &mut Config, data: ConfigData) {
+    let detection = &mut config.detection;
+    detection.cpu.enabled = data.cpu_high.enabled;
+    detection.cpu.threshold_percent = data.cpu_high.threshold_percent.min(100) as u8;
+    detection.cpu.duration_seconds = data.cpu_high.duration_seconds as u64;
+    detection.hang.enabled = data.hang.enabled;
+    detection.hang.duration_seconds = data.hang.duration_seconds as u64;
+    detection.memory.enabled = data.memory_leak.enabled;
+    detection.memory.growth_mb = data.memory_leak.growth_threshold_mb as u64;
+    detection.memory.window_minutes = data.memory_leak.window_minutes as u64;
+    config.general.sample_interval_normal = data.general.sample_interval_normal.max(1) as u64;
+    config.general.sample_interval_alert = data.general.sample_interval_alert.max(1) as u64;
+    config.general.notification_method = data.general.notification_method;
+    config.general.collector_workers = data.general.collector_workers as usize;
+    config.retention.enabled = data.retention.enabled;
+    config.retention.raw_alert_days = data.retention.raw_alert_days.max(1) as u64;
+    config.retention.rollup_days = data.retention.rollup_days as u64;
+}
 
+/// Periodically roll up and delete expired alerts, off the monitoring path.
+/// Also runs on demand when a client sends `compact_database`.
+async fn retention_loop(state: Arc<DaemonState>) {
+    let mut vacuum_checked = false;
     loop {
-        interval.tick().await;
+        let interval_minutes = state.config.read().await.retention.interval_minutes.max(1);
+        let compact = tokio::select! {
+            _ = tokio::time::sleep(Duration::from_secs(interval_minutes * 60)) => false,
+            _ = state.retention_trigger.notified() => true,
+        };
 
-        let processes = state.collector.list_processes();
-        let mut detector = state.detector.lock().await;
-        let mut had_alert = false;
+        if !vacuum_checked {
+            vacuum_checked = true;
+            // The one-time VACUUM can take minutes on a large database. It
+            // runs on the writer thread so alert inserts queue behind it
+            // instead of failing on its lock; client queries keep using
+            // `state.db` (WAL lets them read alongside it)
+            match state.writer.ensure_incremental_vacuum().await {
+                Ok(true) => info!("Database converted to incremental auto-vacuum"),
+                Ok(false) => {}
+                Err(e) => warn!("Failed to enable incremental vacuum: {}", e),
+            }
+        }
+        run_retention(&state, compact).await;
+    }
+}
 
-        for process in &processes {
-            if let Some(alert) = detector.check(process) {
-                had_alert = true;
-                drop(detector); // Release lock before async operation
-                state.handle_alert(alert).await;
-                detector = state.detector.lock().await;
+/// Apply the retention policy if it is enabled and return free pages to the
+/// filesystem. `compact` (an explicit `compact_database`) frees every free
+/// page, whether or not retention is enabled.
+async fn run_retention(state: &DaemonState, compact: bool) {
+    let retention = state.config.read().await.retention.clone();
+    if retention.enabled {
+        roll_up_expired(state, &retention).await;
+    }
+    if retention.enabled || compact {
+        // 0 frees them all
+        let pages = if compact { 0 } else { RETENTION_VACUUM_PAGES };
+        if let Err(e) = state.db.lock().await.incremental_vacuum(pages) {
+            warn!("Incremental vacuum failed: {}", e);
+        }
+    }
+}
+
+async fn roll_up_expired(state: &DaemonState, retention: &runaway_daemon::config::RetentionConfig) {
+    let now = SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs() as i64).unwrap_or(0);
+    let cutoff = now - (retention.raw_alert_days as i64 * 86400);
+    let mut rolled_up = 0;
+    loop {
+        // Lock per batch so monitoring and client queries interleave with the cleanup
+        let result = {
+            let db = state.db.lock().await;
+            db.rollup_expired_alerts(cutoff, retention.batch_size.max(1))
+        };
+        match result {
+            Ok(batch) if batch.deleted == 0 => break,
+            Ok(batch) => {
+                rolled_up += batch.deleted;
+                let (warning, critical) = batch.unresolved;
+                if warning + critical > 0 {
+                    let mut status = state.status.lock().await;
+                    status.current.warning_count = status.current.warning_count.saturating_sub(warning);
+                    status.current.critical_count = status.current.critical_count.saturating_sub(critical);
+                    status.current.alert_count =
+                        status.current.warning_count + status.current.critical_count;
+                }
+            }
+            Err(e) => {
+                error!("Alert rollup failed: {}", e);
+                return;
             }
         }
+        tokio::time::sleep(Duration::from_millis(20)).await;
+    }
 
-        // Cleanup stale process history
-        let pids: Vec<u32> = processes.iter().map(|p| p.pid).collect();
-        detector.cleanup(&pids);
-        drop(detector);
+    if retention.rollup_days > 0 {
+        let rollup_cutoff = now - (retention.rollup_days as i64 * 86400);
+        if let Err(e) = state.db.lock().await.delete_rollups_before(rollup_cutoff) {
+            error!("Failed to delete old alert rollups: {}", e);
+        }
+    }
+    if rolled_up > 0 {
+        info!("Rolled up {} expired alerts", rolled_up);
+        state.publish_status().await;
+    }
+}
 
-        // Adaptive interval: faster during alerts
+async fn monitoring_loop(state: Arc<DaemonState>) {
+    // The loop runs at the alert rate; the scheduler decides which
+    // processes are actually read on each tick
+    let (mut tick_secs, normal_secs) = {
         let config = state.config.read().await;
-        if had_alert && !in_alert_mode {
-            in_alert_mode = true;
-            interval = tokio::time::interval(Duration::from_secs(
-                config.general.sample_interval_alert,
-            ));
-            info!("Entering alert mode - increased sampling rate");
-        } else if !had_alert && in_alert_mode {
-            in_alert_mode = false;
-            interval = tokio::time::interval(Duration::from_secs(
-                config.general.sample_interval_normal,
-            ));
-            info!("Exiting alert mode - normal sampling rate");
+        (config.general.sample_interval_alert.max(1), config.general.sample_interval_normal)
+    };
+    let mut interval = tokio::time::interval(Duration::from_secs(tick_secs));
+    let mut scheduler = SamplingScheduler::new(tick_secs, normal_secs);
+    let mut last_tick: Option<Instant> = None;
+    let mut stall_since: Option<Instant> = None;
+
+    loop {
+        // A PSI trigger starts a tick right away, but at most one early tick
+        // per interval however often the triggers fire
+        tokio::select! {
+            _ = interval.tick() => {}
+            _ = state.stall_wake.notified() => {
+                if last_tick.map_or(false, |at| at.elapsed() < Duration::from_secs(tick_secs)) {
+                    continue;
+                }
+                interval.reset();
+            }
         }
+        last_tick = Some(Instant::now());
 
-        // Broadcast status update periodically
-        let alert_count = *state.alert_count.lock().await;
-        let status = Response::Status {
-            data: StatusData {
-                monitored_count: processes.len() as u32,
-                alert_count,
-            },
+        {
+            let config = state.config.read().await;
+            let alert_secs = config.general.sample_interval_alert.max(1);
+            if alert_secs != tick_secs {
+                tick_secs = alert_secs;
+                interval = tokio::time::interval(Duration::from_secs(tick_secs));
+                interval.tick().await;
+            }
+            scheduler.set_intervals(tick_secs, config.general.sample_interval_normal);
+        }
+        // While the system is stalling every process is read every tick
+        let pressure = state.pressure.as_ref().map(|monitor| monitor.read()).unwrap_or_default();
+        let stalling = state.pressure.as_ref().map_or(false, |monitor| {
+            if monitor.trigger_count() > 0 {
+                monitor.stalled_within(STALL_FAST_SAMPLING)
+            } else {
+                pressure.max() >= STALL_AVG10_PERCENT
+            }
+        });
+        let stalled = match (stalling, stall_since) {
+            (false, _) => {
+                stall_since = None;
+                false
+            }
+            (true, None) => {
+                stall_since = Some(Instant::now());
+                true
+            }
+            (true, Some(since)) => since.elapsed() < STALL_MODE_MAX,
+        };
+        if state.reschedule.swap(false, Ordering::Relaxed) || stalled {
+            scheduler.wake_all();
+        }
+
+        let tick_start = Instant::now();
+        scheduler.begin_tick();
+        let scan = if state.scan_processes {
+            state.collector.scan(&|pid| scheduler.is_due(pid))
+        } else {
+            Scan::default()
         };
-        if let Ok(json) = serde_json::to_string(&status) {
-            let _ = state.broadcast_tx.send(json);
+        scheduler.retain_listed(&scan.pids);
+        let cgroups = match &state.cgroup_collector {
+            Some(collector) => collector.list_cgroups(),
+            None => Vec::new(),
+        };
+        let mut cgroup_leak_rates = vec![None; cgroups.len()];
+        let mut system = state.system_collector.sample();
+        state.metrics.record(Phase::Scan, tick_start.elapsed());
+
+        let detect_start = Instant::now();
+        let mut alerts = Vec::new();
+        let paused = state.paused.load(Ordering::Relaxed);
+        {
+            let mut detector = state.detector.lock().await;
+            // While paused processes are still read on schedule so CPU
+            // deltas stay fresh on resume
+            if !paused {
+                detector.begin_tick();
+            }
+            for process in scan.processes {
+                if detector.is_whitelisted(&process) {
+                    scheduler.record(process, Tier::Whitelisted, None);
+                    continue;
+                }
+                if paused {
+                    let tier = Tier::classify(&process, false, None, detector.config());
+                    scheduler.record(process, tier, None);
+                    continue;
+                }
+                let alert = detector.check(&process);
+                let leak_rate = detector.leak_rate(&process.key());
+                let tier = Tier::classify(&process, alert.is_some(), leak_rate, detector.config());
+                alerts.extend(alert);
+                scheduler.record(process, tier, leak_rate);
+            }
+            if !paused {
+                // Parents include their children, so only leaves are checked
+                for (cgroup, leak_rate) in cgroups.iter().zip(cgroup_leak_rates.iter_mut()) {
+                    if cgroup.leaf {
+                        alerts.extend(detector.check_cgroup(cgroup));
+                        *leak_rate = detector.cgroup_leak_rate(&cgroup.path);
+                    }
+                }
+                // Processes not due this tick are still alive
+                for process in scheduler.unread() {
+                    detector.touch(&process.key());
+                }
+                // Drop history of processes and cgroups that went away
+                detector.sweep();
+            }
         }
+        let cgroup_count = cgroups.iter().filter(|c| c.leaf).count() as u32;
+        // Published after detection so the snapshot carries this tick's leak rates
+        let now = SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0);
+        let (processes, leak_rates) = scheduler.snapshot(now);
+        let mut by_cpu: Vec<_> = processes.iter().collect();
+        let top = TOP_PROCESSES.min(by_cpu.len());
+        if top > 0 {
+            by_cpu.select_nth_unstable_by(top - 1, |a, b| b.cpu_percent.total_cmp(&a.cpu_percent));
+            by_cpu.truncate(top);
+            by_cpu.sort_by(|a, b| b.cpu_percent.total_cmp(&a.cpu_percent));
+        }
+        system.top = by_cpu
+            .into_iter()
+            .map(|p| TopProcess {
+                pid: p.pid,
+                name: p.name.clone(),
+                cpu_percent: p.cpu_percent,
+                memory_mb: p.memory_mb,
+            })
+            .collect();
+        if let Some(history) = &state.history {
+            history.lock().unwrap().record(&system);
+        }
+        state.system_history.lock().unwrap().push(system);
+        state.publish_snapshot(ProcessSnapshot {
+            processes,
+            leak_rates,
+            cgroups,
+            cgroup_leak_rates,
+            ..ProcessSnapshot::empty()
+        });
+        state.metrics.record(Phase::Detect, detect_start.elapsed());
+
+        let alerts_start = Instant::now();
+        state.handle_alerts(alerts).await;
+        state.metrics.record(Phase::Alerts, alerts_start.elapsed());
+
+        // Broadcast status only when a counter moved (or as a heartbeat)
+        let broadcast_start = Instant::now();
+        {
+            let counts = scheduler.counts();
+            let mut status = state.status.lock().await;
+            status.current.monitored_count = if paused {
+                0
+            } else {
+                counts.hot + counts.normal + counts.idle
+            };
+            status.current.hot_count = counts.hot;
+            status.current.normal_count = counts.normal;
+            status.current.idle_count = counts.idle;
+            status.current.whitelisted_count = counts.whitelisted;
+            status.current.cgroup_count = if paused { 0 } else { cgroup_count };
+            // Raw averages move every tick and would defeat change-only broadcasts
+            let bucket = |share: f64| ((share / PRESSURE_STEP_PERCENT).round() * PRESSURE_STEP_PERCENT) as u32;
+            status.current.cpu_pressure = bucket(pressure.cpu);
+            status.current.memory_pressure = bucket(pressure.memory);
+            status.current.io_pressure = bucket(pressure.io);
+            status.current.stalled = stalled;
+            status.current.skipped_count = state.collector.skipped_count();
+            status.current.sampling_mode = if stalled {
+                SamplingMode::Stall
+            } else if counts.hot > 0 && !paused {
+                SamplingMode::Alert
+            } else {
+                SamplingMode::Normal
+            };
+            status.current.sample_interval_secs = match status.current.sampling_mode {
+                SamplingMode::Normal => scheduler.normal_secs(),
+                SamplingMode::Alert | SamplingMode::Stall => tick_secs,
+            } as u32;
+        }
+        state.publish_status().await;
+        state.metrics.record(Phase::Broadcast, broadcast_start.elapsed());
+        state.metrics.record(Phase::Tick, tick_start.elapsed());
+        state.metrics.sample_self();
     }
 }
 
@@ -369,32 +1038,46 @@ async fn main() -> Result<()> {
     // Initialize database
     let db = Database::open_default()?;
     db.init_schema()?;
-
-    // Load whitelist from database
-    let whitelist = db.get_whitelist()?;
+    let metrics = Arc::new(Metrics::new());
+    let writer = AlertWriter::spawn_with_metrics(Database::open_default()?, Arc::clone(&metrics))?;
 
     // Create socket server
     let socket_path = SocketServer::socket_path();
     let server = SocketServer::bind(&socket_path).await?;
     let broadcast_tx = server.broadcast_sender();
+    // Written once the socket exists, so a client that finds it can connect
+    let pid_path = PidFile::default_path();
+    let _pidfile = PidFile::create(&pid_path)
+        .map_err(|e| warn!("Failed to write pidfile {}: {}", pid_path.display(), e))
+        .ok();
 
     // Create shared state
-    let state = Arc::new(DaemonState::new(config, db, broadcast_tx));
+    let state = Arc::new(DaemonState::new(config, db, writer, metrics, broadcast_tx));
 
-    // Add whitelist entries to detector
+    // Seed unacknowledged counters from alerts left over from earlier runs
     {
-        let mut detector = state.detector.lock().await;
-        for entry in whitelist {
-            detector.add_whitelist(entry.pattern);
-        }
+        let (warning, critical) = state.db.lock().await.unresolved_counts().unwrap_or((0, 0));
+        let mut status = state.status.lock().await;
+        status.current.warning_count = warning;
+        status.current.critical_count = critical;
+        status.current.alert_count = warning + critical;
     }
 
+    // Compile the stored whitelist into the detector
+    state.reload_whitelist().await?;
+
     // Start monitoring loop
     let monitor_state = Arc::clone(&state);
     tokio::spawn(async move {
         monitoring_loop(monitor_state).await;
     });
 
+    // Start alert retention task
+    let retention_state = Arc::clone(&state);
+    tokio::spawn(async move {
+        retention_loop(retention_state).await;
+    });
+
     info!("Daemon ready, listening for connections...");
 
     // Accept client connections
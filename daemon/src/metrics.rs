@@ -0,0 +1,312 @@
+//! Daemon self-monitoring
+//!
+//! Each phase of a monitoring tick is timed with `Instant` and kept in a
+//! ring of the most recent `PHASE_SAMPLES` durations, from which
+//! percentiles are computed on request. Once per tick the daemon's own CPU
+//! time (getrusage, all threads) and resident memory (/proc/self/statm) are
+//! sampled into a short history for charting.
+
+use serde::Serialize;
+use std::collections::VecDeque;
+use std::fs;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+
+/// Durations kept per phase for the percentiles
+const PHASE_SAMPLES: usize = 512;
+
+/// Self-usage samples kept for `get_metrics` history (one per tick)
+const HISTORY_SAMPLES: usize = 300;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Phase {
+    /// Reading /proc and cgroups
+    Scan,
+    /// Detector checks, tiering, sweep
+    Detect,
+    /// Queuing alerts, notifications and alert frames
+    Alerts,
+    /// Broadcasting status
+    Broadcast,
+    /// Whole tick, start of scan to end of broadcast
+    Tick,
+    /// One alert transaction on the writer thread
+    Db,
+}
+
+impl Phase {
+    pub const ALL: [Phase; 6] =
+        [Phase::Scan, Phase::Detect, Phase::Alerts, Phase::Broadcast, Phase::Tick, Phase::Db];
+
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            Phase::Scan => "scan",
+            Phase::Detect => "detect",
+            Phase::Alerts => "alerts",
+            Phase::Broadcast => "broadcast",
+            Phase::Tick => "tick",
+            Phase::Db => "db",
+        }
+    }
+}
+
+/// Percentiles over the recent samples of one phase, in milliseconds
+#[derive(Debug, Clone, Serialize, PartialEq)]
+pub struct PhaseStats {
+    pub phase: &'static str,
+    pub count: u64,
+    pub last_ms: f64,
+    pub p50_ms: f64,
+    pub p95_ms: f64,
+    pub p99_ms: f64,
+    pub max_ms: f64,
+}
+
+#[derive(Debug, Clone, Copy, Serialize, PartialEq)]
+pub struct SelfSample {
+    /// Unix seconds
+    pub timestamp: u64,
+    /// Since the previous sample; 100% = one core
+    pub cpu_percent: f64,
+    pub rss_mb: f64,
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct MetricsReport {
+    pub uptime_seconds: u64,
+    /// Average since startup; 100% = one core
+    pub cpu_percent_avg: f64,
+    pub cpu_percent: f64,
+    pub rss_mb: f64,
+    /// Alerts the writer thread could not keep up with, since startup
+    pub dropped_alerts: u64,
+    pub phases: Vec<PhaseStats>,
+    /// Oldest first
+    pub history: Vec<SelfSample>,
+}
+
+struct PhaseRing {
+    /// Microseconds
+    samples: Vec<u32>,
+    next: usize,
+    count: u64,
+    last: u32,
+}
+
+impl PhaseRing {
+    fn new() -> Self {
+        Self { samples: Vec::with_capacity(PHASE_SAMPLES), next: 0, count: 0, last: 0 }
+    }
+
+    fn push(&mut self, micros: u32) {
+        if self.samples.len() < PHASE_SAMPLES {
+            self.samples.push(micros);
+        } else {
+            self.samples[self.next] = micros;
+        }
+        self.next = (self.next + 1) % PHASE_SAMPLES;
+        self.count += 1;
+        self.last = micros;
+    }
+
+    fn stats(&self, phase: Phase) -> PhaseStats {
+        let mut sorted = self.samples.clone();
+        sorted.sort_unstable();
+        let percentile = |p: f64| -> f64 {
+            if sorted.is_empty() {
+                return 0.0;
+            }
+            // Nearest rank
+            let rank = ((p * sorted.len() as f64).ceil() as usize).clamp(1, sorted.len());
+            sorted[rank - 1] as f64 / 1000.0
+        };
+        PhaseStats {
+            phase: phase.as_str(),
+            count: self.count,
+            last_ms: self.last as f64 / 1000.0,
+            p50_ms: percentile(0.50),
+            p95_ms: percentile(0.95),
+            p99_ms: percentile(0.99),
+            max_ms: sorted.last().map_or(0.0, |&m| m as f64 / 1000.0),
+        }
+    }
+}
+
+struct Inner {
+    phases: Vec<PhaseRing>,
+    history: VecDeque<SelfSample>,
+    /// CPU time and wall clock at the previous self sample
+    last_cpu: Option<(Duration, Instant)>,
+}
+
+pub struct Metrics {
+    started: Instant,
+    page_size: u64,
+    dropped_alerts: AtomicU64,
+    inner: Mutex<Inner>,
+}
+
+impl Metrics {
+    pub fn new() -> Self {
+        Self {
+            started: Instant::now(),
+            page_size: unsafe { libc::sysconf(libc::_SC_PAGESIZE) as u64 },
+            dropped_alerts: AtomicU64::new(0),
+            inner: Mutex::new(Inner {
+                phases: Phase::ALL.iter().map(|_| PhaseRing::new()).collect(),
+                history: VecDeque::with_capacity(HISTORY_SAMPLES),
+                last_cpu: None,
+            }),
+        }
+    }
+
+    pub fn record_dropped_alerts(&self, count: usize) {
+        self.dropped_alerts.fetch_add(count as u64, Ordering::Relaxed);
+    }
+
+    pub fn record(&self, phase: Phase, elapsed: Duration) {
+        let micros = elapsed.as_micros().min(u32::MAX as u128) as u32;
+        let index = Phase::ALL.iter().position(|&p| p == phase).unwrap();
+        self.inner.lock().unwrap().phases[index].push(micros);
+    }
+
+    /// Time `f` as `phase`
+    pub fn time<T>(&self, phase: Phase, f: impl FnOnce() -> T) -> T {
+        let start = Instant::now();
+        let result = f();
+        self.record(phase, start.elapsed());
+        result
+    }
+
+    /// Record the daemon's CPU use since the previous call and its RSS
+    pub fn sample_self(&self) {
+        let cpu_time = process_cpu_time();
+        let now = Instant::now();
+        let rss_mb = self.rss_mb();
+        let mut inner = self.inner.lock().unwrap();
+        let cpu_percent = match inner.last_cpu {
+            Some((last_cpu, last_at)) => {
+                let wall = now.duration_since(last_at).as_secs_f64();
+                if wall > 0.0 {
+                    cpu_time.saturating_sub(last_cpu).as_secs_f64() / wall * 100.0
+                } else {
+                    0.0
+                }
+            }
+            None => 0.0,
+        };
+        inner.last_cpu = Some((cpu_time, now));
+        if inner.history.len() == HISTORY_SAMPLES {
+            inner.history.pop_front();
+        }
+        let timestamp = SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0);
+        inner.history.push_back(SelfSample { timestamp, cpu_percent, rss_mb });
+    }
+
+    pub fn report(&self) -> MetricsReport {
+        let uptime = self.started.elapsed();
+        let cpu_percent_avg = if uptime.as_secs_f64() > 0.0 {
+            process_cpu_time().as_secs_f64() / uptime.as_secs_f64() * 100.0
+        } else {
+            0.0
+        };
+        let inner = self.inner.lock().unwrap();
+        MetricsReport {
+            uptime_seconds: uptime.as_secs(),
+            cpu_percent_avg,
+            cpu_percent: inner.history.back().map_or(0.0, |s| s.cpu_percent),
+            rss_mb: self.rss_mb(),
+            dropped_alerts: self.dropped_alerts.load(Ordering::Relaxed),
+            phases: Phase::ALL
+                .iter()
+                .zip(&inner.phases)
+                .map(|(&phase, ring)| ring.stats(phase))
+                .collect(),
+            history: inner.history.iter().copied().collect(),
+        }
+    }
+
+    fn rss_mb(&self) -> f64 {
+        // statm: size resident shared ... in pages
+        let resident_pages: u64 = fs::read_to_string("/proc/self/statm")
+            .ok()
+            .and_then(|statm| statm.split_whitespace().nth(1)?.parse().ok())
+            .unwrap_or(0);
+        (resident_pages * self.page_size) as f64 / (1024.0 * 1024.0)
+    }
+}
+
+impl Default for Metrics {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// User + system CPU time of every thread in the process
+fn process_cpu_time() -> Duration {
+    let mut usage: libc::rusage = unsafe { std::mem::zeroed() };
+    if unsafe { libc::getrusage(libc::RUSAGE_SELF, &mut usage) } != 0 {
+        return Duration::ZERO;
+    }
+    let timeval = |tv: libc::timeval| Duration::new(tv.tv_sec as u64, tv.tv_usec as u32 * 1000);
+    timeval(usage.ru_utime) + timeval(usage.ru_stime)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_phase_percentiles() {
+        let metrics = Metrics::new();
+        for ms in 1..=100u64 {
+            metrics.record(Phase::Scan, Duration::from_millis(ms));
+        }
+        let report = metrics.report();
+        let scan = report.phases.iter().find(|p| p.phase == "scan").unwrap();
+        assert_eq!(scan.count, 100);
+        assert_eq!((scan.p50_ms, scan.p95_ms, scan.p99_ms, scan.max_ms), (50.0, 95.0, 99.0, 100.0));
+        assert_eq!(scan.last_ms, 100.0);
+        let db = report.phases.iter().find(|p| p.phase == "db").unwrap();
+        assert_eq!((db.count, db.p99_ms), (0, 0.0));
+    }
+
+    #[test]
+    fn test_phase_ring_keeps_recent_samples() {
+        let metrics = Metrics::new();
+        for _ in 0..PHASE_SAMPLES {
+            metrics.record(Phase::Detect, Duration::from_millis(500));
+        }
+        for _ in 0..PHASE_SAMPLES {
+            metrics.record(Phase::Detect, Duration::from_millis(1));
+        }
+        let report = metrics.report();
+        let detect = report.phases.iter().find(|p| p.phase == "detect").unwrap();
+        assert_eq!(detect.max_ms, 1.0);
+        assert_eq!(detect.count, 2 * PHASE_SAMPLES as u64);
+    }
+
+    #[test]
+    fn test_self_samples() {
+        let metrics = Metrics::new();
+        metrics.sample_self();
+        // Burn a little CPU so the second sample has something to measure
+        let mut x = 0u64;
+        for i in 0..2_000_000u64 {
+            x = x.wrapping_add(i * i);
+        }
+        std::hint::black_box(x);
+        metrics.sample_self();
+        let report = metrics.report();
+        assert!(report.rss_mb > 0.0);
+        assert_eq!(report.history.len(), 2);
+        let (first, second) = (report.history[0], report.history[1]);
+        // Nothing to measure against on the first sample
+        assert_eq!(first.cpu_percent, 0.0);
+        assert!(second.cpu_percent.is_finite());
+        assert!(first.rss_mb > 0.0 && second.rss_mb > 0.0);
+        assert!(first.timestamp > 0 && second.timestamp >= first.timestamp);
+        assert_eq!(report.cpu_percent, second.cpu_percent);
+    }
+}
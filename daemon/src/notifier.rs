@@ -1,8 +1,12 @@
 //! System notification sender
 
+use crate::detector::{Alert, AlertReason, Severity};
 use notify_rust::Notification;
 use tracing::warn;
 
+/// Maximum number of distinct process names listed per reason in a digest
+const DIGEST_MAX_NAMES: usize = 3;
+
 pub struct Notifier {
     app_name: String,
 }
@@ -24,6 +28,13 @@ impl Notifier {
             warn!("Failed to send notification: {}", e);
         }
     }
+
+    /// Send a single notification summarizing all alerts raised in one tick
+    pub fn send_digest(&self, alerts: &[Alert]) {
+        if let Some((summary, body)) = digest(alerts) {
+            self.send(&summary, &body);
+        }
+    }
 }
 
 impl Default for Notifier {
@@ -32,6 +43,69 @@ impl Default for Notifier {
     }
 }
 
+/// Build the (summary, body) of a digest notification.
+///
+/// A single alert keeps the per-process format; several alerts are grouped
+/// by reason, e.g. "37 processes exceeded CPU (stress, make, cc1 …)".
+pub fn digest(alerts: &[Alert]) -> Option<(String, String)> {
+    match alerts {
+        [] => None,
+        [alert] => Some((
+            format!("RunawayGuard: {} ({})", alert.name, alert.severity.as_str()),
+            format!("PID {} - {}", alert.pid, alert.reason.as_str()),
+        )),
+        _ => {
+            let critical = alerts.iter().filter(|a| a.severity == Severity::Critical).count();
+            let summary = if critical > 0 {
+                format!("RunawayGuard: {} alerts ({} critical)", alerts.len(), critical)
+            } else {
+                format!("RunawayGuard: {} alerts", alerts.len())
+            };
+
+            let reasons = [
+                AlertReason::CpuHigh,
+                AlertReason::MemoryLeak,
+                AlertReason::Hang,
+                AlertReason::Timeout,
+            ];
+            let mut lines = Vec::new();
+            for reason in &reasons {
+                let mut count = 0;
+                let mut names: Vec<&str> = Vec::new();
+                for alert in alerts.iter().filter(|a| &a.reason == reason) {
+                    count += 1;
+                    if names.len() < DIGEST_MAX_NAMES && !names.contains(&alert.name.as_str()) {
+                        names.push(&alert.name);
+                    }
+                }
+                if count == 0 {
+                    continue;
+                }
+                let noun = if count == 1 { "process" } else { "processes" };
+                let mut line = format!("{} {} {}", count, noun, reason_phrase(reason));
+                if !names.is_empty() {
+                    line.push_str(&format!(" ({}", names.join(", ")));
+                    if count > names.len() {
+                        line.push_str(" …");
+                    }
+                    line.push(')');
+                }
+                lines.push(line);
+            }
+            Some((summary, lines.join("\n")))
+        }
+    }
+}
+
+fn reason_phrase(reason: &AlertReason) -> &'static str {
+    match reason {
+        AlertReason::CpuHigh => "exceeded CPU",
+        AlertReason::Hang => "hung",
+        AlertReason::MemoryLeak => "leaking memory",
+        AlertReason::Timeout => "exceeded runtime",
+    }
+}
+
 pub fn send_notification(summary: &str, body: &str) -> Result<(), notify_rust::error::Error> {
     Notification::new()
         .summary(summary)
@@ -40,3 +114,44 @@ pub fn send_notification(summary: &str, body: &str) -> Result<(), notify_rust::e
         .show()?;
     Ok(())
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn alert(pid: u32, name: &str, reason: AlertReason, severity: Severity) -> Alert {
+        Alert {
+            pid,
+            name: name.to_string(),
+            cmdline: String::new(),
+            reason,
+            severity,
+            timestamp: 0,
+        }
+    }
+
+    #[test]
+    fn test_digest_single_alert() {
+        let (summary, body) =
+            digest(&[alert(42, "stress", AlertReason::CpuHigh, Severity::Warning)]).unwrap();
+        assert_eq!(summary, "RunawayGuard: stress (warning)");
+        assert_eq!(body, "PID 42 - cpu_high");
+    }
+
+    #[test]
+    fn test_digest_groups_by_reason() {
+        let mut alerts: Vec<Alert> = (0..37)
+            .map(|i| alert(i, "stress", AlertReason::CpuHigh, Severity::Warning))
+            .collect();
+        alerts.push(alert(100, "leaky", AlertReason::MemoryLeak, Severity::Critical));
+
+        let (summary, body) = digest(&alerts).unwrap();
+        assert_eq!(summary, "RunawayGuard: 38 alerts (1 critical)");
+        assert_eq!(body, "37 processes exceeded CPU (stress …)\n1 process leaking memory (leaky)");
+    }
+
+    #[test]
+    fn test_digest_empty() {
+        assert!(digest(&[]).is_none());
+    }
+}
@@ -0,0 +1,87 @@
+//! Pidfile next to the socket
+//!
+//! `/run/user/<uid>/runaway-guard.pid` holds "<pid> <start time>", the start
+//! time being field 22 of `/proc/<pid>/stat` (clock ticks after boot). A
+//! client trusts it only if that PID is alive with the same start time, so a
+//! file left behind by a killed daemon is never mistaken for a running one
+//! even after its PID is reused. The GUI uses it instead of `pgrep`.
+
+use crate::collector::parse_stat;
+use std::fs;
+use std::io;
+use std::path::{Path, PathBuf};
+
+pub struct PidFile {
+    path: PathBuf,
+    pid: u32,
+}
+
+impl PidFile {
+    pub fn default_path() -> PathBuf {
+        let uid = unsafe { libc::getuid() };
+        PathBuf::from(format!("/run/user/{}/runaway-guard.pid", uid))
+    }
+
+    /// Write this process's entry, replacing any earlier one. Written to a
+    /// temporary file and renamed so readers never see a partial line.
+    pub fn create(path: &Path) -> io::Result<Self> {
+        let pid = std::process::id();
+        let start_time = start_time(Path::new("/proc"), pid)
+            .ok_or_else(|| io::Error::new(io::ErrorKind::NotFound, "cannot read /proc/<pid>/stat"))?;
+        let tmp = path.with_extension("pid.tmp");
+        fs::write(&tmp, format!("{} {}\n", pid, start_time))?;
+        fs::rename(&tmp, path)?;
+        Ok(Self { path: path.to_path_buf(), pid })
+    }
+
+    /// The PID recorded in `path` if that process is still the one that
+    /// wrote it
+    pub fn running_pid(path: &Path, proc_root: &Path) -> Option<u32> {
+        let contents = fs::read_to_string(path).ok()?;
+        let mut fields = contents.split_whitespace();
+        let pid: u32 = fields.next()?.parse().ok()?;
+        let recorded: u64 = fields.next()?.parse().ok()?;
+        (start_time(proc_root, pid)? == recorded).then_some(pid)
+    }
+}
+
+impl Drop for PidFile {
+    fn drop(&mut self) {
+        // Leave a newer daemon's file alone
+        if Self::running_pid(&self.path, Path::new("/proc")) == Some(self.pid) {
+            let _ = fs::remove_file(&self.path);
+        }
+    }
+}
+
+fn start_time(proc_root: &Path, pid: u32) -> Option<u64> {
+    let stat = fs::read(proc_root.join(pid.to_string()).join("stat")).ok()?;
+    parse_stat(&stat).map(|fields| fields.start_time)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_pidfile_round_trip() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("runaway-guard.pid");
+        let pidfile = PidFile::create(&path).unwrap();
+        assert_eq!(PidFile::running_pid(&path, Path::new("/proc")), Some(std::process::id()));
+        drop(pidfile);
+        assert!(!path.exists());
+    }
+
+    #[test]
+    fn test_reused_pid_is_not_running() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("runaway-guard.pid");
+        let pid = std::process::id();
+        let actual = start_time(Path::new("/proc"), pid).unwrap();
+        fs::write(&path, format!("{} {}\n", pid, actual + 1)).unwrap();
+        assert_eq!(PidFile::running_pid(&path, Path::new("/proc")), None);
+        fs::write(&path, "garbage").unwrap();
+        assert_eq!(PidFile::running_pid(&path, Path::new("/proc")), None);
+    }
+}
@@ -0,0 +1,216 @@
+//! Pressure stall information (PSI)
+//!
+//! Registers a trigger on `/proc/pressure/{cpu,memory,io}` and blocks in
+//! poll() on the trigger fds from one thread. The kernel wakes it as soon as
+//! tasks have stalled for `TRIGGER_STALL_PERCENT` of a window, so the
+//! monitoring loop can sample right away instead of at its next tick; while
+//! the system is calm the thread costs nothing. The `avg10` averages are read
+//! on demand for the status frame.
+
+use std::fs::{self, File, OpenOptions};
+use std::io::{self, Write};
+use std::os::fd::AsRawFd;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+use std::thread;
+use std::time::{Duration, Instant};
+use tracing::{debug, warn};
+
+pub const RESOURCES: [&str; 3] = ["cpu", "memory", "io"];
+
+/// Share of a window (percent) tasks must stall to fire a trigger. Brief
+/// stalls are routine on a busy desktop; only sustained ones are worth a
+/// full rescan.
+const TRIGGER_STALL_PERCENT: u64 = 20;
+
+/// Trigger window. Without CAP_SYS_RESOURCE the kernel only accepts
+/// multiples of `UNPRIVILEGED_WINDOW_US`.
+const TRIGGER_WINDOW_US: u64 = 1_000_000;
+const UNPRIVILEGED_WINDOW_US: u64 = 2_000_000;
+
+/// Share of time (percent, `some` line, 10 s average) that at least one
+/// task stalled on each resource
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct Pressure {
+    pub cpu: f64,
+    pub memory: f64,
+    pub io: f64,
+}
+
+impl Pressure {
+    pub fn max(&self) -> f64 {
+        self.cpu.max(self.memory).max(self.io)
+    }
+}
+
+pub struct PressureMonitor {
+    root: PathBuf,
+    started: Instant,
+    /// Milliseconds after `started` of the last trigger, plus one (0 = never)
+    last_trigger: AtomicU64,
+    triggers: usize,
+}
+
+impl PressureMonitor {
+    /// Read the averages under `root` (normally `/proc/pressure`) without
+    /// registering triggers. Fails if PSI is not available.
+    pub fn open(root: &Path) -> io::Result<Self> {
+        // Kernels built without PSI, or booted with psi=0, fail this read
+        fs::read_to_string(root.join("cpu"))?;
+        Ok(Self {
+            root: root.to_path_buf(),
+            started: Instant::now(),
+            last_trigger: AtomicU64::new(0),
+            triggers: 0,
+        })
+    }
+
+    /// As `open`, and call `on_stall` with the resource name from the poll
+    /// thread whenever a trigger fires. Resources whose trigger cannot be
+    /// registered (no write access) are only averaged.
+    pub fn start(
+        root: &Path,
+        on_stall: impl Fn(&'static str) + Send + 'static,
+    ) -> io::Result<Arc<Self>> {
+        let mut monitor = Self::open(root)?;
+        let mut fds = Vec::new();
+        for resource in RESOURCES {
+            match Self::register(&root.join(resource)) {
+                Ok(file) => fds.push((resource, file)),
+                Err(e) => debug!("No PSI trigger on {}: {}", resource, e),
+            }
+        }
+        monitor.triggers = fds.len();
+        let monitor = Arc::new(monitor);
+        if !fds.is_empty() {
+            let poller = Arc::clone(&monitor);
+            thread::Builder::new()
+                .name("psi-triggers".to_string())
+                .spawn(move || poller.run(fds, on_stall))?;
+        }
+        Ok(monitor)
+    }
+
+    fn register(path: &Path) -> io::Result<File> {
+        let mut last_error = None;
+        for window in [TRIGGER_WINDOW_US, UNPRIVILEGED_WINDOW_US] {
+            let mut file = OpenOptions::new().read(true).write(true).open(path)?;
+            // The kernel expects the terminating NUL
+            let trigger = format!("some {} {}\0", window * TRIGGER_STALL_PERCENT / 100, window);
+            match file.write_all(trigger.as_bytes()) {
+                Ok(()) => return Ok(file),
+                Err(e) => last_error = Some(e),
+            }
+        }
+        Err(last_error.unwrap())
+    }
+
+    fn run(&self, mut fds: Vec<(&'static str, File)>, on_stall: impl Fn(&'static str)) {
+        while !fds.is_empty() {
+            let mut pollfds: Vec<libc::pollfd> = fds
+                .iter()
+                .map(|(_, file)| libc::pollfd { fd: file.as_raw_fd(), events: libc::POLLPRI, revents: 0 })
+                .collect();
+            let n = unsafe { libc::poll(pollfds.as_mut_ptr(), pollfds.len() as libc::nfds_t, -1) };
+            if n < 0 {
+                let err = io::Error::last_os_error();
+                if err.kind() == io::ErrorKind::Interrupted {
+                    continue;
+                }
+                warn!("PSI poll failed: {}", err);
+                return;
+            }
+            let mut closed = Vec::new();
+            for (i, pollfd) in pollfds.iter().enumerate() {
+                if pollfd.revents & libc::POLLPRI != 0 {
+                    let elapsed = self.started.elapsed().as_millis() as u64;
+                    self.last_trigger.store(elapsed + 1, Ordering::Relaxed);
+                    on_stall(fds[i].0);
+                }
+                if pollfd.revents & (libc::POLLERR | libc::POLLNVAL) != 0 {
+                    closed.push(i);
+                }
+            }
+            for i in closed.into_iter().rev() {
+                warn!("PSI trigger on {} was closed", fds[i].0);
+                fds.remove(i);
+            }
+        }
+    }
+
+    /// Number of resources with a registered trigger
+    pub fn trigger_count(&self) -> usize {
+        self.triggers
+    }
+
+    /// Whether a trigger fired within the last `period`
+    pub fn stalled_within(&self, period: Duration) -> bool {
+        match self.last_trigger.load(Ordering::Relaxed) {
+            0 => false,
+            at => self.started.elapsed().as_millis() as u64 + 1 - at <= period.as_millis() as u64,
+        }
+    }
+
+    /// Current 10 s averages; a resource that cannot be read reports 0
+    pub fn read(&self) -> Pressure {
+        let avg10 = |resource: &str| {
+            fs::read_to_string(self.root.join(resource))
+                .ok()
+                .and_then(|contents| parse_some_avg10(&contents))
+                .unwrap_or(0.0)
+        };
+        Pressure { cpu: avg10("cpu"), memory: avg10("memory"), io: avg10("io") }
+    }
+}
+
+/// `avg10` of the `some` line of a PSI file
+fn parse_some_avg10(contents: &str) -> Option<f64> {
+    let line = contents.lines().find(|line| line.starts_with("some "))?;
+    line.split_whitespace()
+        .find_map(|field| field.strip_prefix("avg10="))?
+        .parse()
+        .ok()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_some_avg10() {
+        let cpu = "some avg10=2.47 avg60=3.42 avg300=5.10 total=208341507\n\
+                   full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n";
+        assert_eq!(parse_some_avg10(cpu), Some(2.47));
+        assert_eq!(parse_some_avg10("full avg10=1.00 avg60=0.00 avg300=0.00 total=0\n"), None);
+    }
+
+    #[test]
+    fn test_reads_averages() {
+        let dir = tempfile::tempdir().unwrap();
+        for (resource, avg10) in [("cpu", "1.50"), ("memory", "12.25"), ("io", "0.00")] {
+            std::fs::write(
+                dir.path().join(resource),
+                format!("some avg10={avg10} avg60=0.00 avg300=0.00 total=0\n"),
+            )
+            .unwrap();
+        }
+        let monitor = PressureMonitor::open(dir.path()).unwrap();
+        let pressure = monitor.read();
+        assert_eq!(pressure, Pressure { cpu: 1.5, memory: 12.25, io: 0.0 });
+        assert_eq!(pressure.max(), 12.25);
+        assert!(!monitor.stalled_within(Duration::from_secs(10)));
+
+        assert!(PressureMonitor::open(&dir.path().join("missing")).is_err());
+    }
+
+    #[test]
+    fn test_registers_kernel_triggers() {
+        let root = Path::new("/proc/pressure");
+        if !root.join("cpu").exists() {
+            return; // Kernel without PSI
+        }
+        let monitor = PressureMonitor::start(root, |_| {}).unwrap();
+        assert!(monitor.read().max() >= 0.0);
+    }
+}
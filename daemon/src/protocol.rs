@@ -17,12 +17,57 @@ pub enum Request {
     PauseMonitoring,
     ResumeMonitoring,
     ClearAlerts,
+    GetDbStats,
+    GetMetrics,
+    CompactDatabase,
+    GetStatus,
+    GetProcessEvents { params: GetProcessEventsParams },
+    GetSystemStats { params: GetSystemStatsParams },
+    QueryHistory { params: QueryHistoryParams },
+    ProcessDetails { params: ProcessDetailsParams },
 }
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct GetAlertsParams {
     pub limit: Option<u32>,
     pub since: Option<String>,
+    /// Inclusive time range (unix seconds) for paged exports
+    pub from: Option<i64>,
+    pub to: Option<i64>,
+    /// Keyset cursor: only return alerts with an id below this one
+    pub before_id: Option<i64>,
+}
+
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct GetProcessEventsParams {
+    /// Only return events with a sequence number above this one
+    pub since: Option<u64>,
+    pub limit: Option<u32>,
+}
+
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct GetSystemStatsParams {
+    /// Only return samples with a sequence number above this one
+    pub since: Option<u64>,
+    pub limit: Option<u32>,
+}
+
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct QueryHistoryParams {
+    /// Without pid or name the system totals are returned, each point with
+    /// the processes that used the most CPU in it
+    pub pid: Option<u32>,
+    pub name: Option<String>,
+    /// Inclusive time range (unix seconds); defaults to the last hour
+    pub from: Option<i64>,
+    pub to: Option<i64>,
+    /// "1s", "1m" or "1h"; by default the finest that still reaches `from`
+    pub resolution: Option<String>,
+}
+
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct ProcessDetailsParams {
+    pub pid: u32,
 }
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
@@ -48,6 +93,7 @@ pub enum Response {
     Pong,
     Response { id: Option<String>, data: serde_json::Value },
     Alert { data: AlertData },
+    AlertsBatch { data: AlertsBatchData },
     Status { data: StatusData },
     Config { data: ConfigData },
 }
@@ -60,10 +106,57 @@ pub struct AlertData {
     pub severity: String,
 }
 
+/// All alerts raised during one monitoring tick, sent as a single frame
 #[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct AlertsBatchData {
+    pub alerts: Vec<AlertData>,
+}
+
+#[derive(Debug, Clone, Default, PartialEq, Eq, Serialize, Deserialize)]
 pub struct StatusData {
+    /// Live processes under monitoring (not whitelisted) after the last tick
     pub monitored_count: u32,
+    /// Unacknowledged alerts (warning + critical) since the last clear
     pub alert_count: u32,
+    pub warning_count: u32,
+    pub critical_count: u32,
+    /// Live processes that matched the whitelist and are not checked
+    pub whitelisted_count: u32,
+    /// /proc entries that could not be read on the last tick
+    pub skipped_count: u32,
+    /// Monitored processes per sampling tier after the last tick: read
+    /// every tick, every normal interval, and rarely
+    pub hot_count: u32,
+    pub normal_count: u32,
+    pub idle_count: u32,
+    /// Leaf cgroups under monitoring (0 unless cgroup monitoring is on)
+    pub cgroup_count: u32,
+    /// Share of the last 10 s (percent) that some task stalled waiting for
+    /// each resource, from /proc/pressure, in 10% steps; 0 without PSI
+    pub cpu_pressure: u32,
+    pub memory_pressure: u32,
+    pub io_pressure: u32,
+    /// A stall was detected and every process is being sampled each tick
+    pub stalled: bool,
+    pub paused: bool,
+    /// What drives the sampling rate right now, and the interval (seconds)
+    /// at which the process snapshot is refreshed because of it
+    pub sampling_mode: SamplingMode,
+    pub sample_interval_secs: u32,
+}
+
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize, Deserialize)]
+#[serde(rename_all = "snake_case")]
+pub enum SamplingMode {
+    /// Nothing is near a threshold; processes are read every normal
+    /// interval or less often
+    #[default]
+    Normal,
+    /// Some process is alerting or close to a threshold and is read every
+    /// `sample_interval_alert`
+    Alert,
+    /// A pressure stall: every process is read every `sample_interval_alert`
+    Stall,
 }
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
@@ -72,6 +165,8 @@ pub struct ConfigData {
     pub hang: HangConfig,
     pub memory_leak: MemoryLeakConfig,
     pub general: GeneralConfig,
+    #[serde(default)]
+    pub retention: RetentionConfig,
 }
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
@@ -99,4 +194,23 @@ pub struct GeneralConfig {
     pub sample_interval_normal: u32,
     pub sample_interval_alert: u32,
     pub notification_method: String,
+    #[serde(default)]
+    pub collector_workers: u32,
+}
+
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct RetentionConfig {
+    pub enabled: bool,
+    pub raw_alert_days: u32,
+    pub rollup_days: u32,
+}
+
+impl Default for RetentionConfig {
+    fn default() -> Self {
+        Self {
+            enabled: true,
+            raw_alert_days: 30,
+            rollup_days: 365,
+        }
+    }
 }
@@ -0,0 +1,305 @@
+//! Per-process sampling schedule
+//!
+//! The monitoring loop ticks at the fast (`sample_interval_alert`) rate, but
+//! a process only has its /proc files read on the ticks it is due. After each
+//! read it is placed in a tier, which sets when it is read next:
+//!
+//! - `hot`: alerting, or within reach of a threshold; read every tick.
+//!   Stopped (`T`) processes never are
+//! - `normal`: read every `sample_interval_normal`
+//! - `idle`: sleeping without using CPU; read every `IDLE_MULTIPLIER` normal intervals
+//! - `whitelisted`: never checked; re-read every `WHITELIST_RECHECK_SECS` in
+//!   case it exec'd into something that is not whitelisted
+//!
+//! New PIDs are read on the tick they first appear, and so are PIDs that may
+//! have been recycled: those the proc connector saw fork or exec, or, when
+//! polling, whose /proc directory was recreated. Each process carries the
+//! tick it is next due, so deciding whether to read a PID is one lookup
+//! during the PID walk the collector does anyway to find spawns and exits.
+
+use crate::collector::ProcessInfo;
+use crate::config::DetectionConfig;
+use std::collections::HashMap;
+
+/// Idle processes are read this many normal intervals apart
+pub const IDLE_MULTIPLIER: u64 = 6;
+
+/// Whitelisted processes are re-read this often to catch exec
+pub const WHITELIST_RECHECK_SECS: u64 = 300;
+
+/// Fraction of a detection threshold at which a process turns hot
+const NEAR_THRESHOLD: f64 = 0.5;
+
+/// CPU use (percent) below which a sleeping process counts as idle
+const IDLE_CPU_PERCENT: f64 = 1.0;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Tier {
+    Hot,
+    Normal,
+    Idle,
+    Whitelisted,
+}
+
+impl Tier {
+    /// Tier of a process that is not whitelisted, from its latest reading.
+    /// `alerted` is whether this reading raised an alert; `leak_rate` is the
+    /// fitted memory growth in MB/min.
+    pub fn classify(
+        process: &ProcessInfo,
+        alerted: bool,
+        leak_rate: Option<f64>,
+        config: &DetectionConfig,
+    ) -> Tier {
+        // A stopped process uses no CPU and cannot grow until it is
+        // continued, so reading it every tick gains nothing even once it has
+        // raised a hang alert; it would only hold the loop in alert mode
+        if process.state == 'T' {
+            return Tier::Normal;
+        }
+        let cpu_near = config.cpu.enabled
+            && process.cpu_percent >= config.cpu.threshold_percent as f64 * NEAR_THRESHOLD;
+        // A process already stuck in D is one hang duration from alerting
+        let hang_near = config.hang.enabled && process.state == 'D';
+        let leak_near = config.memory.enabled
+            && leak_rate.map_or(false, |rate| {
+                rate * config.memory.window_minutes as f64
+                    >= config.memory.growth_mb as f64 * NEAR_THRESHOLD
+            });
+        if alerted || cpu_near || hang_near || leak_near {
+            Tier::Hot
+        } else if process.cpu_percent < IDLE_CPU_PERCENT && matches!(process.state, 'S' | 'I') {
+            Tier::Idle
+        } else {
+            Tier::Normal
+        }
+    }
+}
+
+/// Processes per tier after the last tick
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct TierCounts {
+    pub hot: u32,
+    pub normal: u32,
+    pub idle: u32,
+    pub whitelisted: u32,
+}
+
+struct Entry {
+    /// Latest reading, carried into snapshots on ticks the process is not read
+    process: ProcessInfo,
+    leak_rate: Option<f64>,
+    tier: Tier,
+    /// First tick this process should be read again
+    due: u64,
+    /// Tick of the latest reading
+    read_at: u64,
+    /// Tick whose PID walk last listed this process; older entries are dropped
+    listed_at: u64,
+}
+
+pub struct SamplingScheduler {
+    tick: u64,
+    tick_secs: u64,
+    normal_secs: u64,
+    entries: HashMap<u32, Entry>,
+}
+
+impl SamplingScheduler {
+    /// `tick_secs` is the loop period (the hot interval), `normal_secs`
+    /// the normal tier's interval
+    pub fn new(tick_secs: u64, normal_secs: u64) -> Self {
+        Self {
+            tick: 0,
+            tick_secs: tick_secs.max(1),
+            normal_secs,
+            entries: HashMap::new(),
+        }
+    }
+
+    /// Change the intervals; processes already scheduled keep their due tick
+    pub fn set_intervals(&mut self, tick_secs: u64, normal_secs: u64) {
+        self.tick_secs = tick_secs.max(1);
+        self.normal_secs = normal_secs;
+    }
+
+    pub fn normal_secs(&self) -> u64 {
+        self.normal_secs
+    }
+
+    pub fn begin_tick(&mut self) {
+        self.tick += 1;
+    }
+
+    /// Whether `pid` should be read this tick. Unknown PIDs always are.
+    pub fn is_due(&self, pid: u32) -> bool {
+        self.entries.get(&pid).map_or(true, |entry| entry.due <= self.tick)
+    }
+
+    /// Make every process due now, e.g. after the whitelist or thresholds
+    /// changed and earlier tiers no longer apply
+    pub fn wake_all(&mut self) {
+        for entry in self.entries.values_mut() {
+            entry.due = 0;
+        }
+    }
+
+    /// Store this tick's reading of a process and schedule its next one
+    pub fn record(&mut self, process: ProcessInfo, tier: Tier, leak_rate: Option<f64>) {
+        let due = self.tick + self.ticks_for(tier);
+        self.entries.insert(
+            process.pid,
+            Entry {
+                process,
+                leak_rate,
+                tier,
+                due,
+                read_at: self.tick,
+                listed_at: self.tick,
+            },
+        );
+    }
+
+    /// Drop processes missing from this tick's PID walk
+    pub fn retain_listed(&mut self, pids: &[u32]) {
+        let tick = self.tick;
+        for pid in pids {
+            if let Some(entry) = self.entries.get_mut(pid) {
+                entry.listed_at = tick;
+            }
+        }
+        self.entries.retain(|_, entry| entry.listed_at == tick);
+    }
+
+    /// Checked processes that were alive but not read this tick
+    pub fn unread(&self) -> impl Iterator<Item = &ProcessInfo> + '_ {
+        self.entries
+            .values()
+            .filter(move |entry| entry.read_at != self.tick && entry.tier != Tier::Whitelisted)
+            .map(|entry| &entry.process)
+    }
+
+    /// Latest reading of every live process with its leak rate. Runtimes of
+    /// processes not read this tick are advanced to `now`.
+    pub fn snapshot(&self, now: u64) -> (Vec<ProcessInfo>, Vec<Option<f64>>) {
+        let mut processes = Vec::with_capacity(self.entries.len());
+        let mut leak_rates = Vec::with_capacity(self.entries.len());
+        for entry in self.entries.values() {
+            let mut process = entry.process.clone();
+            process.runtime_seconds = now.saturating_sub(process.start_time);
+            processes.push(process);
+            leak_rates.push(entry.leak_rate);
+        }
+        (processes, leak_rates)
+    }
+
+    pub fn counts(&self) -> TierCounts {
+        let mut counts = TierCounts::default();
+        for entry in self.entries.values() {
+            match entry.tier {
+                Tier::Hot => counts.hot += 1,
+                Tier::Normal => counts.normal += 1,
+                Tier::Idle => counts.idle += 1,
+                Tier::Whitelisted => counts.whitelisted += 1,
+            }
+        }
+        counts
+    }
+
+    fn ticks_for(&self, tier: Tier) -> u64 {
+        let secs = match tier {
+            Tier::Hot => self.tick_secs,
+            Tier::Normal => self.normal_secs,
+            Tier::Idle => self.normal_secs * IDLE_MULTIPLIER,
+            Tier::Whitelisted => WHITELIST_RECHECK_SECS,
+        };
+        secs.div_ceil(self.tick_secs).max(1)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::config::Config;
+
+    fn process(pid: u32, cpu_percent: f64, state: char) -> ProcessInfo {
+        ProcessInfo {
+            pid,
+            name: "test".to_string(),
+            cmdline: String::new(),
+            cpu_percent,
+            memory_mb: 10.0,
+            runtime_seconds: 0,
+            state,
+            start_time: 1000,
+            start_ticks: 0,
+        }
+    }
+
+    /// Runs `ticks` ticks with `pid` always listed, recording it as `tier`
+    /// whenever it is due; returns how many ticks read it
+    fn reads(scheduler: &mut SamplingScheduler, pid: u32, tier: Tier, ticks: u32) -> u32 {
+        let mut reads = 0;
+        for _ in 0..ticks {
+            scheduler.begin_tick();
+            if scheduler.is_due(pid) {
+                scheduler.record(process(pid, 0.0, 'S'), tier, None);
+                reads += 1;
+            }
+            scheduler.retain_listed(&[pid]);
+        }
+        reads
+    }
+
+    #[test]
+    fn test_classify() {
+        let config = Config::default().detection;
+        // 90% threshold: hot from 45%
+        assert_eq!(Tier::classify(&process(1, 50.0, 'R'), false, None, &config), Tier::Hot);
+        assert_eq!(Tier::classify(&process(1, 0.0, 'S'), true, None, &config), Tier::Hot);
+        assert_eq!(Tier::classify(&process(1, 0.0, 'D'), false, None, &config), Tier::Hot);
+        // Stopped: not read faster, even while its hang alert is active
+        assert_eq!(Tier::classify(&process(1, 0.0, 'T'), false, None, &config), Tier::Normal);
+        assert_eq!(Tier::classify(&process(1, 0.0, 'T'), true, None, &config), Tier::Normal);
+        // 500 MB over 5 minutes: hot from 50 MB/min
+        assert_eq!(Tier::classify(&process(1, 0.0, 'S'), false, Some(60.0), &config), Tier::Hot);
+        assert_eq!(Tier::classify(&process(1, 10.0, 'R'), false, Some(1.0), &config), Tier::Normal);
+        assert_eq!(Tier::classify(&process(1, 5.0, 'S'), false, None, &config), Tier::Normal);
+        assert_eq!(Tier::classify(&process(1, 0.0, 'S'), false, None, &config), Tier::Idle);
+    }
+
+    #[test]
+    fn test_tier_intervals() {
+        // 2 s ticks, 10 s normal interval
+        let mut scheduler = SamplingScheduler::new(2, 10);
+        assert_eq!(reads(&mut scheduler, 1, Tier::Hot, 60), 60);
+        assert_eq!(reads(&mut scheduler, 2, Tier::Normal, 60), 12);
+        assert_eq!(reads(&mut scheduler, 3, Tier::Idle, 60), 2);
+        assert_eq!(reads(&mut scheduler, 4, Tier::Whitelisted, 300), 2);
+    }
+
+    #[test]
+    fn test_unlisted_processes_dropped() {
+        let mut scheduler = SamplingScheduler::new(2, 10);
+        scheduler.begin_tick();
+        scheduler.record(process(1, 0.0, 'S'), Tier::Idle, None);
+        scheduler.record(process(2, 0.0, 'S'), Tier::Idle, Some(0.5));
+        scheduler.retain_listed(&[1, 2]);
+
+        scheduler.begin_tick();
+        assert!(!scheduler.is_due(1));
+        assert!(scheduler.is_due(3));
+        scheduler.retain_listed(&[2]);
+
+        let (processes, leak_rates) = scheduler.snapshot(1100);
+        assert_eq!(processes.len(), 1);
+        assert_eq!(processes[0].pid, 2);
+        assert_eq!(processes[0].runtime_seconds, 100);
+        assert_eq!(leak_rates, vec![Some(0.5)]);
+        assert_eq!(scheduler.unread().count(), 1);
+        assert_eq!(scheduler.counts(), TierCounts { idle: 1, ..Default::default() });
+
+        scheduler.wake_all();
+        assert!(scheduler.is_due(2));
+    }
+}
@@ -88,11 +88,17 @@ pub async fn handle_client<H>(
                 }
             }
             result = broadcast_rx.recv() => {
-                if let Ok(msg) = result {
-                    if let Err(e) = writer.write_all((msg + "\n").as_bytes()).await {
-                        error!("Failed to broadcast: {}", e);
-                        break;
+                match result {
+                    Ok(msg) => {
+                        if let Err(e) = writer.write_all((msg + "\n").as_bytes()).await {
+                            error!("Failed to broadcast: {}", e);
+                            break;
+                        }
+                    }
+                    Err(broadcast::error::RecvError::Lagged(skipped)) => {
+                        warn!("Client too slow, dropped {} broadcast frames", skipped);
                     }
+                    Err(broadcast::error::RecvError::Closed) => break,
                 }
             }
         }
@@ -0,0 +1,162 @@
+//! Compiled whitelist matcher
+//!
+//! The whitelist is compiled once per change into one structure per match
+//! type, so checking a process costs the same with five entries or five
+//! thousand:
+//!
+//! - `name`: exact process name, hash set lookup
+//! - `cmdline`: substring of the command line, one Aho-Corasick pass
+//! - `regex`: process name or command line, one `RegexSet` pass each
+
+use aho_corasick::AhoCorasick;
+use regex::RegexSet;
+use std::collections::HashSet;
+use tracing::warn;
+
+pub const MATCH_NAME: &str = "name";
+pub const MATCH_CMDLINE: &str = "cmdline";
+pub const MATCH_REGEX: &str = "regex";
+
+#[derive(Debug, Default)]
+pub struct WhitelistMatcher {
+    names: HashSet<String>,
+    cmdline: Option<AhoCorasick>,
+    regexes: Option<RegexSet>,
+}
+
+impl WhitelistMatcher {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Compile `(pattern, match_type)` entries. Entries that fail
+    /// `validate` are logged and left out rather than failing the build.
+    pub fn build<'a>(entries: impl IntoIterator<Item = (&'a str, &'a str)>) -> Self {
+        let mut names = HashSet::new();
+        let mut substrings = Vec::new();
+        let mut patterns = Vec::new();
+        for (pattern, match_type) in entries {
+            if let Err(e) = Self::validate(pattern, match_type) {
+                warn!("Ignoring whitelist entry {:?}: {}", pattern, e);
+                continue;
+            }
+            match match_type {
+                MATCH_NAME => {
+                    names.insert(pattern.to_string());
+                }
+                MATCH_CMDLINE => substrings.push(pattern),
+                _ => patterns.push(pattern),
+            }
+        }
+
+        let cmdline = if substrings.is_empty() {
+            None
+        } else {
+            match AhoCorasick::new(&substrings) {
+                Ok(automaton) => Some(automaton),
+                Err(e) => {
+                    warn!("Failed to compile command line whitelist: {}", e);
+                    None
+                }
+            }
+        };
+        let regexes = if patterns.is_empty() {
+            None
+        } else {
+            match RegexSet::new(&patterns) {
+                Ok(set) => Some(set),
+                Err(e) => {
+                    warn!("Failed to compile regex whitelist: {}", e);
+                    None
+                }
+            }
+        };
+
+        Self { names, cmdline, regexes }
+    }
+
+    /// Check an entry before it is stored: known match type, non-empty
+    /// pattern, and a regex that compiles.
+    pub fn validate(pattern: &str, match_type: &str) -> Result<(), String> {
+        if pattern.is_empty() {
+            return Err("pattern is empty".to_string());
+        }
+        match match_type {
+            MATCH_NAME | MATCH_CMDLINE => Ok(()),
+            MATCH_REGEX => regex::Regex::new(pattern).map(|_| ()).map_err(|e| e.to_string()),
+            other => Err(format!("unknown match type {:?}", other)),
+        }
+    }
+
+    /// Exact-name entries are the only kind that can be added without a
+    /// rebuild.
+    pub fn add_name(&mut self, name: String) {
+        self.names.insert(name);
+    }
+
+    pub fn matches(&self, name: &str, cmdline: &str) -> bool {
+        if self.names.contains(name) {
+            return true;
+        }
+        if let Some(automaton) = &self.cmdline {
+            if automaton.is_match(cmdline) {
+                return true;
+            }
+        }
+        if let Some(set) = &self.regexes {
+            if set.is_match(name) || (!cmdline.is_empty() && set.is_match(cmdline)) {
+                return true;
+            }
+        }
+        false
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.names.is_empty() && self.cmdline.is_none() && self.regexes.is_none()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_name_is_exact() {
+        let matcher = WhitelistMatcher::build([("firefox", MATCH_NAME)]);
+        assert!(matcher.matches("firefox", "/usr/lib/firefox/firefox"));
+        assert!(!matcher.matches("firefox-esr", "/usr/lib/firefox-esr/firefox-esr"));
+    }
+
+    #[test]
+    fn test_cmdline_substring() {
+        let matcher = WhitelistMatcher::build([("--type=renderer", MATCH_CMDLINE), ("make -j", MATCH_CMDLINE)]);
+        assert!(matcher.matches("chrome", "/opt/chrome/chrome --type=renderer --id=4"));
+        assert!(matcher.matches("make", "make -j8 all"));
+        assert!(!matcher.matches("chrome", "/opt/chrome/chrome --type=gpu-process"));
+    }
+
+    #[test]
+    fn test_regex_matches_name_or_cmdline() {
+        let matcher = WhitelistMatcher::build([(r"^kworker/", MATCH_REGEX), (r"\.py\b", MATCH_REGEX)]);
+        assert!(matcher.matches("kworker/0:1", ""));
+        assert!(matcher.matches("python3", "python3 /srv/app.py --serve"));
+        assert!(!matcher.matches("bash", "bash -l"));
+    }
+
+    #[test]
+    fn test_invalid_entries_are_skipped() {
+        let matcher = WhitelistMatcher::build([("(unclosed", MATCH_REGEX), ("vim", MATCH_NAME), ("x", "glob")]);
+        assert!(matcher.matches("vim", ""));
+        assert!(!matcher.matches("(unclosed", "(unclosed"));
+        assert!(WhitelistMatcher::validate("(unclosed", MATCH_REGEX).is_err());
+        assert!(WhitelistMatcher::validate("x", "glob").is_err());
+        assert!(WhitelistMatcher::validate("", MATCH_NAME).is_err());
+    }
+
+    #[test]
+    fn test_empty_matches_nothing() {
+        let matcher = WhitelistMatcher::new();
+        assert!(matcher.is_empty());
+        assert!(!matcher.matches("anything", "anything"));
+    }
+}
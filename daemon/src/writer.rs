@@ -0,0 +1,205 @@
+//! Dedicated SQLite writer thread
+//!
+//! Alert inserts are handed off over a bounded channel so the monitoring loop
+//! never waits on a commit. The writer owns its own connection; with the
+//! database in WAL mode, queries on the daemon's read connection proceed while
+//! it writes. Clearing alerts and the one-time auto-vacuum migration also go
+//! through the writer: the clear applies after every insert queued before it,
+//! and inserts queue behind the migration's VACUUM instead of timing out on
+//! its lock.
+
+use crate::db::Database;
+use crate::detector::Alert;
+use crate::metrics::{Metrics, Phase};
+use anyhow::anyhow;
+use rusqlite::ErrorCode;
+use std::sync::mpsc::{self, Receiver, SyncSender, TrySendError};
+use std::sync::Arc;
+use std::thread::{self, JoinHandle};
+use std::time::Duration;
+use tokio::sync::oneshot;
+use tracing::{debug, error, warn};
+
+/// Upper bound on alerts committed in one transaction
+const MAX_BATCH: usize = 1000;
+
+/// Ticks' worth of alerts that may wait for the writer. Past that the disk
+/// is not keeping up and new alerts are dropped (and counted) instead of
+/// piling up in memory.
+const QUEUE_CAPACITY: usize = 64;
+
+/// A batch that hit another connection's lock is retried this often, this
+/// many times (each attempt also waits out the connection's busy timeout)
+const BUSY_RETRY_DELAY: Duration = Duration::from_secs(1);
+const BUSY_RETRIES: u32 = 30;
+
+enum Job {
+    Insert(Vec<Alert>),
+    /// Mark every alert resolved and reply with how many were
+    ResolveAll(oneshot::Sender<rusqlite::Result<usize>>),
+    /// `Database::ensure_incremental_vacuum`; replies whether it converted
+    EnsureIncrementalVacuum(oneshot::Sender<rusqlite::Result<bool>>),
+}
+
+pub struct AlertWriter {
+    tx: Option<SyncSender<Job>>,
+    handle: Option<JoinHandle<()>>,
+    metrics: Option<Arc<Metrics>>,
+}
+
+impl AlertWriter {
+    /// Start the writer thread on an already-initialized database connection.
+    pub fn spawn(db: Database) -> std::io::Result<Self> {
+        Self::spawn_inner(db, None)
+    }
+
+    /// As `spawn`, recording each commit's duration as `Phase::Db` and
+    /// counting alerts dropped on a full queue
+    pub fn spawn_with_metrics(db: Database, metrics: Arc<Metrics>) -> std::io::Result<Self> {
+        Self::spawn_inner(db, Some(metrics))
+    }
+
+    fn spawn_inner(db: Database, metrics: Option<Arc<Metrics>>) -> std::io::Result<Self> {
+        let (tx, rx) = mpsc::sync_channel(QUEUE_CAPACITY);
+        let thread_metrics = metrics.clone();
+        let handle = thread::Builder::new()
+            .name("db-writer".to_string())
+            .spawn(move || run(db, rx, thread_metrics))?;
+        Ok(Self {
+            tx: Some(tx),
+            handle: Some(handle),
+            metrics,
+        })
+    }
+
+    /// Queue alerts for insertion. Never blocks; drops them if the queue is
+    /// full. Returns whether they were queued.
+    pub fn submit(&self, alerts: Vec<Alert>) -> bool {
+        if alerts.is_empty() {
+            return true;
+        }
+        let Some(tx) = &self.tx else {
+            return false;
+        };
+        match tx.try_send(Job::Insert(alerts)) {
+            Ok(()) => true,
+            Err(TrySendError::Full(Job::Insert(alerts))) => {
+                warn!("Database writer is behind, {} alerts dropped", alerts.len());
+                if let Some(metrics) = &self.metrics {
+                    metrics.record_dropped_alerts(alerts.len());
+                }
+                false
+            }
+            Err(_) => {
+                error!("Database writer has stopped, alerts dropped");
+                false
+            }
+        }
+    }
+
+    /// Mark every alert resolved once the inserts already queued are
+    /// committed, so none of them outlives the clear
+    pub async fn resolve_all(&self) -> anyhow::Result<usize> {
+        self.request(Job::ResolveAll).await
+    }
+
+    /// Run the one-time switch to incremental auto-vacuum on the writer's
+    /// connection. Its VACUUM can take minutes; alerts submitted meanwhile
+    /// wait in the queue rather than fail on the lock.
+    pub async fn ensure_incremental_vacuum(&self) -> anyhow::Result<bool> {
+        self.request(Job::EnsureIncrementalVacuum).await
+    }
+
+    async fn request<T>(&self, job: impl FnOnce(oneshot::Sender<rusqlite::Result<T>>) -> Job) -> anyhow::Result<T> {
+        let tx = self.tx.clone().ok_or_else(|| anyhow!("database writer has stopped"))?;
+        let (reply, result) = oneshot::channel();
+        let job = job(reply);
+        // Unlike an insert this must not be dropped, so wait for room in the
+        // queue, off the async runtime
+        tokio::task::spawn_blocking(move || tx.send(job))
+            .await?
+            .map_err(|_| anyhow!("database writer has stopped"))?;
+        Ok(result.await??)
+    }
+}
+
+impl Drop for AlertWriter {
+    /// Close the channel and wait for queued alerts to be committed.
+    fn drop(&mut self) {
+        self.tx.take();
+        if let Some(handle) = self.handle.take() {
+            let _ = handle.join();
+        }
+    }
+}
+
+fn run(db: Database, rx: Receiver<Job>, metrics: Option<Arc<Metrics>>) {
+    while let Ok(job) = rx.recv() {
+        let mut batch = match job {
+            Job::Insert(alerts) => alerts,
+            other => {
+                run_job(&db, other);
+                continue;
+            }
+        };
+        // Fold everything that queued up while the last commit ran into this
+        // one, up to a job that must see this batch committed first
+        let mut next = None;
+        while batch.len() < MAX_BATCH {
+            match rx.try_recv() {
+                Ok(Job::Insert(more)) => batch.extend(more),
+                Ok(other) => {
+                    next = Some(other);
+                    break;
+                }
+                Err(_) => break,
+            }
+        }
+        insert(&db, &batch, metrics.as_deref());
+        if let Some(job) = next {
+            run_job(&db, job);
+        }
+    }
+}
+
+fn run_job(db: &Database, job: Job) {
+    match job {
+        Job::Insert(alerts) => insert(db, &alerts, None),
+        Job::ResolveAll(reply) => {
+            let _ = reply.send(db.resolve_all_alerts());
+        }
+        Job::EnsureIncrementalVacuum(reply) => {
+            let _ = reply.send(db.ensure_incremental_vacuum());
+        }
+    }
+}
+
+/// Commit `batch`, retrying while another connection holds the lock rather
+/// than losing the alerts
+fn insert(db: &Database, batch: &[Alert], metrics: Option<&Metrics>) {
+    let mut attempt = 0;
+    loop {
+        let result = match metrics {
+            Some(metrics) => metrics.time(Phase::Db, || db.insert_alerts(batch)),
+            None => db.insert_alerts(batch),
+        };
+        match result {
+            Ok(n) => {
+                debug!("Committed {} alerts", n);
+                return;
+            }
+            Err(e)
+                if attempt < BUSY_RETRIES
+                    && matches!(e.sqlite_error_code(), Some(ErrorCode::DatabaseBusy | ErrorCode::DatabaseLocked)) =>
+            {
+                attempt += 1;
+                debug!("Database busy, retrying {} alerts: {}", batch.len(), e);
+                thread::sleep(BUSY_RETRY_DELAY);
+            }
+            Err(e) => {
+                error!("Failed to save {} alerts: {}", batch.len(), e);
+                return;
+            }
+        }
+    }
+}
@@ -1,4 +1,7 @@
-use runaway_daemon::collector::{ProcessCollector, LinuxProcessCollector};
+use runaway_daemon::collector::{
+    CgroupCollector, LinuxProcessCollector, ProcessCollector, ProcessEventKind, SystemCollector,
+};
+use runaway_daemon::scheduler::{SamplingScheduler, Tier};
 
 #[test]
 fn test_list_processes_returns_current_process() {
@@ -26,3 +29,276 @@ fn test_get_process_returns_none_for_invalid_pid() {
     let process = collector.get_process(999999999);
     assert!(process.is_none());
 }
+
+#[test]
+fn test_with_root_reads_synthetic_proc_tree() {
+    let dir = tempfile::tempdir().unwrap();
+    std::fs::write(dir.path().join("stat"), "cpu  1 2 3 4\nbtime 1700000000\n").unwrap();
+    for (pid, comm, cmdline) in [(1, "init", "/sbin/init\0splash\0"), (42, "a) S (b", "")] {
+        let pid_dir = dir.path().join(pid.to_string());
+        std::fs::create_dir(&pid_dir).unwrap();
+        std::fs::write(
+            pid_dir.join("stat"),
+            format!("{pid} ({comm}) R 1 {pid} {pid} 0 -1 4194560 0 0 0 0 9 11 0 0 20 0 1 0 100 0 256 0\n"),
+        )
+        .unwrap();
+        std::fs::write(pid_dir.join("cmdline"), cmdline).unwrap();
+    }
+    // Non-PID entries are ignored
+    std::fs::create_dir(dir.path().join("self")).unwrap();
+
+    let collector = LinuxProcessCollector::with_root(dir.path()).unwrap();
+    let mut processes = collector.list_processes();
+    processes.sort_by_key(|p| p.pid);
+    assert_eq!(processes.len(), 2);
+    assert_eq!(processes[0].name, "init");
+    assert_eq!(processes[0].cmdline, "/sbin/init splash");
+    assert_eq!(processes[1].name, "a) S (b");
+    assert_eq!(processes[1].state, 'R');
+    assert_eq!(processes[1].cmdline, "");
+    assert_eq!(collector.skipped_count(), 0);
+}
+
+#[test]
+fn test_parallel_scan_matches_serial() {
+    let dir = tempfile::tempdir().unwrap();
+    std::fs::write(dir.path().join("stat"), "btime 1700000000\n").unwrap();
+    for pid in 1..=300u32 {
+        let pid_dir = dir.path().join(pid.to_string());
+        std::fs::create_dir(&pid_dir).unwrap();
+        std::fs::write(
+            pid_dir.join("stat"),
+            format!("{pid} (w{pid}) S 1 {pid} {pid} 0 -1 0 0 0 0 0 {pid} 0 0 0 20 0 1 0 100 0 16 0\n"),
+        )
+        .unwrap();
+    }
+
+    let collector = LinuxProcessCollector::with_root(dir.path()).unwrap();
+    collector.set_workers(1);
+    let mut serial: Vec<(u32, String)> =
+        collector.list_processes().into_iter().map(|p| (p.pid, p.name)).collect();
+    collector.set_workers(4);
+    let mut parallel: Vec<(u32, String)> =
+        collector.list_processes().into_iter().map(|p| (p.pid, p.name)).collect();
+    serial.sort();
+    parallel.sort();
+    assert_eq!(serial.len(), 300);
+    assert_eq!(serial, parallel);
+}
+
+#[test]
+fn test_polling_reports_spawn_and_exit_events() {
+    let dir = tempfile::tempdir().unwrap();
+    std::fs::write(dir.path().join("stat"), "btime 1700000000\n").unwrap();
+    let spawn = |pid: u32, comm: &str| {
+        let pid_dir = dir.path().join(pid.to_string());
+        std::fs::create_dir(&pid_dir).unwrap();
+        std::fs::write(
+            pid_dir.join("stat"),
+            format!("{pid} ({comm}) S 1 {pid} {pid} 0 -1 0 0 0 0 0 1 1 0 0 20 0 1 0 100 0 16 0\n"),
+        )
+        .unwrap();
+    };
+    spawn(1, "init");
+    spawn(10, "old");
+
+    let collector = LinuxProcessCollector::with_root(dir.path()).unwrap();
+    assert_eq!(collector.event_source(), "polling");
+    collector.list_processes();
+    // Everything is new on the first scan; that is not reported
+    assert!(collector.process_events(0, 100).0.is_empty());
+
+    spawn(20, "new");
+    std::fs::remove_dir_all(dir.path().join("10")).unwrap();
+    collector.list_processes();
+
+    let (mut events, next_seq) = collector.process_events(0, 100);
+    events.sort_by_key(|e| e.pid);
+    assert_eq!(events.len(), 2);
+    assert_eq!((events[0].kind, events[0].pid, events[0].name.as_str()), (ProcessEventKind::Exit, 10, "old"));
+    assert_eq!((events[1].kind, events[1].pid, events[1].name.as_str()), (ProcessEventKind::Spawn, 20, "new"));
+    assert!(collector.process_events(next_seq, 100).0.is_empty());
+}
+
+#[test]
+fn test_recycled_pid_gets_fresh_sample() {
+    let dir = tempfile::tempdir().unwrap();
+    std::fs::write(dir.path().join("stat"), "btime 1700000000\n").unwrap();
+    let pid_dir = dir.path().join("10");
+    std::fs::create_dir(&pid_dir).unwrap();
+    let write_stat = |comm: &str, ticks: u64, start: u64| {
+        std::fs::write(
+            pid_dir.join("stat"),
+            format!("10 ({comm}) S 1 10 10 0 -1 0 0 0 0 0 {ticks} 0 0 0 20 0 1 0 {start} 0 16 0\n"),
+        )
+        .unwrap();
+    };
+
+    write_stat("old", 5, 100);
+    let collector = LinuxProcessCollector::with_root(dir.path()).unwrap();
+    let old = collector.list_processes();
+
+    // Same PID, started a few ticks later (within the same second) with far
+    // more CPU ticks: another process. Measured against the old process's
+    // counters it would show a huge CPU share; as a new process it has none.
+    write_stat("new", 1_000_000, 101);
+    let processes = collector.list_processes();
+    assert_eq!(processes.len(), 1);
+    assert_eq!(processes[0].start_time, old[0].start_time);
+    assert_ne!(processes[0].key(), old[0].key());
+    assert_eq!(processes[0].cpu_percent, 0.0);
+
+    let (events, _) = collector.process_events(0, 100);
+    let summary: Vec<_> = events.iter().map(|e| (e.kind, e.name.as_str())).collect();
+    assert_eq!(summary, vec![(ProcessEventKind::Exit, "old"), (ProcessEventKind::Spawn, "new")]);
+}
+
+#[test]
+fn test_scan_reads_only_selected_pids() {
+    let dir = tempfile::tempdir().unwrap();
+    std::fs::write(dir.path().join("stat"), "btime 1700000000\n").unwrap();
+    for pid in [1, 2] {
+        let pid_dir = dir.path().join(pid.to_string());
+        std::fs::create_dir(&pid_dir).unwrap();
+        std::fs::write(
+            pid_dir.join("stat"),
+            format!("{pid} (p{pid}) S 1 {pid} {pid} 0 -1 0 0 0 0 0 1 1 0 0 20 0 1 0 100 0 16 0\n"),
+        )
+        .unwrap();
+    }
+
+    let collector = LinuxProcessCollector::with_root(dir.path()).unwrap();
+    // PIDs never read before are read whatever the filter says
+    assert_eq!(collector.scan(&|_| false).processes.len(), 2);
+
+    let scan = collector.scan(&|pid| pid == 2);
+    assert_eq!(scan.processes.len(), 1);
+    assert_eq!(scan.processes[0].pid, 2);
+    let mut pids = scan.pids;
+    pids.sort();
+    assert_eq!(pids, vec![1, 2]);
+    // Listed but unread is still alive: no exit event
+    assert!(collector.process_events(0, 100).0.is_empty());
+}
+
+#[test]
+fn test_polling_reads_recycled_pid_before_it_is_due() {
+    let dir = tempfile::tempdir().unwrap();
+    std::fs::write(dir.path().join("stat"), "btime 1700000000\n").unwrap();
+    let pid_dir = dir.path().join("10");
+    let spawn = |comm: &str, start: u64| {
+        std::fs::create_dir(&pid_dir).unwrap();
+        std::fs::write(
+            pid_dir.join("stat"),
+            format!("10 ({comm}) S 1 10 10 0 -1 0 0 0 0 0 1 1 0 0 20 0 1 0 {start} 0 16 0\n"),
+        )
+        .unwrap();
+    };
+    spawn("sshd", 100);
+
+    // Whitelisted: next due in minutes
+    let collector = LinuxProcessCollector::with_root(dir.path()).unwrap();
+    let mut scheduler = SamplingScheduler::new(2, 10);
+    scheduler.begin_tick();
+    for process in collector.scan(&|pid| scheduler.is_due(pid)).processes {
+        scheduler.record(process, Tier::Whitelisted, None);
+    }
+    scheduler.begin_tick();
+    assert!(!scheduler.is_due(10));
+    assert!(collector.scan(&|pid| scheduler.is_due(pid)).processes.is_empty());
+
+    // The PID is reused by a process that is not whitelisted; its new
+    // /proc directory gets it read on the next tick
+    std::fs::remove_dir_all(&pid_dir).unwrap();
+    std::thread::sleep(std::time::Duration::from_millis(20));
+    spawn("miner", 5000);
+    scheduler.begin_tick();
+    let scan = collector.scan(&|pid| scheduler.is_due(pid));
+    assert_eq!(scan.processes.len(), 1);
+    assert_eq!(scan.processes[0].name, "miner");
+}
+
+#[test]
+fn test_cgroup_collector_reads_synthetic_hierarchy() {
+    let dir = tempfile::tempdir().unwrap();
+    assert!(CgroupCollector::with_root(dir.path()).is_err(), "not a cgroup v2 root");
+
+    std::fs::write(dir.path().join("cgroup.controllers"), "cpu memory pids\n").unwrap();
+    let write_cgroup = |path: &str, usage_usec: u64, memory: u64, procs: &str| {
+        let cgroup = dir.path().join(path);
+        std::fs::create_dir_all(&cgroup).unwrap();
+        std::fs::write(cgroup.join("cpu.stat"), format!("usage_usec {usage_usec}\nuser_usec 0\n")).unwrap();
+        std::fs::write(cgroup.join("memory.current"), format!("{memory}\n")).unwrap();
+        std::fs::write(cgroup.join("memory.events"), "low 0\nhigh 4\nmax 0\noom 0\noom_kill 1\n").unwrap();
+        std::fs::write(cgroup.join("cgroup.procs"), procs).unwrap();
+    };
+    write_cgroup("system.slice", 0, 64 << 20, "");
+    write_cgroup("system.slice/app.service", 0, 32 << 20, "10\n11\n");
+
+    let collector = CgroupCollector::with_root(dir.path()).unwrap();
+    let mut cgroups = collector.list_cgroups();
+    cgroups.sort_by(|a, b| a.path.cmp(&b.path));
+    assert_eq!(cgroups.len(), 2);
+    assert!(!cgroups[0].leaf);
+    let app = &cgroups[1];
+    assert_eq!((app.path.as_str(), app.name(), app.leaf), ("system.slice/app.service", "app.service", true));
+    assert_eq!(app.memory_mb, Some(32.0));
+    assert_eq!(app.pids, vec![10, 11]);
+    assert_eq!((app.memory_events.high, app.memory_events.oom_kill), (4, 1));
+    assert_eq!(app.cpu_percent, 0.0);
+
+    // Half a second of CPU since the first read: non-zero on the second
+    std::thread::sleep(std::time::Duration::from_millis(20));
+    write_cgroup("system.slice/app.service", 500_000, 32 << 20, "10\n");
+    let cgroups = collector.list_cgroups();
+    let app = cgroups.iter().find(|c| c.leaf).unwrap();
+    assert!(app.cpu_percent > 0.0);
+    assert_eq!(app.pids, vec![10]);
+
+    // No memory controller: still listed, so it is checked as a leaf for CPU
+    let batch = dir.path().join("batch.slice/job.scope");
+    std::fs::create_dir_all(&batch).unwrap();
+    std::fs::write(batch.join("cpu.stat"), "usage_usec 0\n").unwrap();
+    std::fs::write(dir.path().join("batch.slice/cpu.stat"), "usage_usec 0\n").unwrap();
+    let cgroups = collector.list_cgroups();
+    let job = cgroups.iter().find(|c| c.path == "batch.slice/job.scope").unwrap();
+    assert_eq!((job.memory_mb, job.leaf), (None, true));
+}
+
+#[test]
+fn test_system_collector_reads_synthetic_proc() {
+    let dir = tempfile::tempdir().unwrap();
+    let write_stat = |busy0: u64, busy1: u64| {
+        let stat = format!(
+            "cpu  {} 0 0 {} 0 0 0 0 0 0\ncpu0 {} 0 0 {} 0 0 0 0 0 0\ncpu1 {} 0 0 {} 0 0 0 0 0 0\nintr 0\n",
+            busy0 + busy1, 2000 - busy0 - busy1, busy0, 1000 - busy0, busy1, 1000 - busy1
+        );
+        std::fs::write(dir.path().join("stat"), stat).unwrap();
+    };
+    write_stat(0, 0);
+    std::fs::write(
+        dir.path().join("meminfo"),
+        "MemTotal: 4194304 kB\nMemFree: 1000 kB\nMemAvailable: 1048576 kB\n\
+         SwapTotal: 2097152 kB\nSwapFree: 2097152 kB\n",
+    )
+    .unwrap();
+    std::fs::write(dir.path().join("loadavg"), "1.50 0.75 0.25 2/300 4242\n").unwrap();
+
+    let collector = SystemCollector::with_root(dir.path());
+    let first = collector.sample();
+    assert_eq!(first.cores.len(), 2);
+    assert_eq!(first.cpu_percent, 0.0);
+    assert_eq!((first.memory_total_mb, first.memory_used_mb), (4096.0, 3072.0));
+    assert_eq!((first.swap_total_mb, first.swap_used_mb), (2048.0, 0.0));
+    assert_eq!(first.load, [1.5, 0.75, 0.25]);
+
+    // cpu0 fully busy, cpu1 idle since the first sample
+    std::fs::write(
+        dir.path().join("stat"),
+        "cpu  100 0 0 2100 0 0 0 0 0 0\ncpu0 100 0 0 1000 0 0 0 0 0 0\ncpu1 0 0 0 1100 0 0 0 0 0 0\n",
+    )
+    .unwrap();
+    let second = collector.sample();
+    assert_eq!(second.cores, vec![100.0, 0.0]);
+    assert_eq!(second.cpu_percent, 50.0);
+}
@@ -1,4 +1,7 @@
-use runaway_daemon::db::Database;
+use rusqlite::{params, Connection};
+use runaway_daemon::db::{Database, RollupBatch};
+use runaway_daemon::detector::{Alert, AlertReason, Severity};
+use runaway_daemon::writer::AlertWriter;
 use tempfile::tempdir;
 
 #[test]
@@ -33,3 +36,127 @@ fn test_whitelist_operations() {
     assert!(db.is_whitelisted("chrome", "name").unwrap());
     assert!(!db.is_whitelisted("firefox", "name").unwrap());
 }
+
+#[test]
+fn test_alerts_page_keyset() {
+    let dir = tempdir().unwrap();
+    let db_path = dir.path().join("test.db");
+    let db = Database::open(&db_path).unwrap();
+    db.init_schema().unwrap();
+    for pid in 1..=5 {
+        db.insert_alert(pid, "proc", "/usr/bin/proc", "cpu_high", "warning").unwrap();
+    }
+
+    let first = db.get_alerts_page(2, None, None, None).unwrap();
+    assert_eq!(first.iter().map(|a| a.pid).collect::<Vec<_>>(), vec![5, 4]);
+
+    let second = db.get_alerts_page(2, None, None, Some(first[1].id)).unwrap();
+    assert_eq!(second.iter().map(|a| a.pid).collect::<Vec<_>>(), vec![3, 2]);
+
+    let future = db.get_alerts_page(10, Some(i64::MAX), None, None).unwrap();
+    assert!(future.is_empty());
+}
+
+#[test]
+fn test_rollup_expired_alerts() {
+    let dir = tempdir().unwrap();
+    let db_path = dir.path().join("test.db");
+    let db = Database::open(&db_path).unwrap();
+    db.init_schema().unwrap();
+    for pid in 1..=5 {
+        db.insert_alert(pid, "stress", "stress --cpu 4", "cpu_high", "critical").unwrap();
+    }
+    db.insert_alert(6, "leaky", "leaky", "memory_leak", "warning").unwrap();
+
+    // Backdate everything but the last alert by two days
+    let conn = Connection::open(&db_path).unwrap();
+    conn.execute("UPDATE alerts SET timestamp = timestamp - 172800 WHERE pid < ?1", params![6]).unwrap();
+    drop(conn);
+
+    let cutoff = db.get_alerts(1, None).unwrap()[0].timestamp - 86400;
+    // Acknowledged alerts are rolled up too but no longer count as outstanding
+    db.resolve_alert(1, "dismissed").unwrap();
+    let batch = |deleted, unresolved| RollupBatch { deleted, unresolved };
+    assert_eq!(db.rollup_expired_alerts(cutoff, 2).unwrap(), batch(2, (0, 1)));
+    assert_eq!(db.rollup_expired_alerts(cutoff, 2).unwrap(), batch(2, (0, 2)));
+    assert_eq!(db.rollup_expired_alerts(cutoff, 2).unwrap(), batch(1, (0, 1)));
+    assert_eq!(db.rollup_expired_alerts(cutoff, 2).unwrap(), batch(0, (0, 0)));
+
+    let stats = db.stats().unwrap();
+    assert_eq!(stats.alert_count, 1);
+    assert!(stats.rollup_count >= 1);
+    assert!(stats.size_bytes > 0);
+}
+
+#[test]
+fn test_writer_batches_alerts() {
+    let dir = tempdir().unwrap();
+    let db_path = dir.path().join("test.db");
+    let db = Database::open(&db_path).unwrap();
+    db.init_schema().unwrap();
+
+    let writer = AlertWriter::spawn(Database::open(&db_path).unwrap()).unwrap();
+    let alerts: Vec<Alert> = (1..=50)
+        .map(|pid| Alert {
+            pid,
+            name: "stress".to_string(),
+            cmdline: "stress --cpu 4".to_string(),
+            reason: AlertReason::CpuHigh,
+            severity: Severity::Warning,
+            timestamp: 1_700_000_000,
+        })
+        .collect();
+    writer.submit(alerts[..20].to_vec());
+    writer.submit(alerts[20..].to_vec());
+    // Dropping the writer flushes the queue
+    drop(writer);
+
+    let stored = db.get_alerts(100, None).unwrap();
+    assert_eq!(stored.len(), 50);
+    assert_eq!(stored[0].timestamp, 1_700_000_000);
+
+    let conn = Connection::open(&db_path).unwrap();
+    let mode: String = conn.query_row("PRAGMA journal_mode", [], |row| row.get(0)).unwrap();
+    assert_eq!(mode, "wal");
+}
+
+#[test]
+fn test_resolve_all_alerts() {
+    let dir = tempdir().unwrap();
+    let db_path = dir.path().join("test.db");
+    let db = Database::open(&db_path).unwrap();
+    db.init_schema().unwrap();
+    db.insert_alert(1, "stress", "stress", "cpu_high", "warning").unwrap();
+    db.insert_alert(2, "stress", "stress", "cpu_high", "critical").unwrap();
+    db.insert_alert(3, "leaky", "leaky", "memory_leak", "critical").unwrap();
+    assert_eq!(db.unresolved_counts().unwrap(), (1, 2));
+
+    assert_eq!(db.resolve_all_alerts().unwrap(), 3);
+    assert_eq!(db.unresolved_counts().unwrap(), (0, 0));
+    // History is kept, only acknowledged
+    assert_eq!(db.get_alerts(10, None).unwrap().len(), 3);
+}
+
+#[tokio::test]
+async fn test_writer_clear_covers_queued_alerts() {
+    let dir = tempdir().unwrap();
+    let db_path = dir.path().join("test.db");
+    let db = Database::open(&db_path).unwrap();
+    db.init_schema().unwrap();
+
+    let writer = AlertWriter::spawn(Database::open(&db_path).unwrap()).unwrap();
+    let alerts: Vec<Alert> = (1..=10)
+        .map(|pid| Alert {
+            pid,
+            name: "stress".to_string(),
+            cmdline: "stress --cpu 4".to_string(),
+            reason: AlertReason::CpuHigh,
+            severity: Severity::Critical,
+            timestamp: 1_700_000_000,
+        })
+        .collect();
+    writer.submit(alerts);
+    // Queued behind the insert, so it resolves all of them
+    assert_eq!(writer.resolve_all().await.unwrap(), 10);
+    assert_eq!(db.unresolved_counts().unwrap(), (0, 0));
+}
@@ -1,10 +1,11 @@
 //! Integration tests for the RunawayGuard daemon
 
 use runaway_daemon::{
-    collector::{LinuxProcessCollector, ProcessCollector},
+    collector::{LinuxProcessCollector, ProcessCollector, ProcessInfo},
     config::Config,
     db::Database,
     detector::{AnomalyDetector, Detector},
+    whitelist::WhitelistMatcher,
 };
 use tempfile::TempDir;
 
@@ -104,9 +105,29 @@ fn test_detector_whitelist() {
     let mut detector = AnomalyDetector::new(config.detection);
     detector.add_whitelist("firefox".to_string());
 
-    assert!(detector.is_whitelisted("firefox"));
-    assert!(detector.is_whitelisted("firefox-esr"));
-    assert!(!detector.is_whitelisted("chrome"));
+    let process = |name: &str, cmdline: &str| ProcessInfo {
+        pid: 1,
+        name: name.to_string(),
+        cmdline: cmdline.to_string(),
+        cpu_percent: 0.0,
+        memory_mb: 0.0,
+        runtime_seconds: 0,
+        state: 'S',
+        start_time: 0,
+        start_ticks: 0,
+    };
+    assert!(detector.is_whitelisted(&process("firefox", "/usr/lib/firefox/firefox")));
+    // Names match exactly; use a cmdline or regex entry for families of processes
+    assert!(!detector.is_whitelisted(&process("firefox-esr", "/usr/lib/firefox-esr/firefox-esr")));
+    assert!(!detector.is_whitelisted(&process("chrome", "/opt/google/chrome/chrome")));
+
+    detector.set_whitelist(WhitelistMatcher::build([
+        ("firefox", "cmdline"),
+        ("^chrom(e|ium)$", "regex"),
+    ]));
+    assert!(detector.is_whitelisted(&process("firefox-esr", "/usr/lib/firefox-esr/firefox-esr")));
+    assert!(detector.is_whitelisted(&process("chromium", "")));
+    assert!(!detector.is_whitelisted(&process("chromedriver", "")));
 }
 
 /// Test adaptive sampling interval concept
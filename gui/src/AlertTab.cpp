@@ -1,4 +1,5 @@
 #include "AlertTab.h"
+#include "HeatMapDelegate.h"
 #include <QVBoxLayout>
 #include <QHeaderView>
 #include <QJsonObject>
@@ -11,6 +12,7 @@
 AlertTab::AlertTab(QWidget *parent)
     : QWidget(parent)
     , m_table(new QTableWidget(this))
+    , m_severityHeat(new HeatMapDelegate(this))
     , m_contextMenu(new QMenu(this))
     , m_searchEdit(new QLineEdit(this))
 {
@@ -41,6 +43,10 @@ void AlertTab::setupUi()
     m_table->verticalHeader()->setDefaultSectionSize(
         m_table->verticalHeader()->defaultSectionSize() + 4);
 
+    // Whole row shaded by severity
+    m_severityHeat->setRowSeverityColumn(4);
+    m_table->setItemDelegate(m_severityHeat);
+
     layout->addWidget(m_table);
 
     // Setup context menu
@@ -62,15 +68,16 @@ void AlertTab::updateAlertList(const QJsonArray &alerts)
 {
     m_table->setSortingEnabled(false);
 
-    // Deduplicate: keep only the latest alert per PID
-    // Alerts are sorted by timestamp desc, so first occurrence is the latest
-    QSet<int> seenPids;
+    // Deduplicate: keep only the latest alert per process
+    // Alerts are sorted by timestamp desc, so first occurrence is the latest.
+    // cgroup alerts all have PID 0 and are told apart by name (the cgroup)
+    QSet<QPair<int, QString>> seen;
     QVector<QJsonObject> dedupedAlerts;
     for (const auto &val : alerts) {
         QJsonObject alert = val.toObject();
-        int pid = alert["pid"].toInt();
-        if (!seenPids.contains(pid)) {
-            seenPids.insert(pid);
+        QPair<int, QString> key(alert["pid"].toInt(), alert["name"].toString());
+        if (!seen.contains(key)) {
+            seen.insert(key);
             dedupedAlerts.append(alert);
         }
     }
@@ -92,27 +99,6 @@ void AlertTab::updateAlertList(const QJsonArray &alerts)
         m_table->setItem(i, 2, new QTableWidgetItem(alert["name"].toString()));
         m_table->setItem(i, 3, new QTableWidgetItem(alert["reason"].toString()));
         m_table->setItem(i, 4, new QTableWidgetItem(alert["severity"].toString()));
-
-        // Apply severity-based coloring
-        QString severity = alert["severity"].toString().toLower();
-        QColor bgColor, textColor;
-        if (severity == "critical") {
-            bgColor = QColor(255, 200, 200);   // Light red background
-            textColor = QColor(150, 0, 0);     // Dark red text
-        } else if (severity == "warning") {
-            bgColor = QColor(255, 230, 200);   // Light orange background
-            textColor = QColor(150, 100, 0);   // Dark orange text
-        }
-
-        if (bgColor.isValid()) {
-            for (int col = 0; col < m_table->columnCount(); ++col) {
-                QTableWidgetItem *item = m_table->item(i, col);
-                if (item) {
-                    item->setBackground(bgColor);
-                    item->setForeground(textColor);
-                }
-            }
-        }
     }
     m_table->setSortingEnabled(true);
 
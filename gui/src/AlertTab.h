@@ -7,6 +7,8 @@
 #include <QMenu>
 #include <QLineEdit>
 
+class HeatMapDelegate;
+
 class AlertTab : public QWidget
 {
     Q_OBJECT
@@ -34,6 +36,7 @@ private:
     QString getSelectedName() const;
 
     QTableWidget *m_table;
+    HeatMapDelegate *m_severityHeat;
     QMenu *m_contextMenu;
     QLineEdit *m_searchEdit;
 };
@@ -17,10 +17,14 @@ DaemonClient::DaemonClient(QObject *parent)
     connect(m_reconnectTimer, &QTimer::timeout, this, &DaemonClient::tryReconnect);
 }
 
+QString DaemonClient::socketPath()
+{
+    return QString("/run/user/%1/runaway-guard.sock").arg(getuid());
+}
+
 void DaemonClient::connectToDaemon()
 {
-    QString socketPath = QString("/run/user/%1/runaway-guard.sock").arg(getuid());
-    m_socket->connectToServer(socketPath);
+    m_socket->connectToServer(socketPath());
 }
 
 bool DaemonClient::isConnected() const
@@ -118,10 +122,52 @@ void DaemonClient::requestClearAlerts()
     sendRequest(request);
 }
 
+void DaemonClient::requestStatus()
+{
+    sendRequest(QJsonObject{{"cmd", "get_status"}});
+}
+
+void DaemonClient::requestDbStats()
+{
+    sendRequest(QJsonObject{{"cmd", "get_db_stats"}});
+}
+
+void DaemonClient::requestCompactDatabase()
+{
+    sendRequest(QJsonObject{{"cmd", "compact_database"}});
+}
+
+void DaemonClient::requestMetrics()
+{
+    sendRequest(QJsonObject{{"cmd", "get_metrics"}});
+}
+
+void DaemonClient::requestProcessEvents(qint64 since)
+{
+    QJsonObject params;
+    params["since"] = since;
+    sendRequest(QJsonObject{{"cmd", "get_process_events"}, {"params", params}});
+}
+
+void DaemonClient::requestSystemStats(qint64 since)
+{
+    QJsonObject params;
+    params["since"] = since;
+    sendRequest(QJsonObject{{"cmd", "get_system_stats"}, {"params", params}});
+}
+
+void DaemonClient::requestProcessDetails(int pid)
+{
+    QJsonObject params;
+    params["pid"] = pid;
+    sendRequest(QJsonObject{{"cmd", "process_details"}, {"params", params}});
+}
+
 void DaemonClient::onConnected()
 {
     m_reconnectAttempts = 0;
     m_reconnectTimer->stop();
+    m_processSnapshotSeq = -1;  // A restarted daemon numbers scans from 1 again
     emit connected();
 }
 
@@ -148,6 +194,9 @@ void DaemonClient::onReadyRead()
             QString type = obj["type"].toString();
             if (type == "alert") {
                 emit alertReceived(obj["data"].toObject());
+            } else if (type == "alerts_batch") {
+                // All alerts raised during one monitoring tick
+                emit alertsBatchReceived(obj["data"].toObject()["alerts"].toArray());
             } else if (type == "status") {
                 emit statusReceived(obj["data"].toObject());
             } else if (type == "response") {
@@ -157,10 +206,7 @@ void DaemonClient::onReadyRead()
                     QJsonArray arr = data.toArray();
                     if (!arr.isEmpty()) {
                         QJsonObject first = arr[0].toObject();
-                        if (first.contains("cpu_percent")) {
-                            // Process list response
-                            emit processListReceived(arr);
-                        } else if (first.contains("pattern") && first.contains("match_type")) {
+                        if (first.contains("pattern") && first.contains("match_type")) {
                             // Whitelist response (check before alert since whitelist also has "reason" field)
                             emit whitelistReceived(arr);
                         } else if (first.contains("reason") && first.contains("timestamp")) {
@@ -174,6 +220,28 @@ void DaemonClient::onReadyRead()
                             emit whitelistReceived(arr);
                         }
                     }
+                } else if (data.toObject().contains("processes")) {
+                    // Process list from the daemon's last scan; the same seq
+                    // means nothing changed since the previous request
+                    QJsonObject snapshot = data.toObject();
+                    qint64 seq = snapshot["seq"].toInteger();
+                    if (seq != m_processSnapshotSeq) {
+                        m_processSnapshotSeq = seq;
+                        emit processListReceived(snapshot["processes"].toArray());
+                        // Empty when the daemon is not monitoring cgroups
+                        emit cgroupListReceived(snapshot["cgroups"].toArray());
+                    }
+                } else if (data.toObject().contains("db_size_bytes")) {
+                    emit dbStatsReceived(data.toObject());
+                } else if (data.toObject().contains("phases")) {
+                    emit metricsReceived(data.toObject());
+                } else if (data.toObject().contains("details")) {
+                    // Also when the process is gone ("details": null)
+                    emit processDetailsReceived(data.toObject());
+                } else if (data.toObject().contains("samples")) {
+                    emit systemStatsReceived(data.toObject());
+                } else if (data.toObject().contains("events")) {
+                    emit processEventsReceived(data.toObject());
                 }
                 emit responseReceived(obj);
             } else if (type == "config") {
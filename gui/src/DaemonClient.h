@@ -16,6 +16,7 @@ public:
     void sendRequest(const QJsonObject &request);
     bool isConnected() const;
     void setAutoReconnect(bool enabled);
+    static QString socketPath();
 
     // Convenience methods for common requests
     void requestProcessList();
@@ -31,17 +32,31 @@ public:
     void requestPauseMonitoring();
     void requestResumeMonitoring();
     void requestClearAlerts();
+    void requestStatus();
+    void requestDbStats();
+    void requestCompactDatabase();
+    void requestMetrics();
+    void requestProcessEvents(qint64 since);
+    void requestSystemStats(qint64 since);
+    void requestProcessDetails(int pid);
 
 signals:
     void connected();
     void disconnected();
     void alertReceived(const QJsonObject &alert);
+    void alertsBatchReceived(const QJsonArray &alerts);
     void statusReceived(const QJsonObject &status);
     void responseReceived(const QJsonObject &response);
     void processListReceived(const QJsonArray &processes);
+    void cgroupListReceived(const QJsonArray &cgroups);
     void alertListReceived(const QJsonArray &alerts);
     void whitelistReceived(const QJsonArray &whitelist);
     void configReceived(const QJsonObject &config);
+    void dbStatsReceived(const QJsonObject &stats);
+    void metricsReceived(const QJsonObject &metrics);
+    void processEventsReceived(const QJsonObject &events);
+    void systemStatsReceived(const QJsonObject &stats);
+    void processDetailsReceived(const QJsonObject &details);
 
 private slots:
     void onConnected();
@@ -56,6 +71,7 @@ private:
     QTimer *m_reconnectTimer;
     int m_reconnectAttempts;
     bool m_autoReconnect;
+    qint64 m_processSnapshotSeq = -1;
     static const int MAX_RECONNECT_ATTEMPTS = 10;
     static const int RECONNECT_INTERVAL_MS = 3000;
 };
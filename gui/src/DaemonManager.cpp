@@ -6,14 +6,55 @@
 #include <QDir>
 #include <QMessageBox>
 #include <QSettings>
+#include <QSocketNotifier>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <cerrno>
+#include <cstring>
 #include <unistd.h>
 
+namespace {
+
+// Field 22 of /proc/<pid>/stat (clock ticks after boot), or -1 if the
+// process does not exist. Fields are counted from the last ')' because the
+// command name may contain spaces and parentheses.
+qint64 processStartTime(qint64 pid)
+{
+    QFile file(QStringLiteral("/proc/%1/stat").arg(pid));
+    if (!file.open(QIODevice::ReadOnly)) return -1;
+    QByteArray stat = file.readAll();
+    int close = stat.lastIndexOf(')');
+    if (close < 0) return -1;
+    QList<QByteArray> fields = stat.mid(close + 1).simplified().split(' ');
+    // fields[0] is field 3 (state)
+    if (fields.size() < 20) return -1;
+    bool ok = false;
+    qint64 startTime = fields[19].toLongLong(&ok);
+    return ok ? startTime : -1;
+}
+
+int pidfdOpen(qint64 pid)
+{
+#ifdef SYS_pidfd_open
+    return int(::syscall(SYS_pidfd_open, pid_t(pid), 0));
+#else
+    Q_UNUSED(pid);
+    return -1;
+#endif
+}
+
+}
+
 DaemonManager::DaemonManager(QObject *parent)
     : QObject(parent)
     , m_client(new DaemonClient(this))
     , m_daemonProcess(nullptr)
     , m_reconnectTimer(new QTimer(this))
     , m_socketPollTimer(new QTimer(this))
+    , m_pidfd(-1)
+    , m_watchedPid(-1)
+    , m_pidfdNotifier(nullptr)
     , m_state(State::Unknown)
     , m_reconnectAttempts(0)
     , m_manageDaemonLifecycle(true)
@@ -59,6 +100,7 @@ void DaemonManager::shutdown()
 {
     m_reconnectTimer->stop();
     m_socketPollTimer->stop();
+    unwatchDaemonPid();
 
     // Read the latest setting from QSettings (user may have changed it during session)
     QSettings settings("RunawayGuard", "GUI");
@@ -140,11 +182,48 @@ QString DaemonManager::socketPath() const
     return QString("/run/user/%1/runaway-guard.sock").arg(getuid());
 }
 
+QString DaemonManager::pidFilePath() const
+{
+    return QString("/run/user/%1/runaway-guard.pid").arg(getuid());
+}
+
 bool DaemonManager::checkSocketExists() const
 {
     return QFile::exists(socketPath());
 }
 
+qint64 DaemonManager::runningPidFromFile() const
+{
+    QFile file(pidFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return -1;
+    const QList<QByteArray> fields = file.readAll().simplified().split(' ');
+    if (fields.size() < 2) return -1;
+    bool pidOk = false, startOk = false;
+    qint64 pid = fields[0].toLongLong(&pidOk);
+    qint64 startTime = fields[1].toLongLong(&startOk);
+    if (!pidOk || !startOk || pid <= 0) return -1;
+    // A different start time means the PID now belongs to another process
+    return processStartTime(pid) == startTime ? pid : -1;
+}
+
+bool DaemonManager::socketAcceptsConnections() const
+{
+    QByteArray path = QFile::encodeName(socketPath());
+    sockaddr_un addr{};
+    if (path.size() >= int(sizeof(addr.sun_path))) return false;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.constData(), path.size());
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    // A Unix socket connect completes or fails immediately; EAGAIN means a
+    // listener exists but its backlog is full
+    int result = ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    bool listening = result == 0 || errno == EAGAIN || errno == EINPROGRESS;
+    ::close(fd);
+    return listening;
+}
+
 bool DaemonManager::checkProcessRunning() const
 {
     // Check our managed process first
@@ -152,13 +231,53 @@ bool DaemonManager::checkProcessRunning() const
         return true;
     }
 
-    // Also check if any runaway-daemon process exists (could be externally started)
-    QProcess pgrep;
-    pgrep.start("pgrep", {"-x", "runaway-daemon"});
-    if (!pgrep.waitForFinished(1000)) {
-        return false;
+    // Externally started daemon (systemd unit, terminal)
+    if (runningPidFromFile() > 0) return true;
+
+    // No valid pidfile: a daemon from before pidfiles, or one that failed to
+    // write it. Only a socket nobody listens on is stale.
+    return checkSocketExists() && socketAcceptsConnections();
+}
+
+void DaemonManager::watchDaemonPid(qint64 pid)
+{
+    if (pid == m_watchedPid && m_pidfdNotifier) return;
+    unwatchDaemonPid();
+    // Our own child is already reported by QProcess::finished
+    if (m_daemonProcess && m_daemonProcess->processId() == pid) return;
+
+    qint64 startTime = processStartTime(pid);
+    int fd = pidfdOpen(pid);
+    if (fd < 0) return;
+    if (processStartTime(pid) != startTime) {
+        // Exited and reused between the check and the open
+        ::close(fd);
+        return;
     }
-    return pgrep.exitCode() == 0;
+    m_pidfd = fd;
+    m_watchedPid = pid;
+    // A pidfd turns readable when the process exits
+    m_pidfdNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(m_pidfdNotifier, &QSocketNotifier::activated, this, &DaemonManager::onWatchedDaemonExited);
+}
+
+void DaemonManager::unwatchDaemonPid()
+{
+    if (m_pidfdNotifier) {
+        m_pidfdNotifier->setEnabled(false);
+        m_pidfdNotifier->deleteLater();
+        m_pidfdNotifier = nullptr;
+    }
+    if (m_pidfd >= 0) {
+        ::close(m_pidfd);
+        m_pidfd = -1;
+    }
+    m_watchedPid = -1;
+}
+
+void DaemonManager::onWatchedDaemonExited()
+{
+    handleDaemonDeath();
 }
 
 bool DaemonManager::isDaemonRunning() const
@@ -172,19 +291,19 @@ void DaemonManager::tryConnect()
 {
     m_reconnectTimer->stop();
 
+    bool running = checkProcessRunning();
     if (checkSocketExists()) {
-        if (checkProcessRunning()) {
+        if (running) {
             // Socket exists AND daemon running - try to connect
             setState(State::Starting);
             m_client->connectToDaemon();
             // Result comes via onClientConnected/onClientDisconnected
         } else {
             // Stale socket (daemon not running) - remove it and start daemon
-            QString socketPath = QString("/run/user/%1/runaway-guard.sock").arg(getuid());
-            QFile::remove(socketPath);
+            QFile::remove(socketPath());
             startDaemon();
         }
-    } else if (checkProcessRunning()) {
+    } else if (running) {
         // Daemon running but socket not ready yet - poll for socket
         setState(State::Starting);
         m_socketPollTimer->start();
@@ -274,6 +393,7 @@ void DaemonManager::stopDaemon()
 {
     m_reconnectTimer->stop();
     m_socketPollTimer->stop();
+    unwatchDaemonPid();
 
     if (m_daemonProcess && m_daemonProcess->state() == QProcess::Running) {
         m_daemonProcess->terminate();
@@ -297,6 +417,8 @@ void DaemonManager::onClientConnected()
 {
     m_socketPollTimer->stop();
     m_reconnectAttempts = 0;
+    qint64 pid = runningPidFromFile();
+    if (pid > 0) watchDaemonPid(pid);
     setState(State::Running);
     emit connected();
     emit daemonStarted();
@@ -309,25 +431,36 @@ void DaemonManager::onClientDisconnected()
     if (m_state == State::Running) {
         // Was connected, now disconnected
         if (checkProcessRunning()) {
-            // Daemon still running - try reconnect
+            // Daemon still running - try reconnect. If it is on its way out
+            // the pidfd notifier cuts this short.
             scheduleReconnect();
         } else {
-            // Daemon crashed
-            setState(State::Stopped);
-            emit daemonCrashed();
-
-            // Auto-restart after brief cooldown
-            if (!isInCrashLoop()) {
-                QTimer::singleShot(2000, this, &DaemonManager::startDaemon);
-            } else {
-                m_lastError = tr("Daemon crashed repeatedly. Manual restart required.");
-                setState(State::Failed);
-                emit errorOccurred(m_lastError);
-            }
+            handleDaemonDeath();
         }
     }
 }
 
+void DaemonManager::handleDaemonDeath()
+{
+    // Both the pidfd and the socket report the same exit; act once
+    unwatchDaemonPid();
+    if (m_state != State::Running && m_state != State::Starting) return;
+
+    m_reconnectTimer->stop();
+    m_socketPollTimer->stop();
+    setState(State::Stopped);
+    emit daemonCrashed();
+
+    // Auto-restart after brief cooldown
+    if (!isInCrashLoop()) {
+        QTimer::singleShot(2000, this, &DaemonManager::startDaemon);
+    } else {
+        m_lastError = tr("Daemon crashed repeatedly. Manual restart required.");
+        setState(State::Failed);
+        emit errorOccurred(m_lastError);
+    }
+}
+
 void DaemonManager::scheduleReconnect()
 {
     m_reconnectAttempts++;
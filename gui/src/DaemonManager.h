@@ -8,6 +8,7 @@
 #include <QVector>
 
 class DaemonClient;
+class QSocketNotifier;
 
 class DaemonManager : public QObject
 {
@@ -60,21 +61,36 @@ private slots:
     void onProcessError(QProcess::ProcessError error);
     void tryConnect();
     void pollForSocket();
+    void onWatchedDaemonExited();
 
 private:
     QString findDaemonBinary() const;
     void setState(State state);
     bool checkSocketExists() const;
     bool checkProcessRunning() const;
+    // PID from the daemon's pidfile if that process is alive and is the one
+    // that wrote it (same /proc start time), else -1. Never blocks on a child.
+    qint64 runningPidFromFile() const;
+    // Non-blocking connect to the socket path; true if a daemon listens on it
+    bool socketAcceptsConnections() const;
+    // Get notified through a pidfd as soon as an externally started daemon
+    // exits; without pidfd_open (Linux < 5.3) the socket disconnect is used
+    void watchDaemonPid(qint64 pid);
+    void unwatchDaemonPid();
+    void handleDaemonDeath();
     void scheduleReconnect();
     void recordRestartAttempt();
     bool isInCrashLoop() const;
     QString socketPath() const;
+    QString pidFilePath() const;
 
     DaemonClient *m_client;
     QProcess *m_daemonProcess;
     QTimer *m_reconnectTimer;
     QTimer *m_socketPollTimer;
+    int m_pidfd;
+    qint64 m_watchedPid;
+    QSocketNotifier *m_pidfdNotifier;
 
     State m_state;
     QString m_lastError;
@@ -0,0 +1,210 @@
+#include "DiagnosticsDialog.h"
+#include "FormatUtils.h"
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QTimer>
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+
+namespace {
+
+const QColor CPU_COLOR(0x1f, 0x77, 0xb4);
+const QColor RSS_COLOR(0xd6, 0x27, 0x28);
+
+// Phases in the order the table lists them, with their labels
+const struct {
+    const char *key;
+    const char *label;
+} PHASES[] = {
+    {"tick", QT_TRANSLATE_NOOP("DiagnosticsDialog", "Whole tick")},
+    {"scan", QT_TRANSLATE_NOOP("DiagnosticsDialog", "Scan /proc")},
+    {"detect", QT_TRANSLATE_NOOP("DiagnosticsDialog", "Detect")},
+    {"alerts", QT_TRANSLATE_NOOP("DiagnosticsDialog", "Alerts")},
+    {"broadcast", QT_TRANSLATE_NOOP("DiagnosticsDialog", "Broadcast")},
+    {"db", QT_TRANSLATE_NOOP("DiagnosticsDialog", "Database write")},
+};
+
+QString formatMs(double ms)
+{
+    return ms < 10.0 ? QString::number(ms, 'f', 2) : QString::number(ms, 'f', 1);
+}
+
+// Headroom above the largest value so the line never touches the top
+double niceMax(const QVector<QPointF> &points, double floor)
+{
+    double max = floor;
+    for (const QPointF &p : points) max = std::max(max, p.y());
+    return max * 1.2;
+}
+
+}
+
+SelfUsageChart::SelfUsageChart(QWidget *parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(160);
+}
+
+void SelfUsageChart::setHistory(const QJsonArray &history, const QString &memoryKey)
+{
+    m_cpu.clear();
+    m_rss.clear();
+    if (history.isEmpty()) {
+        update();
+        return;
+    }
+    qint64 newest = history.last().toObject()["timestamp"].toInteger();
+    m_cpu.reserve(history.size());
+    m_rss.reserve(history.size());
+    for (const QJsonValue &value : history) {
+        QJsonObject sample = value.toObject();
+        double x = double(sample["timestamp"].toInteger() - newest);
+        m_cpu.append(QPointF(x, sample["cpu_percent"].toDouble()));
+        m_rss.append(QPointF(x, sample[memoryKey].toDouble()));
+    }
+    update();
+}
+
+void SelfUsageChart::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), palette().base());
+
+    const int margin = fontMetrics().horizontalAdvance("000.0 MB") + 6;
+    QRectF plot = QRectF(rect()).adjusted(margin, 8, -margin, -fontMetrics().height() - 6);
+    painter.setPen(palette().mid().color());
+    painter.drawRect(plot);
+
+    if (m_cpu.size() < 2) {
+        painter.setPen(palette().text().color());
+        painter.drawText(plot, Qt::AlignCenter, tr("Waiting for samples..."));
+        return;
+    }
+
+    double span = std::max(1.0, -m_cpu.first().x());
+    double cpuMax = niceMax(m_cpu, 1.0);
+    double rssMax = niceMax(m_rss, 1.0);
+
+    auto drawSeries = [&](const QVector<QPointF> &points, double yMax, const QColor &color) {
+        QPainterPath path;
+        for (int i = 0; i < points.size(); ++i) {
+            QPointF p(plot.right() + points[i].x() / span * plot.width(),
+                      plot.bottom() - points[i].y() / yMax * plot.height());
+            if (i == 0) path.moveTo(p); else path.lineTo(p);
+        }
+        painter.setPen(QPen(color, 1.5));
+        painter.drawPath(path);
+    };
+    drawSeries(m_cpu, cpuMax, CPU_COLOR);
+    drawSeries(m_rss, rssMax, RSS_COLOR);
+
+    // Axis labels: CPU on the left, RSS on the right, time along the bottom
+    QRectF left(0, plot.top(), margin - 4, plot.height());
+    QRectF right(plot.right() + 4, plot.top(), margin - 4, plot.height());
+    painter.setPen(CPU_COLOR);
+    painter.drawText(left, Qt::AlignRight | Qt::AlignTop, FormatUtils::formatCpu(cpuMax));
+    painter.drawText(left, Qt::AlignRight | Qt::AlignBottom, FormatUtils::formatCpu(0.0));
+    painter.setPen(RSS_COLOR);
+    painter.drawText(right, Qt::AlignLeft | Qt::AlignTop, FormatUtils::formatMemory(rssMax));
+    painter.drawText(right, Qt::AlignLeft | Qt::AlignBottom, FormatUtils::formatMemory(0.0));
+    painter.setPen(palette().text().color());
+    QRectF bottom(plot.left(), plot.bottom() + 2, plot.width(), fontMetrics().height() + 4);
+    painter.drawText(bottom, Qt::AlignLeft, tr("-%1").arg(FormatUtils::formatRuntime(qint64(span))));
+    painter.drawText(bottom, Qt::AlignRight, tr("now"));
+}
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_summaryLabel(new QLabel(this))
+    , m_phaseTable(new QTableWidget(this))
+    , m_chart(new SelfUsageChart(this))
+    , m_pollTimer(new QTimer(this))
+{
+    setWindowTitle(tr("Daemon Diagnostics"));
+    resize(620, 480);
+
+    auto *layout = new QVBoxLayout(this);
+    m_summaryLabel->setText(tr("Waiting for daemon..."));
+    m_summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(m_summaryLabel);
+
+    auto *legend = new QLabel(tr("<span style='color:%1'>&#9632;</span> CPU &nbsp; "
+                                 "<span style='color:%2'>&#9632;</span> Resident memory")
+                                  .arg(CPU_COLOR.name(), RSS_COLOR.name()), this);
+    layout->addWidget(legend);
+    layout->addWidget(m_chart, 1);
+
+    const int phaseCount = int(sizeof(PHASES) / sizeof(PHASES[0]));
+    m_phaseTable->setColumnCount(7);
+    m_phaseTable->setHorizontalHeaderLabels({tr("Phase"), tr("Count"), tr("Last (ms)"),
+                                             tr("p50 (ms)"), tr("p95 (ms)"), tr("p99 (ms)"), tr("Max (ms)")});
+    m_phaseTable->setRowCount(phaseCount);
+    for (int row = 0; row < phaseCount; ++row) {
+        m_phaseTable->setItem(row, 0, new QTableWidgetItem(tr(PHASES[row].label)));
+        for (int col = 1; col < 7; ++col) {
+            auto *item = new QTableWidgetItem("-");
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_phaseTable->setItem(row, col, item);
+        }
+    }
+    m_phaseTable->verticalHeader()->setVisible(false);
+    m_phaseTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_phaseTable->setSelectionMode(QAbstractItemView::NoSelection);
+    m_phaseTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_phaseTable->setToolTip(tr("Percentiles over the last 512 samples of each phase"));
+    layout->addWidget(m_phaseTable);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    m_pollTimer->setInterval(POLL_INTERVAL_MS);
+    connect(m_pollTimer, &QTimer::timeout, this, &DiagnosticsDialog::metricsRequested);
+}
+
+void DiagnosticsDialog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    emit metricsRequested();
+    m_pollTimer->start();
+}
+
+void DiagnosticsDialog::hideEvent(QHideEvent *event)
+{
+    m_pollTimer->stop();
+    QDialog::hideEvent(event);
+}
+
+void DiagnosticsDialog::updateMetrics(const QJsonObject &metrics)
+{
+    m_summaryLabel->setText(tr("CPU %1 now, %2 average over %3 · Resident memory %4")
+        .arg(FormatUtils::formatCpu(metrics["cpu_percent"].toDouble()),
+             FormatUtils::formatCpu(metrics["cpu_percent_avg"].toDouble()),
+             FormatUtils::formatRuntime(metrics["uptime_seconds"].toInteger()),
+             FormatUtils::formatMemory(metrics["rss_mb"].toDouble())));
+
+    const int phaseCount = int(sizeof(PHASES) / sizeof(PHASES[0]));
+    for (const QJsonValue &value : metrics["phases"].toArray()) {
+        QJsonObject phase = value.toObject();
+        QString key = phase["phase"].toString();
+        for (int row = 0; row < phaseCount; ++row) {
+            if (key != QLatin1String(PHASES[row].key)) continue;
+            m_phaseTable->item(row, 1)->setText(QString::number(phase["count"].toInteger()));
+            bool sampled = phase["count"].toInteger() > 0;
+            const char *fields[] = {"last_ms", "p50_ms", "p95_ms", "p99_ms", "max_ms"};
+            for (int i = 0; i < 5; ++i) {
+                m_phaseTable->item(row, i + 2)->setText(sampled ? formatMs(phase[fields[i]].toDouble()) : "-");
+            }
+            break;
+        }
+    }
+
+    m_chart->setHistory(metrics["history"].toArray());
+}
@@ -0,0 +1,62 @@
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QVector>
+#include <QPointF>
+
+class QLabel;
+class QTableWidget;
+class QTimer;
+
+// Line chart of CPU (left axis) and RSS (right axis) over a short history:
+// the daemon's own from get_metrics, or one process's from process_details
+class SelfUsageChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SelfUsageChart(QWidget *parent = nullptr);
+    // Samples with "timestamp", "cpu_percent" and the memory in MB under memoryKey
+    void setHistory(const QJsonArray &history, const QString &memoryKey = QStringLiteral("rss_mb"));
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    // x: seconds before the newest sample (negative), y: value
+    QVector<QPointF> m_cpu;
+    QVector<QPointF> m_rss;
+};
+
+// What the daemon costs to run: its CPU and memory, and how long each phase
+// of a monitoring tick takes (p50/p95/p99 over the last few hundred ticks).
+// Polls get_metrics while it is open.
+class DiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsDialog(QWidget *parent = nullptr);
+
+signals:
+    void metricsRequested();
+
+public slots:
+    void updateMetrics(const QJsonObject &metrics);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    QLabel *m_summaryLabel;
+    QTableWidget *m_phaseTable;
+    SelfUsageChart *m_chart;
+    QTimer *m_pollTimer;
+    static const int POLL_INTERVAL_MS = 2000;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "ExportWorker.h"
+#include "DaemonClient.h"
+#include <QLocalSocket>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QDateTime>
+
+ExportWorker::ExportWorker(Kind kind, Format format, const QString &filePath,
+                           qint64 fromSecs, qint64 toSecs, QObject *parent)
+    : QObject(parent)
+    , m_kind(kind)
+    , m_format(format)
+    , m_filePath(filePath)
+    , m_fromSecs(fromSecs)
+    , m_toSecs(toSecs)
+    , m_cancelled(0)
+{
+}
+
+void ExportWorker::cancel()
+{
+    m_cancelled.storeRelaxed(1);
+}
+
+ExportWorker::Format ExportWorker::formatForPath(const QString &filePath)
+{
+    if (filePath.endsWith(".ndjson", Qt::CaseInsensitive) || filePath.endsWith(".jsonl", Qt::CaseInsensitive)) {
+        return Format::Ndjson;
+    }
+    return Format::Csv;
+}
+
+void ExportWorker::run()
+{
+    // Socket lives on the worker thread, separate from the GUI's DaemonClient
+    QLocalSocket socket;
+    socket.connectToServer(DaemonClient::socketPath());
+    if (!socket.waitForConnected(IO_TIMEOUT_MS)) {
+        emit finished(false, tr("Cannot connect to daemon: %1").arg(socket.errorString()));
+        return;
+    }
+
+    // QSaveFile only replaces the target on commit, so a failed or cancelled
+    // export never leaves a truncated file behind
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        emit finished(false, tr("Cannot open %1: %2").arg(m_filePath, file.errorString()));
+        return;
+    }
+
+    const QStringList columns = m_kind == Kind::Alerts
+        ? QStringList{"id", "timestamp", "pid", "name", "reason", "severity", "cmdline"}
+        : QStringList{"pid", "name", "cpu_percent", "memory_mb", "runtime_seconds", "state",
+                      "leak_rate_mb_per_min", "cmdline"};
+    writeHeader(file, columns);
+
+    qint64 written = 0;
+    QString error;
+    QJsonArray rows;
+
+    if (m_kind == Kind::Processes) {
+        if (!fetchPage(socket, QJsonObject{{"cmd", "list_processes"}}, rows, error)) {
+            file.cancelWriting();
+            emit finished(false, error);
+            return;
+        }
+        for (const auto &val : rows) {
+            writeRow(file, columns, val.toObject());
+        }
+        written = rows.size();
+    } else {
+        qint64 beforeId = -1;
+        while (!m_cancelled.loadRelaxed()) {
+            QJsonObject params{{"limit", PAGE_SIZE}};
+            if (m_fromSecs > 0) params["from"] = m_fromSecs;
+            if (m_toSecs > 0) params["to"] = m_toSecs;
+            if (beforeId >= 0) params["before_id"] = beforeId;
+
+            if (!fetchPage(socket, QJsonObject{{"cmd", "get_alerts"}, {"params", params}}, rows, error)) {
+                file.cancelWriting();
+                emit finished(false, error);
+                return;
+            }
+            for (const auto &val : rows) {
+                QJsonObject alert = val.toObject();
+                alert["timestamp"] = QDateTime::fromSecsSinceEpoch(alert["timestamp"].toInteger())
+                    .toString(Qt::ISODate);
+                writeRow(file, columns, alert);
+            }
+            written += rows.size();
+            emit progress(written);
+
+            if (rows.size() < PAGE_SIZE) break;
+            beforeId = rows.last().toObject()["id"].toInteger();
+        }
+    }
+
+    if (m_cancelled.loadRelaxed()) {
+        file.cancelWriting();
+        emit finished(false, tr("Export cancelled"));
+        return;
+    }
+    if (!file.commit()) {
+        emit finished(false, tr("Failed to write %1: %2").arg(m_filePath, file.errorString()));
+        return;
+    }
+    emit progress(written);
+    emit finished(true, tr("Exported %1 rows to %2").arg(written).arg(m_filePath));
+}
+
+bool ExportWorker::fetchPage(QLocalSocket &socket, const QJsonObject &request, QJsonArray &rows, QString &error)
+{
+    socket.write(QJsonDocument(request).toJson(QJsonDocument::Compact) + "\n");
+    if (!socket.waitForBytesWritten(IO_TIMEOUT_MS)) {
+        error = tr("Failed to send request: %1").arg(socket.errorString());
+        return false;
+    }
+
+    // Broadcast frames (status, alerts) share the connection; skip until the reply
+    while (true) {
+        int newlinePos;
+        while ((newlinePos = m_buffer.indexOf('\n')) < 0) {
+            if (m_cancelled.loadRelaxed()) {
+                error = tr("Export cancelled");
+                return false;
+            }
+            if (!socket.waitForReadyRead(IO_TIMEOUT_MS)) {
+                error = tr("Daemon did not respond: %1").arg(socket.errorString());
+                return false;
+            }
+            m_buffer.append(socket.readAll());
+        }
+        QByteArray line = m_buffer.left(newlinePos);
+        m_buffer.remove(0, newlinePos + 1);
+
+        QJsonObject obj = QJsonDocument::fromJson(line).object();
+        if (obj["type"].toString() != "response") continue;
+
+        QJsonValue data = obj["data"];
+        if (data.isObject() && data.toObject().contains("error")) {
+            error = data.toObject()["error"].toString();
+            return false;
+        }
+        // list_processes wraps its rows with the snapshot's seq and age
+        rows = data.isObject() ? data.toObject()["processes"].toArray() : data.toArray();
+        return true;
+    }
+}
+
+void ExportWorker::writeHeader(QIODevice &out, const QStringList &columns)
+{
+    if (m_format == Format::Csv) {
+        out.write(columns.join(',').toUtf8() + "\n");
+    }
+}
+
+void ExportWorker::writeRow(QIODevice &out, const QStringList &columns, const QJsonObject &row)
+{
+    if (m_format == Format::Ndjson) {
+        QJsonObject obj;
+        for (const auto &column : columns) {
+            obj[column] = row[column];
+        }
+        out.write(QJsonDocument(obj).toJson(QJsonDocument::Compact) + "\n");
+        return;
+    }
+
+    QByteArray line;
+    for (int i = 0; i < columns.size(); ++i) {
+        if (i > 0) line.append(',');
+        QJsonValue value = row[columns[i]];
+        line.append(csvField(value.isDouble() ? QString::number(value.toDouble(), 'g', 15) : value.toString()));
+    }
+    line.append('\n');
+    out.write(line);
+}
+
+QByteArray ExportWorker::csvField(const QString &value)
+{
+    QByteArray field = value.toUtf8();
+    if (field.contains(',') || field.contains('"') || field.contains('\n') || field.contains('\r')) {
+        field.replace("\"", "\"\"");
+        return "\"" + field + "\"";
+    }
+    return field;
+}
@@ -0,0 +1,56 @@
+#ifndef EXPORTWORKER_H
+#define EXPORTWORKER_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QAtomicInt>
+
+class QLocalSocket;
+class QIODevice;
+
+// Streams alert history or the process snapshot from the daemon to a file.
+// Runs on its own thread with its own socket; rows are fetched in pages of
+// PAGE_SIZE and written out immediately, so memory stays bounded by one page.
+class ExportWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Kind { Alerts, Processes };
+    enum class Format { Csv, Ndjson };
+
+    ExportWorker(Kind kind, Format format, const QString &filePath,
+                 qint64 fromSecs = 0, qint64 toSecs = 0, QObject *parent = nullptr);
+
+    // Thread-safe; the export stops after the current page
+    void cancel();
+
+    static Format formatForPath(const QString &filePath);
+
+public slots:
+    void run();
+
+signals:
+    void progress(qint64 rowsWritten);
+    void finished(bool success, const QString &message);
+
+private:
+    bool fetchPage(QLocalSocket &socket, const QJsonObject &request, QJsonArray &rows, QString &error);
+    void writeHeader(QIODevice &out, const QStringList &columns);
+    void writeRow(QIODevice &out, const QStringList &columns, const QJsonObject &row);
+    static QByteArray csvField(const QString &value);
+
+    Kind m_kind;
+    Format m_format;
+    QString m_filePath;
+    qint64 m_fromSecs;
+    qint64 m_toSecs;
+    QAtomicInt m_cancelled;
+    QByteArray m_buffer;
+
+    static const int PAGE_SIZE = 1000;
+    static const int IO_TIMEOUT_MS = 10000;
+};
+
+#endif
@@ -1,5 +1,4 @@
 #include "FormatUtils.h"
-#include <QColor>
 
 namespace FormatUtils {
 
@@ -36,6 +35,14 @@ QString formatCpu(double percent)
     return QString("%1%").arg(percent, 0, 'f', 1);
 }
 
+QString formatLeakRate(double mbPerMinute)
+{
+    if (qAbs(mbPerMinute) < 0.05) {
+        return QStringLiteral("0 MB/min");
+    }
+    return QString("%1%2 MB/min").arg(mbPerMinute > 0 ? "+" : "").arg(mbPerMinute, 0, 'f', 1);
+}
+
 QString getNumericTooltip(double cpu, double memoryMb, qint64 runtimeSeconds)
 {
     return QString("CPU: %1%, Memory: %2 MB, Runtime: %3 seconds")
@@ -44,41 +51,4 @@ QString getNumericTooltip(double cpu, double memoryMb, qint64 runtimeSeconds)
         .arg(runtimeSeconds);
 }
 
-QColor getCpuBackgroundColor(double percent)
-{
-    if (percent > 90.0) {
-        return QColor(255, 200, 200);  // Light red
-    } else if (percent > 80.0) {
-        return QColor(255, 230, 200);  // Light orange
-    }
-    return QColor();  // Transparent/default
-}
-
-QColor getMemoryBackgroundColor(double megabytes)
-{
-    if (megabytes > 4096.0) {
-        return QColor(255, 200, 200);  // Light red
-    } else if (megabytes > 1024.0) {
-        return QColor(255, 230, 200);  // Light orange
-    }
-    return QColor();
-}
-
-QColor getStateBackgroundColor(const QString &state)
-{
-    if (state == "D" || state == "Z") {
-        return QColor(255, 200, 200);  // Light red
-    }
-    return QColor();
-}
-
-QColor getTextColorForBackground(const QColor &bg)
-{
-    if (!bg.isValid() || bg.alpha() == 0) {
-        return QColor();  // Default text color
-    }
-    // Darker version of background for text
-    return bg.darker(200);
-}
-
 }
@@ -1,7 +1,6 @@
 #ifndef FORMATUTILS_H
 #define FORMATUTILS_H
 
-#include <QColor>
 #include <QString>
 
 namespace FormatUtils {
@@ -17,24 +16,12 @@ QString formatMemory(double megabytes);
 // Format CPU percentage with 1 decimal
 QString formatCpu(double percent);
 
+// Format memory growth rate: "+12.3 MB/min", "-0.4 MB/min"; "0 MB/min" when negligible
+QString formatLeakRate(double mbPerMinute);
+
 // Get precise tooltip for numeric values
 QString getNumericTooltip(double cpu, double memoryMb, qint64 runtimeSeconds);
 
-// Get background color for CPU value
-// < 80%: transparent, 80-90%: light orange, > 90%: light red
-QColor getCpuBackgroundColor(double percent);
-
-// Get background color for memory value
-// < 1GB: transparent, 1-4GB: light orange, > 4GB: light red
-QColor getMemoryBackgroundColor(double megabytes);
-
-// Get background color for process state
-// R/S: transparent, D/Z: light red
-QColor getStateBackgroundColor(const QString &state);
-
-// Get text color (darker version for contrast)
-QColor getTextColorForBackground(const QColor &bg);
-
 }
 
 #endif
@@ -0,0 +1,104 @@
+#include "HeatMapDelegate.h"
+#include <QPalette>
+#include <QStyleOptionViewItem>
+#include <algorithm>
+
+namespace {
+
+// Gradient stops: fades in to light orange at the midpoint, then to light red
+const QColor WARM(255, 230, 200);
+const QColor HOT(255, 200, 200);
+
+QColor mix(const QColor &a, const QColor &b, double t)
+{
+    return QColor::fromRgbF(a.redF() + (b.redF() - a.redF()) * t,
+                            a.greenF() + (b.greenF() - a.greenF()) * t,
+                            a.blueF() + (b.blueF() - a.blueF()) * t);
+}
+
+} // namespace
+
+HeatMapDelegate::HeatMapDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+    m_background.reserve(LUT_SIZE);
+    m_text.reserve(LUT_SIZE);
+    for (int i = 0; i < LUT_SIZE; ++i) {
+        double t = double(i) / (LUT_SIZE - 1);
+        QColor color = t <= 0.5 ? WARM : mix(WARM, HOT, (t - 0.5) * 2.0);
+        double alpha = std::min(1.0, t * 2.0);
+        // Text darkens with the background once the tint is strong enough to matter
+        m_text.append(alpha >= 0.5 ? color.darker(200) : QColor());
+        color.setAlphaF(alpha);
+        m_background.append(i == 0 ? QBrush() : QBrush(color));
+    }
+    setThresholds(90, 500, 5);  // Daemon defaults until the config arrives
+}
+
+void HeatMapDelegate::setColumnScale(int column, Scale scale)
+{
+    m_scales.insert(column, scale);
+}
+
+void HeatMapDelegate::setRowSeverityColumn(int column)
+{
+    m_severityColumn = column;
+}
+
+void HeatMapDelegate::setThresholds(double cpuPercent, double growthMb, double windowMinutes)
+{
+    m_cpuStart = cpuPercent * 0.5;
+    m_cpuEnd = cpuPercent;
+    m_memoryStart = growthMb * 2.0;
+    m_memoryEnd = growthMb * 8.0;
+    double leakRate = windowMinutes > 0 ? growthMb / windowMinutes : growthMb;
+    m_leakStart = leakRate * 0.5;
+    m_leakEnd = leakRate;
+}
+
+int HeatMapDelegate::ramp(double value, double start, double end)
+{
+    if (value <= start) return 0;
+    if (value >= end || end <= start) return LUT_SIZE - 1;
+    return int((value - start) / (end - start) * (LUT_SIZE - 1));
+}
+
+int HeatMapDelegate::entryFor(Scale scale, const QModelIndex &index) const
+{
+    switch (scale) {
+    case Scale::Cpu:
+        return ramp(index.data(Qt::UserRole).toDouble(), m_cpuStart, m_cpuEnd);
+    case Scale::Memory:
+        return ramp(index.data(Qt::UserRole).toDouble(), m_memoryStart, m_memoryEnd);
+    case Scale::LeakRate:
+        return ramp(index.data(Qt::UserRole).toDouble(), m_leakStart, m_leakEnd);
+    case Scale::State: {
+        QString state = index.data().toString();
+        return state == QLatin1String("D") || state == QLatin1String("Z") ? LUT_SIZE - 1 : 0;
+    }
+    case Scale::Severity: {
+        QString severity = index.data().toString();
+        if (severity.compare(QLatin1String("critical"), Qt::CaseInsensitive) == 0) return LUT_SIZE - 1;
+        if (severity.compare(QLatin1String("warning"), Qt::CaseInsensitive) == 0) return LUT_SIZE / 2;
+        return 0;
+    }
+    case Scale::None:
+        break;
+    }
+    return 0;
+}
+
+void HeatMapDelegate::initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const
+{
+    QStyledItemDelegate::initStyleOption(option, index);
+
+    int entry = m_severityColumn >= 0
+        ? entryFor(Scale::Severity, index.siblingAtColumn(m_severityColumn))
+        : entryFor(m_scales.value(index.column(), Scale::None), index);
+    if (entry <= 0) return;
+
+    option->backgroundBrush = m_background[entry];
+    if (m_text[entry].isValid()) {
+        option->palette.setColor(QPalette::Text, m_text[entry]);
+    }
+}
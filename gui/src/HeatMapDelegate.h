@@ -0,0 +1,56 @@
+#ifndef HEATMAPDELEGATE_H
+#define HEATMAPDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QBrush>
+#include <QColor>
+#include <QHash>
+#include <QVector>
+
+// Paints cell backgrounds from a color table built once, so views store no
+// brushes and refreshes compute no colors. Numeric columns read their value
+// from Qt::UserRole and shade continuously between a start and end value
+// derived from the detector's thresholds; state and severity columns pick a
+// fixed entry.
+class HeatMapDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    enum class Scale {
+        None,
+        Cpu,        // percent; from half the CPU threshold, full at the threshold
+        Memory,     // MB; from 2x the leak growth threshold, full at 8x
+        LeakRate,   // MB/min; from half the leak threshold rate, full at it
+        State,      // process state letter; D and Z are full
+        Severity,   // alert severity; warning is half, critical full
+    };
+
+    explicit HeatMapDelegate(QObject *parent = nullptr);
+
+    void setColumnScale(int column, Scale scale);
+    // Shade every column of a row by the severity in this column
+    void setRowSeverityColumn(int column);
+    // Detector thresholds, as in the daemon's [detection] config
+    void setThresholds(double cpuPercent, double growthMb, double windowMinutes);
+
+protected:
+    void initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const override;
+
+private:
+    int entryFor(Scale scale, const QModelIndex &index) const;
+    static int ramp(double value, double start, double end);
+
+    static const int LUT_SIZE = 64;
+    QVector<QBrush> m_background;
+    // Invalid where the background is too faint to need darker text
+    QVector<QColor> m_text;
+
+    QHash<int, Scale> m_scales;
+    int m_severityColumn = -1;
+    double m_cpuStart, m_cpuEnd;
+    double m_memoryStart, m_memoryEnd;
+    double m_leakStart, m_leakEnd;
+};
+
+#endif
@@ -1,34 +1,64 @@
 #include "MainWindow.h"
 #include "ProcessTab.h"
+#include "PerformanceTab.h"
 #include "AlertTab.h"
 #include "WhitelistTab.h"
 #include "SettingsTab.h"
 #include "DaemonManager.h"
 #include "DaemonClient.h"
 #include "TrayIcon.h"
+#include "ExportWorker.h"
+#include "DiagnosticsDialog.h"
+#include "ProcessDetailsDialog.h"
 #include <QStatusBar>
 #include <QCloseEvent>
+#include <QShowEvent>
+#include <QHideEvent>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QMessageBox>
 #include <QSettings>
 #include <QStyle>
 #include <QIcon>
+#include <QApplication>
+#include <QMenuBar>
+#include <QFileDialog>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QDateTimeEdit>
+#include <QProgressDialog>
+#include <QProgressBar>
+#include <QThread>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_tabWidget(new QTabWidget(this))
     , m_processTab(new ProcessTab(this))
+    , m_performanceTab(new PerformanceTab(this))
     , m_alertTab(new AlertTab(this))
     , m_whitelistTab(new WhitelistTab(this))
     , m_settingsTab(new SettingsTab(this))
     , m_daemonManager(new DaemonManager(this))
     , m_trayIcon(nullptr)
     , m_refreshTimer(new QTimer(this))
+    , m_liveAction(nullptr)
+    , m_samplingMode("normal")
+    , m_sampleIntervalSecs(10)
+    , m_fastIntervalSecs(2)
     , m_statusLabel(new QLabel(this))
     , m_processCountLabel(new QLabel(this))
     , m_alertCountLabel(new QLabel(this))
+    , m_pressureBar(new QProgressBar(this))
+    , m_notificationMethod("both")
+    , m_exportThread(nullptr)
+    , m_exportWorker(nullptr)
+    , m_exportProgress(nullptr)
+    , m_diagnosticsDialog(nullptr)
+    , m_detailsDialog(nullptr)
 {
     setupUi();
+    setupMenuBar();
     setupStatusBar();
     setupConnections();
     setupTrayIcon();
@@ -43,14 +73,19 @@ MainWindow::MainWindow(QWidget *parent)
     m_statusLabel->setText(tr("Starting daemon..."));
     m_daemonManager->initialize();
 
-    // Start refresh timer (10 seconds)
-    m_refreshTimer->setInterval(10000);
+    // Follows the daemon's sampling interval once status frames arrive
+    applyRefreshInterval();
     connect(m_refreshTimer, &QTimer::timeout, this, &MainWindow::refreshData);
 }
 
 MainWindow::~MainWindow()
 {
     saveWindowState();
+    if (m_exportThread) {
+        m_exportWorker->cancel();
+        m_exportThread->quit();
+        m_exportThread->wait();
+    }
 }
 
 DaemonClient* MainWindow::client() const
@@ -74,8 +109,18 @@ void MainWindow::setupUi()
         appStyle->standardIcon(QStyle::SP_FileDialogListView));
     QIcon settingsIcon = QIcon::fromTheme("preferences-system",
         appStyle->standardIcon(QStyle::SP_DialogApplyButton));
+    QIcon performanceIcon = QIcon::fromTheme("office-chart-line",
+        appStyle->standardIcon(QStyle::SP_FileDialogDetailedView));
+
+    // Object names are the stable keys the current tab is saved under
+    m_processTab->setObjectName("monitor");
+    m_performanceTab->setObjectName("performance");
+    m_alertTab->setObjectName("alerts");
+    m_whitelistTab->setObjectName("whitelist");
+    m_settingsTab->setObjectName("settings");
 
     m_tabWidget->addTab(m_processTab, monitorIcon, tr("Monitor"));
+    m_tabWidget->addTab(m_performanceTab, performanceIcon, tr("Performance"));
     m_tabWidget->addTab(m_alertTab, alertIcon, tr("Alerts"));
     m_tabWidget->addTab(m_whitelistTab, whitelistIcon, tr("Whitelist"));
     m_tabWidget->addTab(m_settingsTab, settingsIcon, tr("Settings"));
@@ -83,6 +128,27 @@ void MainWindow::setupUi()
     setCentralWidget(m_tabWidget);
 }
 
+void MainWindow::setupMenuBar()
+{
+    QMenu *fileMenu = menuBar()->addMenu(tr("&File"));
+    QMenu *exportMenu = fileMenu->addMenu(tr("&Export"));
+    exportMenu->addAction(tr("Alert History..."), this, &MainWindow::onExportAlerts);
+    exportMenu->addAction(tr("Process Snapshot..."), this, &MainWindow::onExportProcesses);
+    fileMenu->addSeparator();
+    QAction *quitAction = fileMenu->addAction(tr("&Quit"), qApp, &QApplication::quit);
+    quitAction->setShortcut(QKeySequence::Quit);
+
+    QMenu *viewMenu = menuBar()->addMenu(tr("&View"));
+    m_liveAction = viewMenu->addAction(tr("&Live Updates"));
+    m_liveAction->setCheckable(true);
+    m_liveAction->setToolTip(tr("Refresh at the daemon's fast sampling interval even when nothing is alerting"));
+    m_liveAction->setChecked(QSettings("RunawayGuard", "GUI").value("liveRefresh", false).toBool());
+    connect(m_liveAction, &QAction::toggled, this, &MainWindow::setLiveRefresh);
+
+    QMenu *toolsMenu = menuBar()->addMenu(tr("&Tools"));
+    toolsMenu->addAction(tr("Daemon &Diagnostics..."), this, &MainWindow::onShowDiagnostics);
+}
+
 void MainWindow::setupConnections()
 {
     // DaemonManager connections
@@ -95,13 +161,20 @@ void MainWindow::setupConnections()
     DaemonClient *daemonClient = m_daemonManager->client();
     connect(daemonClient, &DaemonClient::statusReceived, this, &MainWindow::onStatusReceived);
     connect(daemonClient, &DaemonClient::alertReceived, this, &MainWindow::onAlertReceived);
+    connect(daemonClient, &DaemonClient::alertsBatchReceived, this, &MainWindow::onAlertsBatchReceived);
+    connect(daemonClient, &DaemonClient::configReceived, this, &MainWindow::onConfigReceived);
     connect(daemonClient, &DaemonClient::processListReceived, m_processTab, &ProcessTab::updateProcessList);
+    connect(daemonClient, &DaemonClient::cgroupListReceived, m_processTab, &ProcessTab::updateCgroupList);
+    connect(daemonClient, &DaemonClient::processListReceived, m_whitelistTab, &WhitelistTab::setProcessSnapshot);
+    connect(daemonClient, &DaemonClient::processEventsReceived, m_processTab, &ProcessTab::appendProcessEvents);
+    connect(daemonClient, &DaemonClient::systemStatsReceived, m_performanceTab, &PerformanceTab::appendSamples);
     connect(daemonClient, &DaemonClient::alertListReceived, m_alertTab, &AlertTab::updateAlertList);
     connect(daemonClient, &DaemonClient::whitelistReceived, m_whitelistTab, &WhitelistTab::updateWhitelistDisplay);
 
     // ProcessTab actions
     connect(m_processTab, &ProcessTab::killProcessRequested, daemonClient, &DaemonClient::requestKillProcess);
     connect(m_processTab, &ProcessTab::addWhitelistRequested, daemonClient, &DaemonClient::requestAddWhitelist);
+    connect(m_processTab, &ProcessTab::processDetailsRequested, this, &MainWindow::onShowProcessDetails);
 
     // WhitelistTab actions
     connect(m_whitelistTab, &WhitelistTab::addWhitelistRequested, daemonClient, &DaemonClient::requestAddWhitelist);
@@ -113,7 +186,19 @@ void MainWindow::setupConnections()
 
     // SettingsTab connections
     connect(daemonClient, &DaemonClient::configReceived, m_settingsTab, &SettingsTab::loadConfig);
+    connect(daemonClient, &DaemonClient::configReceived, m_processTab, &ProcessTab::setDetectionThresholds);
+    connect(m_settingsTab, &SettingsTab::configUpdateRequested, m_processTab, &ProcessTab::setDetectionThresholds);
     connect(m_settingsTab, &SettingsTab::configUpdateRequested, daemonClient, &DaemonClient::requestUpdateConfig);
+    connect(daemonClient, &DaemonClient::dbStatsReceived, m_settingsTab, &SettingsTab::updateDbStats);
+    // Inactive tabs are not polled; catch up when one is brought forward
+    connect(m_tabWidget, &QTabWidget::currentChanged, this, [this]() {
+        applyRefreshInterval();
+        refreshData();
+    });
+    connect(m_settingsTab, &SettingsTab::compactDatabaseRequested, this, [this]() {
+        m_daemonManager->client()->requestCompactDatabase();
+        showStatusMessage(tr("Database compaction started"));
+    });
 
     // TrayIcon actions (connected in setupTrayIcon after m_trayIcon is created)
 }
@@ -124,7 +209,16 @@ void MainWindow::setupStatusBar()
     m_processCountLabel->setText(tr("Processes: -"));
     m_alertCountLabel->setText(tr("Alerts: -"));
 
+    // Worst of CPU/memory/IO stall share over the last 10 s
+    m_pressureBar->setRange(0, 100);
+    m_pressureBar->setValue(0);
+    m_pressureBar->setFormat(tr("Pressure %p%"));
+    m_pressureBar->setTextVisible(true);
+    m_pressureBar->setMaximumWidth(120);
+    m_pressureBar->setMaximumHeight(statusBar()->fontMetrics().height() + 4);
+
     statusBar()->addWidget(m_statusLabel);
+    statusBar()->addPermanentWidget(m_pressureBar);
     statusBar()->addPermanentWidget(m_processCountLabel);
     statusBar()->addPermanentWidget(m_alertCountLabel);
 }
@@ -157,6 +251,31 @@ void MainWindow::closeEvent(QCloseEvent *event)
     }
 }
 
+void MainWindow::showEvent(QShowEvent *event)
+{
+    QMainWindow::showEvent(event);
+    updateRefreshTimer();
+    refreshData();
+}
+
+void MainWindow::hideEvent(QHideEvent *event)
+{
+    QMainWindow::hideEvent(event);
+    updateRefreshTimer();
+}
+
+void MainWindow::changeEvent(QEvent *event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange) {
+        bool wasPolling = m_refreshTimer->isActive();
+        updateRefreshTimer();
+        if (!wasPolling && m_refreshTimer->isActive()) {
+            refreshData();  // Restored from minimized
+        }
+    }
+}
+
 void MainWindow::onConnected()
 {
     m_statusLabel->setText(tr("Connected"));
@@ -164,7 +283,8 @@ void MainWindow::onConnected()
     m_trayIcon->setStatus(TrayIcon::Status::Normal);
     m_settingsTab->setConnected(true);
     m_daemonManager->client()->requestConfig();  // Load config on connect
-    m_refreshTimer->start();
+    m_daemonManager->client()->requestStatus();  // Status frames are only pushed on change
+    updateRefreshTimer();
     refreshData();  // Immediate refresh on connect
 }
 
@@ -175,6 +295,7 @@ void MainWindow::onDisconnected()
     m_trayIcon->setStatus(TrayIcon::Status::Warning);
     m_settingsTab->setConnected(false);
     m_refreshTimer->stop();
+    m_lastStatus = QJsonObject();
 }
 
 void MainWindow::onDaemonError(const QString &error)
@@ -205,17 +326,60 @@ void MainWindow::onDaemonCrashed()
 
 void MainWindow::onStatusReceived(const QJsonObject &status)
 {
+    // Heartbeats repeat the last status; nothing to repaint
+    if (status == m_lastStatus) return;
+    m_lastStatus = status;
+
+    QString samplingMode = status["sampling_mode"].toString("normal");
+    int sampleIntervalSecs = status["sample_interval_secs"].toInt(m_sampleIntervalSecs);
+    if (samplingMode != m_samplingMode || sampleIntervalSecs != m_sampleIntervalSecs) {
+        bool escalated = m_samplingMode == "normal" && samplingMode != "normal";
+        m_samplingMode = samplingMode;
+        m_sampleIntervalSecs = sampleIntervalSecs;
+        applyRefreshInterval();
+        if (escalated) refreshData();  // Don't wait out a coarse tick during an incident
+    }
+
     int processCount = status["monitored_count"].toInt();
     int alertCount = status["alert_count"].toInt();
+    int criticalCount = status["critical_count"].toInt();
+    int whitelistedCount = status["whitelisted_count"].toInt();
+    int skippedCount = status["skipped_count"].toInt();
 
     m_processCountLabel->setText(tr("Processes: %1").arg(processCount));
-    m_alertCountLabel->setText(tr("Alerts: %1").arg(alertCount));
+    m_processCountLabel->setToolTip(
+        tr("Sampled every tick: %1\nSampled normally: %2\nIdle, sampled rarely: %3\n"
+           "%4 whitelisted, %5 unreadable")
+        .arg(status["hot_count"].toInt())
+        .arg(status["normal_count"].toInt())
+        .arg(status["idle_count"].toInt())
+        .arg(whitelistedCount).arg(skippedCount));
+    m_alertCountLabel->setText(criticalCount > 0
+        ? tr("Alerts: %1 (%2 critical)").arg(alertCount).arg(criticalCount)
+        : tr("Alerts: %1").arg(alertCount));
+
+    int cpuPressure = status["cpu_pressure"].toInt();
+    int memoryPressure = status["memory_pressure"].toInt();
+    int ioPressure = status["io_pressure"].toInt();
+    bool stalled = status["stalled"].toBool();
+    int pressure = qMax(cpuPressure, qMax(memoryPressure, ioPressure));
+    m_pressureBar->setValue(pressure);
+    m_pressureBar->setToolTip(
+        tr("Share of the last 10 s that tasks stalled waiting for\nCPU: %1%\nMemory: %2%\nIO: %3%%4")
+        .arg(cpuPressure).arg(memoryPressure).arg(ioPressure)
+        .arg(stalled ? tr("\n\nStalling: sampling every process every tick") : QString()));
+    // Highlight the chunk while the daemon is in fast-sampling mode
+    m_pressureBar->setStyleSheet(stalled ? QStringLiteral("QProgressBar::chunk { background-color: #d9534f; }")
+                                         : QString());
 
     // Update tray icon with process and alert counts
     m_trayIcon->updateStatusInfo(processCount, alertCount);
+    m_trayIcon->setPressure(pressure, stalled);
 
-    // Update tray icon status based on alert count
-    if (alertCount > 0) {
+    // Update tray icon status based on pause state and alert count
+    if (status["paused"].toBool()) {
+        m_trayIcon->setStatus(TrayIcon::Status::Paused);
+    } else if (alertCount > 0) {
         m_trayIcon->setStatus(TrayIcon::Status::Warning);
     } else {
         m_trayIcon->setStatus(TrayIcon::Status::Normal);
@@ -227,16 +391,98 @@ void MainWindow::onAlertReceived(const QJsonObject &alert)
     Q_UNUSED(alert);
     // Update tray icon to warning when alert received
     m_trayIcon->setStatus(TrayIcon::Status::Warning);
-    // Refresh alert list
-    m_daemonManager->client()->requestAlerts();
+    // The alert list itself is fetched when the Alerts tab is next shown
+    if (isShowingData() && m_tabWidget->currentWidget() == m_alertTab) {
+        m_daemonManager->client()->requestAlerts();
+    }
+}
+
+void MainWindow::onAlertsBatchReceived(const QJsonArray &alerts)
+{
+    if (alerts.isEmpty()) return;
+
+    // One tray update and one popup per monitoring tick, however many alerts it raised
+    m_trayIcon->setStatus(TrayIcon::Status::Warning);
+    if (m_notificationMethod == "both" || m_notificationMethod == "popup") {
+        m_trayIcon->showAlertDigest(alerts);
+    }
+    if (isShowingData() && m_tabWidget->currentWidget() == m_alertTab) {
+        m_daemonManager->client()->requestAlerts();
+    }
+}
+
+void MainWindow::onConfigReceived(const QJsonObject &config)
+{
+    QJsonObject general = config["general"].toObject();
+    m_notificationMethod = general["notification_method"].toString("both");
+    m_fastIntervalSecs = qMax(1, general["sample_interval_alert"].toInt(2));
+    applyRefreshInterval();
+}
+
+void MainWindow::setLiveRefresh(bool live)
+{
+    QSettings("RunawayGuard", "GUI").setValue("liveRefresh", live);
+    applyRefreshInterval();
+    refreshData();
+}
+
+void MainWindow::applyRefreshInterval()
+{
+    // Live (or on the Performance tab, whose charts scroll): every fast
+    // tick. Otherwise as often as the daemon currently samples: the alert
+    // interval while something is hot or stalling, the normal interval (on a
+    // coarse timer) while all is quiet.
+    bool live = (m_liveAction && m_liveAction->isChecked()) || m_tabWidget->currentWidget() == m_performanceTab;
+    bool idle = !live && m_samplingMode == "normal";
+    int secs = live ? m_fastIntervalSecs : m_sampleIntervalSecs;
+    int intervalMs = qMax(1, secs) * 1000;
+    Qt::TimerType type = idle ? Qt::VeryCoarseTimer : Qt::CoarseTimer;
+    if (m_refreshTimer->interval() == intervalMs && m_refreshTimer->timerType() == type) return;
+
+    bool active = m_refreshTimer->isActive();
+    m_refreshTimer->stop();
+    m_refreshTimer->setTimerType(type);
+    m_refreshTimer->setInterval(intervalMs);
+    if (active) m_refreshTimer->start();
+}
+
+bool MainWindow::isShowingData() const
+{
+    return isVisible() && !isMinimized();
+}
+
+void MainWindow::updateRefreshTimer()
+{
+    // Hidden in the tray or minimized, only pushed status and alert frames
+    // are handled; nothing is polled
+    if (isShowingData() && m_daemonManager->client()->isConnected()) {
+        if (!m_refreshTimer->isActive()) m_refreshTimer->start();
+    } else {
+        m_refreshTimer->stop();
+    }
 }
 
 void MainWindow::refreshData()
 {
+    if (!isShowingData()) return;
     DaemonClient *daemonClient = m_daemonManager->client();
-    daemonClient->requestProcessList();
-    daemonClient->requestAlerts();
-    daemonClient->requestWhitelist();
+    if (!daemonClient->isConnected()) return;
+
+    // Only the tab on screen; the others are fetched when they are selected
+    QWidget *current = m_tabWidget->currentWidget();
+    if (current == m_processTab) {
+        daemonClient->requestProcessList();
+        daemonClient->requestProcessEvents(m_processTab->lastEventSeq());
+    } else if (current == m_performanceTab) {
+        daemonClient->requestSystemStats(m_performanceTab->lastSeq());
+    } else if (current == m_alertTab) {
+        daemonClient->requestAlerts();
+    } else if (current == m_whitelistTab) {
+        daemonClient->requestWhitelist();
+        daemonClient->requestProcessList();  // For the pattern preview
+    } else if (current == m_settingsTab) {
+        daemonClient->requestDbStats();
+    }
 }
 
 void MainWindow::showStatusMessage(const QString &message, int timeout)
@@ -246,43 +492,143 @@ void MainWindow::showStatusMessage(const QString &message, int timeout)
 
 void MainWindow::onPauseMonitoring()
 {
-    // Send pause request to daemon
-    QJsonObject request;
-    request["command"] = "pause";
-    m_daemonManager->client()->sendRequest(request);
+    m_daemonManager->client()->requestPauseMonitoring();
     m_trayIcon->setStatus(TrayIcon::Status::Paused);
     showStatusMessage(tr("Monitoring paused"));
 }
 
 void MainWindow::onResumeMonitoring()
 {
-    // Send resume request to daemon
-    QJsonObject request;
-    request["command"] = "resume";
-    m_daemonManager->client()->sendRequest(request);
+    m_daemonManager->client()->requestResumeMonitoring();
     m_trayIcon->setStatus(TrayIcon::Status::Normal);
     showStatusMessage(tr("Monitoring resumed"));
 }
 
 void MainWindow::onClearAlerts()
 {
-    // Send clear alerts request to daemon
-    QJsonObject request;
-    request["command"] = "clear_alerts";
-    m_daemonManager->client()->sendRequest(request);
+    m_daemonManager->client()->requestClearAlerts();
     m_trayIcon->setStatus(TrayIcon::Status::Normal);
     showStatusMessage(tr("Alerts cleared"));
     // Refresh alert list
     m_daemonManager->client()->requestAlerts();
 }
 
+void MainWindow::onExportAlerts()
+{
+    if (m_exportThread) return;
+
+    // Ask for the time range first
+    QDialog rangeDialog(this);
+    rangeDialog.setWindowTitle(tr("Export Alert History"));
+    auto *form = new QFormLayout(&rangeDialog);
+    auto *fromEdit = new QDateTimeEdit(QDateTime::currentDateTime().addDays(-7), &rangeDialog);
+    auto *toEdit = new QDateTimeEdit(QDateTime::currentDateTime(), &rangeDialog);
+    fromEdit->setCalendarPopup(true);
+    toEdit->setCalendarPopup(true);
+    form->addRow(tr("From:"), fromEdit);
+    form->addRow(tr("To:"), toEdit);
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &rangeDialog);
+    connect(buttons, &QDialogButtonBox::accepted, &rangeDialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &rangeDialog, &QDialog::reject);
+    form->addRow(buttons);
+    if (rangeDialog.exec() != QDialog::Accepted) return;
+
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Export Alert History"), "alerts.csv",
+        tr("CSV (*.csv);;NDJSON (*.ndjson)"));
+    if (filePath.isEmpty()) return;
+
+    startExport(new ExportWorker(ExportWorker::Kind::Alerts, ExportWorker::formatForPath(filePath), filePath,
+                                 fromEdit->dateTime().toSecsSinceEpoch(), toEdit->dateTime().toSecsSinceEpoch()));
+}
+
+void MainWindow::onExportProcesses()
+{
+    if (m_exportThread) return;
+
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Export Process Snapshot"), "processes.csv",
+        tr("CSV (*.csv);;NDJSON (*.ndjson)"));
+    if (filePath.isEmpty()) return;
+
+    startExport(new ExportWorker(ExportWorker::Kind::Processes, ExportWorker::formatForPath(filePath), filePath));
+}
+
+void MainWindow::onShowDiagnostics()
+{
+    if (!m_diagnosticsDialog) {
+        m_diagnosticsDialog = new DiagnosticsDialog(this);
+        DaemonClient *daemonClient = m_daemonManager->client();
+        connect(m_diagnosticsDialog, &DiagnosticsDialog::metricsRequested, daemonClient, [daemonClient]() {
+            if (daemonClient->isConnected()) daemonClient->requestMetrics();
+        });
+        connect(daemonClient, &DaemonClient::metricsReceived, m_diagnosticsDialog, &DiagnosticsDialog::updateMetrics);
+    }
+    m_diagnosticsDialog->show();
+    m_diagnosticsDialog->raise();
+    m_diagnosticsDialog->activateWindow();
+}
+
+void MainWindow::onShowProcessDetails(int pid)
+{
+    // One panel, switched to whichever process was opened last
+    if (!m_detailsDialog) {
+        m_detailsDialog = new ProcessDetailsDialog(this);
+        DaemonClient *daemonClient = m_daemonManager->client();
+        connect(m_detailsDialog, &ProcessDetailsDialog::detailsRequested, daemonClient, [daemonClient](int pid) {
+            if (daemonClient->isConnected()) daemonClient->requestProcessDetails(pid);
+        });
+        connect(daemonClient, &DaemonClient::processDetailsReceived, m_detailsDialog,
+                &ProcessDetailsDialog::updateDetails);
+    }
+    m_detailsDialog->setPid(pid);
+    m_detailsDialog->show();
+    m_detailsDialog->raise();
+    m_detailsDialog->activateWindow();
+}
+
+void MainWindow::startExport(ExportWorker *worker)
+{
+    // Worker runs on its own thread and connection so the UI never blocks on the export
+    m_exportWorker = worker;
+    m_exportThread = new QThread(this);
+    worker->moveToThread(m_exportThread);
+
+    m_exportProgress = new QProgressDialog(tr("Exporting..."), tr("Cancel"), 0, 0, this);
+    m_exportProgress->setWindowModality(Qt::WindowModal);
+    m_exportProgress->setMinimumDuration(500);
+
+    connect(m_exportThread, &QThread::started, worker, &ExportWorker::run);
+    connect(m_exportProgress, &QProgressDialog::canceled, this, [worker]() { worker->cancel(); });
+    connect(worker, &ExportWorker::progress, this, [this](qint64 rows) {
+        if (m_exportProgress) {
+            m_exportProgress->setLabelText(tr("Exported %1 rows...").arg(rows));
+        }
+    });
+    connect(worker, &ExportWorker::finished, this, [this](bool success, const QString &message) {
+        m_exportProgress->deleteLater();
+        m_exportProgress = nullptr;
+        m_exportThread->quit();
+        m_exportThread = nullptr;
+        m_exportWorker = nullptr;
+        if (success) {
+            showStatusMessage(message, 5000);
+        } else {
+            QMessageBox::warning(this, tr("Export"), message);
+        }
+    });
+    connect(m_exportThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(m_exportThread, &QThread::finished, m_exportThread, &QObject::deleteLater);
+
+    m_exportThread->start();
+}
+
 void MainWindow::saveWindowState()
 {
     QSettings settings("RunawayGuard", "GUI");
     settings.beginGroup("MainWindow");
     settings.setValue("geometry", saveGeometry());
     settings.setValue("windowState", saveState());
-    settings.setValue("currentTab", m_tabWidget->currentIndex());
+    settings.setValue("tab", m_tabWidget->currentWidget()->objectName());
+    settings.remove("currentTab");
     settings.endGroup();
 }
 
@@ -296,10 +642,19 @@ void MainWindow::restoreWindowState()
     if (settings.contains("windowState")) {
         restoreState(settings.value("windowState").toByteArray());
     }
-    if (settings.contains("currentTab")) {
+    QString tab = settings.value("tab").toString();
+    if (tab.isEmpty() && settings.contains("currentTab")) {
+        // Older versions saved a raw index, from before the Performance tab
+        static const QStringList legacyTabs = {"monitor", "alerts", "whitelist", "settings"};
         int tabIndex = settings.value("currentTab").toInt();
-        if (tabIndex >= 0 && tabIndex < m_tabWidget->count()) {
-            m_tabWidget->setCurrentIndex(tabIndex);
+        if (tabIndex >= 0 && tabIndex < legacyTabs.size()) {
+            tab = legacyTabs[tabIndex];
+        }
+    }
+    for (int i = 0; i < m_tabWidget->count() && !tab.isEmpty(); ++i) {
+        if (m_tabWidget->widget(i)->objectName() == tab) {
+            m_tabWidget->setCurrentIndex(i);
+            break;
         }
     }
     settings.endGroup();
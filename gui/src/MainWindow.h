@@ -6,14 +6,23 @@
 #include <QTimer>
 #include <QLabel>
 #include <QSettings>
+#include <QJsonObject>
 
 class ProcessTab;
+class PerformanceTab;
 class AlertTab;
 class WhitelistTab;
 class SettingsTab;
 class DaemonManager;
 class DaemonClient;
 class TrayIcon;
+class ExportWorker;
+class DiagnosticsDialog;
+class ProcessDetailsDialog;
+class QThread;
+class QProgressDialog;
+class QProgressBar;
+class QAction;
 
 class MainWindow : public QMainWindow
 {
@@ -28,39 +37,68 @@ public:
 
 protected:
     void closeEvent(QCloseEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    void changeEvent(QEvent *event) override;
 
 private slots:
     void onConnected();
     void onDisconnected();
     void onStatusReceived(const QJsonObject &status);
     void onAlertReceived(const QJsonObject &alert);
+    void onAlertsBatchReceived(const QJsonArray &alerts);
+    void onConfigReceived(const QJsonObject &config);
     void onDaemonError(const QString &error);
     void onDaemonCrashed();
     void refreshData();
+    void updateRefreshTimer();
+    void setLiveRefresh(bool live);
     void showStatusMessage(const QString &message, int timeout = 3000);
     void onPauseMonitoring();
     void onResumeMonitoring();
     void onClearAlerts();
+    void onExportAlerts();
+    void onExportProcesses();
+    void onShowDiagnostics();
+    void onShowProcessDetails(int pid);
 
 private:
     void setupUi();
+    void setupMenuBar();
+    void startExport(ExportWorker *worker);
     void setupConnections();
     void setupStatusBar();
     void setupTrayIcon();
+    bool isShowingData() const;
+    void applyRefreshInterval();
     void saveWindowState();
     void restoreWindowState();
 
     QTabWidget *m_tabWidget;
     ProcessTab *m_processTab;
+    PerformanceTab *m_performanceTab;
     AlertTab *m_alertTab;
     WhitelistTab *m_whitelistTab;
     SettingsTab *m_settingsTab;
     DaemonManager *m_daemonManager;
     TrayIcon *m_trayIcon;
     QTimer *m_refreshTimer;
+    QAction *m_liveAction;
+    // From the latest status frame and config
+    QString m_samplingMode;
+    int m_sampleIntervalSecs;
+    int m_fastIntervalSecs;
     QLabel *m_statusLabel;
     QLabel *m_processCountLabel;
     QLabel *m_alertCountLabel;
+    QProgressBar *m_pressureBar;
+    QString m_notificationMethod;
+    QJsonObject m_lastStatus;
+    QThread *m_exportThread;
+    ExportWorker *m_exportWorker;
+    QProgressDialog *m_exportProgress;
+    DiagnosticsDialog *m_diagnosticsDialog;
+    ProcessDetailsDialog *m_detailsDialog;
 };
 
 #endif
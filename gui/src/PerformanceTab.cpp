@@ -0,0 +1,149 @@
+#include "PerformanceTab.h"
+#include "TimeSeriesChart.h"
+#include "FormatUtils.h"
+#include <QVBoxLayout>
+#include <QGridLayout>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QJsonArray>
+
+namespace {
+
+const QColor TOTAL_COLOR(0x1f, 0x77, 0xb4);
+const QColor MEMORY_COLOR(0x2c, 0xa0, 0x2c);
+const QColor SWAP_COLOR(0xff, 0x7f, 0x0e);
+const QColor LOAD1_COLOR(0xd6, 0x27, 0x28);
+const QColor LOAD5_COLOR(0x94, 0x67, 0xbd);
+const QColor LOAD15_COLOR(0x8c, 0x56, 0x4b);
+
+} // namespace
+
+PerformanceTab::PerformanceTab(QWidget *parent)
+    : QWidget(parent)
+    , m_cpuChart(new TimeSeriesChart(tr("CPU"), this))
+    , m_memoryChart(new TimeSeriesChart(tr("Memory"), this))
+    , m_loadChart(new TimeSeriesChart(tr("Load"), this))
+    , m_topChart(new TimeSeriesChart(tr("Heaviest process"), this))
+    , m_topTable(new QTableWidget(this))
+{
+    setupUi();
+}
+
+void PerformanceTab::setupUi()
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+
+    m_cpuChart->setValueRange(0, 100);
+    m_cpuChart->setValueFormatter([](double v) { return QStringLiteral("%1%").arg(v, 0, 'f', 0); });
+    m_cpuChart->setToolTip(tr("All cores together (thick) and each core"));
+    m_memoryChart->setSeries({tr("RAM"), tr("Swap")}, {MEMORY_COLOR, SWAP_COLOR});
+    m_memoryChart->setValueFormatter([](double mb) { return FormatUtils::formatMemory(mb); });
+    m_memoryChart->setToolTip(tr("Used memory (total minus available) and used swap"));
+    m_loadChart->setSeries({tr("1m"), tr("5m"), tr("15m")}, {LOAD1_COLOR, LOAD5_COLOR, LOAD15_COLOR});
+    m_loadChart->setValueFormatter([](double v) { return QString::number(v, 'f', 2); });
+    m_topChart->setSeries({tr("CPU")}, {TOTAL_COLOR});
+    m_topChart->setValueFormatter([](double v) { return FormatUtils::formatCpu(v); });
+    m_topChart->setToolTip(tr("CPU use of whichever process used the most at each sample"));
+
+    auto *grid = new QGridLayout();
+    grid->addWidget(m_cpuChart, 0, 0);
+    grid->addWidget(m_memoryChart, 0, 1);
+    grid->addWidget(m_loadChart, 1, 0);
+    grid->addWidget(m_topChart, 1, 1);
+    layout->addLayout(grid, 1);
+
+    m_topTable->setColumnCount(4);
+    m_topTable->setHorizontalHeaderLabels({tr("PID"), tr("Top processes now"), tr("CPU"), tr("Memory")});
+    m_topTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    m_topTable->verticalHeader()->setVisible(false);
+    m_topTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_topTable->setSelectionMode(QAbstractItemView::NoSelection);
+    m_topTable->setMaximumHeight(m_topTable->horizontalHeader()->sizeHint().height()
+                                 + 3 * m_topTable->verticalHeader()->defaultSectionSize() + 4);
+    layout->addWidget(m_topTable);
+
+    clearCharts();
+}
+
+void PerformanceTab::clearCharts()
+{
+    // Per-core series are set up when the first sample shows the core count
+    m_coreCount = -1;
+    m_memoryRangeMb = 0.0;
+    m_cpuChart->setSeries({tr("Total")}, {TOTAL_COLOR});
+    m_memoryChart->clear();
+    m_loadChart->clear();
+    m_topChart->clear();
+    m_topTable->setRowCount(0);
+}
+
+void PerformanceTab::appendSamples(const QJsonObject &response)
+{
+    qint64 nextSeq = response["next_seq"].toInteger();
+    if (nextSeq < m_lastSeq) {
+        // Daemon restarted and its sequence numbers started over
+        clearCharts();
+    }
+    m_lastSeq = nextSeq;
+
+    const QJsonArray samples = response["samples"].toArray();
+    for (const QJsonValue &value : samples) {
+        addSample(value.toObject());
+    }
+    if (samples.isEmpty()) return;
+
+    const QJsonArray top = samples.last().toObject()["top"].toArray();
+    m_topTable->setRowCount(top.size());
+    for (int row = 0; row < top.size(); ++row) {
+        QJsonObject proc = top[row].toObject();
+        double cpu = proc["cpu_percent"].toDouble();
+        double memory = proc["memory_mb"].toDouble();
+        auto *pidItem = new QTableWidgetItem();
+        pidItem->setData(Qt::DisplayRole, proc["pid"].toInt());
+        m_topTable->setItem(row, 0, pidItem);
+        m_topTable->setItem(row, 1, new QTableWidgetItem(proc["name"].toString()));
+        m_topTable->setItem(row, 2, new QTableWidgetItem(FormatUtils::formatCpu(cpu)));
+        m_topTable->setItem(row, 3, new QTableWidgetItem(FormatUtils::formatMemory(memory)));
+    }
+}
+
+void PerformanceTab::addSample(const QJsonObject &sample)
+{
+    qint64 timestamp = sample["timestamp"].toInteger();
+    const QJsonArray cores = sample["cores"].toArray();
+
+    if (cores.size() != m_coreCount) {
+        // Cores first so the total is drawn over them
+        m_coreCount = cores.size();
+        QStringList names;
+        QVector<QColor> colors;
+        for (int i = 0; i < m_coreCount; ++i) {
+            names.append(QString());
+            QColor color = QColor::fromHsvF(double(i) / qMax(1, m_coreCount), 0.5, 0.85);
+            color.setAlphaF(0.5);
+            colors.append(color);
+        }
+        names.append(tr("Total"));
+        colors.append(TOTAL_COLOR);
+        m_cpuChart->setSeries(names, colors);
+    }
+    QVector<double> cpu;
+    cpu.reserve(m_coreCount + 1);
+    for (const QJsonValue &core : cores) cpu.append(core.toDouble());
+    cpu.append(sample["cpu_percent"].toDouble());
+    m_cpuChart->append(timestamp, cpu);
+
+    double memoryRange = qMax(sample["memory_total_mb"].toDouble(), sample["swap_total_mb"].toDouble());
+    if (memoryRange != m_memoryRangeMb && memoryRange > 0) {
+        m_memoryRangeMb = memoryRange;
+        m_memoryChart->setValueRange(0, memoryRange);
+    }
+    m_memoryChart->append(timestamp, {sample["memory_used_mb"].toDouble(), sample["swap_used_mb"].toDouble()});
+
+    const QJsonArray load = sample["load"].toArray();
+    m_loadChart->append(timestamp, {load.at(0).toDouble(), load.at(1).toDouble(), load.at(2).toDouble()});
+
+    const QJsonArray top = sample["top"].toArray();
+    m_topChart->append(timestamp, {top.isEmpty() ? 0.0 : top.at(0).toObject()["cpu_percent"].toDouble()});
+}
@@ -0,0 +1,41 @@
+#ifndef PERFORMANCETAB_H
+#define PERFORMANCETAB_H
+
+#include <QWidget>
+#include <QJsonObject>
+
+class TimeSeriesChart;
+class QTableWidget;
+
+// System-wide CPU (total and per core), memory and swap, load and the
+// heaviest process over the last hour, from the daemon's per-tick samples
+// (get_system_stats). Only polled while the tab is on screen; the daemon
+// keeps an hour of samples, so switching back fills the gap.
+class PerformanceTab : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PerformanceTab(QWidget *parent = nullptr);
+    // Sequence number to pass as "since" on the next get_system_stats
+    qint64 lastSeq() const { return m_lastSeq; }
+
+public slots:
+    void appendSamples(const QJsonObject &response);
+
+private:
+    void setupUi();
+    void addSample(const QJsonObject &sample);
+    void clearCharts();
+
+    TimeSeriesChart *m_cpuChart;
+    TimeSeriesChart *m_memoryChart;
+    TimeSeriesChart *m_loadChart;
+    TimeSeriesChart *m_topChart;
+    QTableWidget *m_topTable;
+    qint64 m_lastSeq = 0;
+    int m_coreCount = -1;
+    double m_memoryRangeMb = 0.0;
+};
+
+#endif
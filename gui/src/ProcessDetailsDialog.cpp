@@ -0,0 +1,171 @@
+#include "ProcessDetailsDialog.h"
+#include "DiagnosticsDialog.h"
+#include "FormatUtils.h"
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QDialogButtonBox>
+#include <QTimer>
+#include <QJsonArray>
+
+namespace {
+
+const QColor CPU_COLOR(0x1f, 0x77, 0xb4);
+const QColor RSS_COLOR(0xd6, 0x27, 0x28);
+
+QString formatBytes(double bytes)
+{
+    if (bytes < 1024.0) return QStringLiteral("%1 B").arg(bytes, 0, 'f', 0);
+    if (bytes < 1024.0 * 1024.0) return QStringLiteral("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    return FormatUtils::formatMemory(bytes / (1024.0 * 1024.0));
+}
+
+// "1.2 MB/s (340.0 MB total)"; "-" where /proc/<pid>/io was not readable
+QString formatIo(const QJsonValue &perSecond, const QJsonValue &total)
+{
+    if (!total.isDouble()) return QStringLiteral("-");
+    QString rate = perSecond.isDouble() ? QObject::tr("%1/s").arg(formatBytes(perSecond.toDouble()))
+                                        : QObject::tr("measuring...");
+    return QObject::tr("%1 (%2 total)").arg(rate, formatBytes(total.toDouble()));
+}
+
+QString formatCount(const QJsonValue &value)
+{
+    return value.isDouble() ? QString::number(value.toInteger()) : QStringLiteral("-");
+}
+
+}
+
+ProcessDetailsDialog::ProcessDetailsDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_titleLabel(new QLabel(this))
+    , m_chart(new SelfUsageChart(this))
+    , m_cpuLabel(new QLabel(this))
+    , m_memoryLabel(new QLabel(this))
+    , m_leakLabel(new QLabel(this))
+    , m_threadsLabel(new QLabel(this))
+    , m_fdLabel(new QLabel(this))
+    , m_readLabel(new QLabel(this))
+    , m_writeLabel(new QLabel(this))
+    , m_cgroupLabel(new QLabel(this))
+    , m_environLabel(new QLabel(this))
+    , m_cmdlineEdit(new QPlainTextEdit(this))
+    , m_pollTimer(new QTimer(this))
+{
+    setWindowTitle(tr("Process Details"));
+    resize(560, 560);
+
+    auto *layout = new QVBoxLayout(this);
+    m_titleLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(m_titleLabel);
+
+    auto *legend = new QLabel(tr("<span style='color:%1'>&#9632;</span> CPU &nbsp; "
+                                 "<span style='color:%2'>&#9632;</span> Resident memory")
+                                  .arg(CPU_COLOR.name(), RSS_COLOR.name()), this);
+    legend->setToolTip(tr("As sampled by the daemon's detector; idle processes are sampled less often"));
+    layout->addWidget(legend);
+    layout->addWidget(m_chart, 1);
+
+    auto *form = new QFormLayout();
+    form->addRow(tr("CPU:"), m_cpuLabel);
+    form->addRow(tr("Memory:"), m_memoryLabel);
+    form->addRow(tr("Leak rate:"), m_leakLabel);
+    form->addRow(tr("Threads:"), m_threadsLabel);
+    form->addRow(tr("Open files:"), m_fdLabel);
+    form->addRow(tr("Disk read:"), m_readLabel);
+    form->addRow(tr("Disk write:"), m_writeLabel);
+    form->addRow(tr("cgroup:"), m_cgroupLabel);
+    form->addRow(tr("Environment:"), m_environLabel);
+    for (QLabel *label : {m_cgroupLabel, m_environLabel}) {
+        label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    }
+    layout->addLayout(form);
+
+    layout->addWidget(new QLabel(tr("Command line:"), this));
+    m_cmdlineEdit->setReadOnly(true);
+    m_cmdlineEdit->setMaximumHeight(80);
+    layout->addWidget(m_cmdlineEdit);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    m_pollTimer->setInterval(POLL_INTERVAL_MS);
+    connect(m_pollTimer, &QTimer::timeout, this, [this]() {
+        if (m_pid > 0) emit detailsRequested(m_pid);
+    });
+    clearValues();
+}
+
+void ProcessDetailsDialog::setPid(int pid)
+{
+    if (pid == m_pid) return;
+    m_pid = pid;
+    clearValues();
+    m_titleLabel->setText(tr("PID %1").arg(pid));
+    if (isVisible()) {
+        emit detailsRequested(pid);
+        m_pollTimer->start();  // Stopped if the previous process exited
+    }
+}
+
+void ProcessDetailsDialog::clearValues()
+{
+    for (QLabel *label : {m_cpuLabel, m_memoryLabel, m_leakLabel, m_threadsLabel, m_fdLabel, m_readLabel,
+                          m_writeLabel, m_cgroupLabel, m_environLabel}) {
+        label->setText(QStringLiteral("-"));
+    }
+    m_cmdlineEdit->clear();
+    m_chart->setHistory(QJsonArray());
+}
+
+void ProcessDetailsDialog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    if (m_pid > 0) emit detailsRequested(m_pid);
+    m_pollTimer->start();
+}
+
+void ProcessDetailsDialog::hideEvent(QHideEvent *event)
+{
+    m_pollTimer->stop();
+    QDialog::hideEvent(event);
+}
+
+void ProcessDetailsDialog::updateDetails(const QJsonObject &response)
+{
+    if (!response["details"].isObject()) {
+        // The process exited; keep its last values on screen
+        if (response["pid"].toInt() == m_pid) {
+            m_pollTimer->stop();
+            m_titleLabel->setText(tr("PID %1 has exited").arg(m_pid));
+        }
+        return;
+    }
+    QJsonObject details = response["details"].toObject();
+    if (details["pid"].toInt() != m_pid) return;  // Reply for a process shown earlier
+
+    setWindowTitle(tr("Process Details - %1").arg(details["name"].toString()));
+    m_titleLabel->setText(tr("<b>%1</b> (PID %2) &middot; state %3 &middot; running for %4")
+        .arg(details["name"].toString().toHtmlEscaped())
+        .arg(m_pid)
+        .arg(details["state"].toString(),
+             FormatUtils::formatRuntime(details["runtime_seconds"].toInteger())));
+    m_cpuLabel->setText(FormatUtils::formatCpu(details["cpu_percent"].toDouble()));
+    m_memoryLabel->setText(FormatUtils::formatMemory(details["memory_mb"].toDouble()));
+    QJsonValue leakRate = details["leak_rate_mb_per_min"];
+    m_leakLabel->setText(leakRate.isDouble() ? FormatUtils::formatLeakRate(leakRate.toDouble()) : tr("not enough samples"));
+    m_threadsLabel->setText(formatCount(details["threads"]));
+    m_fdLabel->setText(formatCount(details["fd_count"]));
+    m_readLabel->setText(formatIo(details["read_bytes_per_sec"], details["read_bytes"]));
+    m_writeLabel->setText(formatIo(details["write_bytes_per_sec"], details["write_bytes"]));
+    m_cgroupLabel->setText(details["cgroup"].isString() ? details["cgroup"].toString() : QStringLiteral("-"));
+    m_environLabel->setText(details["environ_bytes"].isDouble()
+        ? tr("%1 variables, %2").arg(details["environ_vars"].toInteger())
+              .arg(formatBytes(details["environ_bytes"].toDouble()))
+        : tr("not readable"));
+    QString cmdline = details["cmdline"].toString();
+    if (m_cmdlineEdit->toPlainText() != cmdline) m_cmdlineEdit->setPlainText(cmdline);
+    m_chart->setHistory(details["history"].toArray(), QStringLiteral("memory_mb"));
+}
@@ -0,0 +1,57 @@
+#ifndef PROCESSDETAILSDIALOG_H
+#define PROCESSDETAILSDIALOG_H
+
+#include <QDialog>
+#include <QJsonObject>
+
+class QLabel;
+class QPlainTextEdit;
+class QTimer;
+class SelfUsageChart;
+
+// One process in depth: its recent CPU and RSS as the detector sampled them,
+// open descriptors, threads, disk I/O rates, cgroup, environment size and
+// full command line. Nothing is fetched until the panel is opened, and it
+// polls process_details only while shown.
+class ProcessDetailsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ProcessDetailsDialog(QWidget *parent = nullptr);
+    int pid() const { return m_pid; }
+    // Clears the previous process's values and fetches the new one's
+    void setPid(int pid);
+
+signals:
+    void detailsRequested(int pid);
+
+public slots:
+    // The "details" response; null once the process has exited
+    void updateDetails(const QJsonObject &response);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void clearValues();
+
+    int m_pid = -1;
+    QLabel *m_titleLabel;
+    SelfUsageChart *m_chart;
+    QLabel *m_cpuLabel;
+    QLabel *m_memoryLabel;
+    QLabel *m_leakLabel;
+    QLabel *m_threadsLabel;
+    QLabel *m_fdLabel;
+    QLabel *m_readLabel;
+    QLabel *m_writeLabel;
+    QLabel *m_cgroupLabel;
+    QLabel *m_environLabel;
+    QPlainTextEdit *m_cmdlineEdit;
+    QTimer *m_pollTimer;
+    static const int POLL_INTERVAL_MS = 2000;
+};
+
+#endif
@@ -1,17 +1,53 @@
 #include "ProcessTab.h"
 #include "FormatUtils.h"
+#include "HeatMapDelegate.h"
 #include <QVBoxLayout>
 #include <QHeaderView>
 #include <QJsonObject>
-#include <QApplication>
-#include <QClipboard>
 #include <QShortcut>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QDateTime>
+#include <QSet>
+#include <QTreeWidgetItemIterator>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+
+enum CgroupColumn { NameColumn, CpuColumn, MemoryColumn, LeakColumn, ProcessesColumn, OomColumn };
+
+// Role holding the pid on process rows of the cgroup tree (0 on cgroup rows)
+const int PidRole = Qt::UserRole + 1;
+
+// Sorts numeric columns by the value in Qt::UserRole rather than the text
+class CgroupTreeItem : public QTreeWidgetItem
+{
+public:
+    using QTreeWidgetItem::QTreeWidgetItem;
+
+    bool operator<(const QTreeWidgetItem &other) const override
+    {
+        int column = treeWidget() ? treeWidget()->sortColumn() : 0;
+        if (column == NameColumn) return QTreeWidgetItem::operator<(other);
+        return data(column, Qt::UserRole).toDouble() < other.data(column, Qt::UserRole).toDouble();
+    }
+};
+
+void setNumber(QTreeWidgetItem *item, int column, const QString &text, double value)
+{
+    item->setText(column, text);
+    item->setData(column, Qt::UserRole, value);
+}
+
+} // namespace
 
 ProcessTab::ProcessTab(QWidget *parent)
     : QWidget(parent)
     , m_table(new QTableWidget(this))
+    , m_cgroupTree(new QTreeWidget(this))
+    , m_tableHeat(new HeatMapDelegate(this))
+    , m_treeHeat(new HeatMapDelegate(this))
     , m_contextMenu(new QMenu(this))
 {
     setupUi();
@@ -24,6 +60,10 @@ void ProcessTab::setupUi()
 
     // Search bar
     auto *searchLayout = new QHBoxLayout();
+    m_groupCheck = new QCheckBox(tr("Group by cgroup"), this);
+    m_groupCheck->setToolTip(tr("Show services and containers with their totals, processes nested inside"));
+    m_groupCheck->setVisible(false);  // Until the daemon reports cgroups
+    searchLayout->addWidget(m_groupCheck);
     searchLayout->addStretch();
     m_searchEdit = new QLineEdit(this);
     m_searchEdit->setPlaceholderText(tr("Search processes..."));
@@ -33,8 +73,10 @@ void ProcessTab::setupUi()
     layout->addLayout(searchLayout);
 
     // Table setup
-    m_table->setColumnCount(6);
-    m_table->setHorizontalHeaderLabels({tr("PID"), tr("Name"), tr("CPU"), tr("Memory"), tr("Runtime"), tr("State")});
+    m_table->setColumnCount(7);
+    m_table->setHorizontalHeaderLabels({tr("PID"), tr("Name"), tr("CPU"), tr("Memory"), tr("Runtime"), tr("State"),
+                                        tr("Leak Rate")});
+    m_table->horizontalHeaderItem(6)->setToolTip(tr("Memory growth fitted over the leak detection window"));
     m_table->horizontalHeader()->setStretchLastSection(true);
     m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
     m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -43,9 +85,40 @@ void ProcessTab::setupUi()
     m_table->setSortingEnabled(true);
     m_table->setAlternatingRowColors(true);
     m_table->verticalHeader()->setDefaultSectionSize(m_table->verticalHeader()->defaultSectionSize() + 4);
-    layout->addWidget(m_table);
+    m_tableHeat->setColumnScale(2, HeatMapDelegate::Scale::Cpu);
+    m_tableHeat->setColumnScale(3, HeatMapDelegate::Scale::Memory);
+    m_tableHeat->setColumnScale(5, HeatMapDelegate::Scale::State);
+    m_tableHeat->setColumnScale(6, HeatMapDelegate::Scale::LeakRate);
+    m_table->setItemDelegate(m_tableHeat);
+    layout->addWidget(m_table, 1);
+
+    // cgroup grouping view, swapped in for the table
+    m_cgroupTree->setColumnCount(6);
+    m_cgroupTree->setHeaderLabels({tr("cgroup / Process"), tr("CPU"), tr("Memory"), tr("Leak Rate"), tr("Processes"),
+                                   tr("OOM Kills")});
+    m_cgroupTree->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_cgroupTree->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_cgroupTree->setSortingEnabled(true);
+    m_cgroupTree->sortByColumn(CpuColumn, Qt::DescendingOrder);
+    m_cgroupTree->setAlternatingRowColors(true);
+    m_treeHeat->setColumnScale(CpuColumn, HeatMapDelegate::Scale::Cpu);
+    m_treeHeat->setColumnScale(MemoryColumn, HeatMapDelegate::Scale::Memory);
+    m_treeHeat->setColumnScale(LeakColumn, HeatMapDelegate::Scale::LeakRate);
+    m_cgroupTree->setItemDelegate(m_treeHeat);
+    m_cgroupTree->setVisible(false);
+    layout->addWidget(m_cgroupTree, 1);
+
+    // Recent spawn/exit feed, newest first
+    m_activityLabel = new QLabel(tr("Recent activity"), this);
+    layout->addWidget(m_activityLabel);
+    m_activityList = new QListWidget(this);
+    m_activityList->setMaximumHeight(120);
+    m_activityList->setSelectionMode(QAbstractItemView::NoSelection);
+    layout->addWidget(m_activityList);
 
     // Context menu
+    m_contextMenu->addAction(tr("Details..."), this, &ProcessTab::onShowDetails);
+    m_contextMenu->addSeparator();
     m_contextMenu->addAction(tr("Terminate (SIGTERM)"), this, &ProcessTab::onTerminateProcess);
     m_contextMenu->addAction(tr("Kill (SIGKILL)"), this, &ProcessTab::onKillProcess);
     m_contextMenu->addAction(tr("Stop (SIGSTOP)"), this, &ProcessTab::onStopProcess);
@@ -55,12 +128,11 @@ void ProcessTab::setupUi()
 
     // Connections
     connect(m_table, &QTableWidget::customContextMenuRequested, this, &ProcessTab::showContextMenu);
+    connect(m_cgroupTree, &QTreeWidget::customContextMenuRequested, this, &ProcessTab::showContextMenu);
+    connect(m_groupCheck, &QCheckBox::toggled, this, &ProcessTab::setGroupedView);
     connect(m_searchEdit, &QLineEdit::textChanged, this, &ProcessTab::filterTable);
-    connect(m_table, &QTableWidget::cellDoubleClicked, this, [this](int row, int col) {
-        if (auto *item = m_table->item(row, col)) {
-            QApplication::clipboard()->setText(item->text());
-        }
-    });
+    connect(m_table, &QTableWidget::cellDoubleClicked, this, &ProcessTab::onShowDetails);
+    connect(m_cgroupTree, &QTreeWidget::itemDoubleClicked, this, &ProcessTab::onShowDetails);
 
     // Ctrl+F shortcut
     auto *searchShortcut = new QShortcut(QKeySequence::Find, this);
@@ -78,6 +150,45 @@ void ProcessTab::setupUi()
     settings.endGroup();
 }
 
+void ProcessTab::appendProcessEvents(const QJsonObject &response)
+{
+    qint64 nextSeq = response["next_seq"].toInteger();
+    if (nextSeq < m_lastEventSeq) {
+        // Daemon restarted and its sequence numbers started over
+        m_activityList->clear();
+    }
+    m_lastEventSeq = nextSeq;
+
+    QString source = response["source"].toString();
+    m_activityLabel->setText(source == "netlink"
+        ? tr("Recent activity (live)")
+        : tr("Recent activity (sampled every scan)"));
+
+    const QJsonArray events = response["events"].toArray();
+    for (const QJsonValue &value : events) {
+        QJsonObject event = value.toObject();
+        QString kind = event["kind"].toString();
+        QString time = QDateTime::fromSecsSinceEpoch(event["timestamp"].toInteger()).toString("HH:mm:ss");
+        QString name = event["name"].toString();
+        int pid = event["pid"].toInt();
+
+        QString text;
+        if (kind == "spawn") {
+            int ppid = event["ppid"].toInt();
+            text = ppid > 0 ? tr("%1  Started %2 (%3) from %4").arg(time, name).arg(pid).arg(ppid)
+                            : tr("%1  Started %2 (%3)").arg(time, name).arg(pid);
+        } else if (kind == "exec") {
+            text = tr("%1  %2 (%3) ran a new program").arg(time, name).arg(pid);
+        } else {
+            text = tr("%1  Exited %2 (%3)").arg(time, name).arg(pid);
+        }
+        m_activityList->insertItem(0, text);
+    }
+    while (m_activityList->count() > MAX_ACTIVITY_ITEMS) {
+        delete m_activityList->takeItem(m_activityList->count() - 1);
+    }
+}
+
 void ProcessTab::updateProcessList(const QJsonArray &processes)
 {
     int sortColumn = m_table->horizontalHeader()->sortIndicatorSection();
@@ -85,9 +196,11 @@ void ProcessTab::updateProcessList(const QJsonArray &processes)
 
     m_table->setSortingEnabled(false);
     m_table->setRowCount(processes.size());
+    m_processesByPid.clear();
 
     for (int i = 0; i < processes.size(); ++i) {
         QJsonObject proc = processes[i].toObject();
+        m_processesByPid.insert(proc["pid"].toInt(), proc);
 
         int pid = proc["pid"].toInt();
         QString name = proc["name"].toString();
@@ -124,7 +237,12 @@ void ProcessTab::updateProcessList(const QJsonArray &processes)
         auto *stateItem = new QTableWidgetItem(state);
         m_table->setItem(i, 5, stateItem);
 
-        applyRowColors(i, cpu, memory, state);
+        // null until the daemon has enough samples, and for whitelisted processes
+        QJsonValue leakRate = proc["leak_rate_mb_per_min"];
+        auto *leakItem = new QTableWidgetItem(leakRate.isDouble() ? FormatUtils::formatLeakRate(leakRate.toDouble())
+                                                                  : QString());
+        leakItem->setData(Qt::UserRole, leakRate.toDouble());
+        m_table->setItem(i, 6, leakItem);
     }
 
     m_table->setSortingEnabled(true);
@@ -146,14 +264,122 @@ void ProcessTab::updateProcessList(const QJsonArray &processes)
     settings.endGroup();
 }
 
+void ProcessTab::updateCgroupList(const QJsonArray &cgroups)
+{
+    m_cgroups = cgroups;
+    if (cgroups.isEmpty()) {
+        m_groupCheck->setChecked(false);
+        m_groupCheck->setVisible(false);
+        return;
+    }
+    m_groupCheck->setVisible(true);
+    if (m_groupCheck->isChecked()) {
+        rebuildCgroupTree();
+    }
+}
+
+void ProcessTab::setGroupedView(bool grouped)
+{
+    m_table->setVisible(!grouped);
+    m_cgroupTree->setVisible(grouped);
+    if (grouped) {
+        rebuildCgroupTree();
+    }
+}
+
+void ProcessTab::rebuildCgroupTree()
+{
+    // Keep what the user expanded across refreshes
+    QSet<QString> expanded;
+    for (QTreeWidgetItemIterator it(m_cgroupTree); *it; ++it) {
+        if ((*it)->isExpanded()) expanded.insert((*it)->data(NameColumn, Qt::UserRole).toString());
+    }
+
+    m_cgroupTree->setSortingEnabled(false);
+    m_cgroupTree->clear();
+
+    // Sorted by path so every parent is created before its children
+    QVector<QJsonObject> cgroups;
+    cgroups.reserve(m_cgroups.size());
+    for (const QJsonValue &value : m_cgroups) cgroups.append(value.toObject());
+    std::sort(cgroups.begin(), cgroups.end(), [](const QJsonObject &a, const QJsonObject &b) {
+        return a["path"].toString() < b["path"].toString();
+    });
+
+    QHash<QString, QTreeWidgetItem *> byPath;
+    for (const QJsonObject &cgroup : cgroups) {
+        QString path = cgroup["path"].toString();
+        QTreeWidgetItem *parent = byPath.value(path.section('/', 0, -2));
+        auto *item = parent ? new CgroupTreeItem(parent) : new CgroupTreeItem(m_cgroupTree);
+        byPath.insert(path, item);
+
+        double cpu = cgroup["cpu_percent"].toDouble();
+        // null without the memory controller
+        QJsonValue memoryValue = cgroup["memory_mb"];
+        double memory = memoryValue.toDouble();
+        QJsonArray pids = cgroup["pids"].toArray();
+        int oomKills = cgroup["oom_kills"].toInt();
+
+        item->setText(NameColumn, path.section('/', -1));
+        item->setData(NameColumn, Qt::UserRole, path);
+        item->setData(NameColumn, PidRole, 0);
+        item->setToolTip(NameColumn, tr("%1\nmemory.high events: %2\nmemory.max events: %3")
+            .arg(path).arg(cgroup["memory_high_events"].toInt()).arg(cgroup["memory_max_events"].toInt()));
+        setNumber(item, CpuColumn, FormatUtils::formatCpu(cpu), cpu);
+        setNumber(item, MemoryColumn, memoryValue.isDouble() ? FormatUtils::formatMemory(memory) : QString(), memory);
+        QJsonValue leakRate = cgroup["leak_rate_mb_per_min"];
+        setNumber(item, LeakColumn, leakRate.isDouble() ? FormatUtils::formatLeakRate(leakRate.toDouble()) : QString(),
+                  leakRate.toDouble());
+        setNumber(item, ProcessesColumn, pids.isEmpty() ? QString() : QString::number(pids.size()), pids.size());
+        setNumber(item, OomColumn, oomKills > 0 ? QString::number(oomKills) : QString(), oomKills);
+
+        // Members known from the process snapshot (none in cgroup-only mode)
+        for (const QJsonValue &pidValue : pids) {
+            auto it = m_processesByPid.constFind(pidValue.toInt());
+            if (it == m_processesByPid.constEnd()) continue;
+            const QJsonObject &proc = *it;
+            double procCpu = proc["cpu_percent"].toDouble();
+            double procMemory = proc["memory_mb"].toDouble();
+            auto *child = new CgroupTreeItem(item);
+            child->setText(NameColumn, QStringLiteral("%1  %2").arg(it.key()).arg(proc["name"].toString()));
+            child->setData(NameColumn, Qt::UserRole, proc["name"].toString());
+            child->setData(NameColumn, PidRole, it.key());
+            child->setToolTip(NameColumn, proc["cmdline"].toString());
+            setNumber(child, CpuColumn, FormatUtils::formatCpu(procCpu), procCpu);
+            setNumber(child, MemoryColumn, FormatUtils::formatMemory(procMemory), procMemory);
+            QJsonValue procLeak = proc["leak_rate_mb_per_min"];
+            setNumber(child, LeakColumn,
+                      procLeak.isDouble() ? FormatUtils::formatLeakRate(procLeak.toDouble()) : QString(),
+                      procLeak.toDouble());
+        }
+
+        if (expanded.contains(path)) item->setExpanded(true);
+    }
+
+    m_cgroupTree->setSortingEnabled(true);
+    if (!m_searchEdit->text().isEmpty()) {
+        filterTable(m_searchEdit->text());
+    }
+}
+
 void ProcessTab::showContextMenu(const QPoint &pos)
 {
+    if (m_groupCheck->isChecked()) {
+        if (!m_cgroupTree->currentItem()) return;
+        m_contextMenu->exec(m_cgroupTree->viewport()->mapToGlobal(pos));
+        return;
+    }
     if (m_table->selectedItems().isEmpty()) return;
     m_contextMenu->exec(m_table->viewport()->mapToGlobal(pos));
 }
 
 int ProcessTab::getSelectedPid() const
 {
+    if (m_groupCheck->isChecked()) {
+        // cgroup rows have no pid and are ignored by the signal actions
+        QTreeWidgetItem *item = m_cgroupTree->currentItem();
+        return item ? item->data(NameColumn, PidRole).toInt() : -1;
+    }
     auto items = m_table->selectedItems();
     if (items.isEmpty()) return -1;
     int row = items.first()->row();
@@ -162,6 +388,13 @@ int ProcessTab::getSelectedPid() const
 
 QString ProcessTab::getSelectedName() const
 {
+    if (m_groupCheck->isChecked()) {
+        // Process name, or for a cgroup the unit/container name the daemon matches
+        QTreeWidgetItem *item = m_cgroupTree->currentItem();
+        if (!item) return QString();
+        return item->data(NameColumn, PidRole).toInt() > 0 ? item->data(NameColumn, Qt::UserRole).toString()
+                                                           : item->text(NameColumn);
+    }
     auto items = m_table->selectedItems();
     if (items.isEmpty()) return QString();
     int row = items.first()->row();
@@ -206,34 +439,50 @@ void ProcessTab::onContinueProcess()
     if (pid > 0) emit killProcessRequested(pid, "SIGCONT");
 }
 
+void ProcessTab::onShowDetails()
+{
+    // Double-clicking a cgroup row only expands it
+    int pid = getSelectedPid();
+    if (pid > 0) emit processDetailsRequested(pid);
+}
+
 void ProcessTab::onAddToWhitelist()
 {
     QString name = getSelectedName();
     if (!name.isEmpty()) emit addWhitelistRequested(name, "name");
 }
 
-void ProcessTab::applyRowColors(int row, double cpu, double memory, const QString &state)
+void ProcessTab::setDetectionThresholds(const QJsonObject &config)
 {
-    QColor cpuBg = FormatUtils::getCpuBackgroundColor(cpu);
-    QColor memBg = FormatUtils::getMemoryBackgroundColor(memory);
-    QColor stateBg = FormatUtils::getStateBackgroundColor(state);
-
-    if (cpuBg.isValid()) {
-        m_table->item(row, 2)->setBackground(cpuBg);
-        m_table->item(row, 2)->setForeground(FormatUtils::getTextColorForBackground(cpuBg));
+    double cpuThreshold = config["cpu_high"].toObject()["threshold_percent"].toDouble(90);
+    QJsonObject memoryLeak = config["memory_leak"].toObject();
+    double growthMb = memoryLeak["growth_threshold_mb"].toDouble(500);
+    double windowMinutes = memoryLeak["window_minutes"].toDouble(5);
+    for (HeatMapDelegate *heat : {m_tableHeat, m_treeHeat}) {
+        heat->setThresholds(cpuThreshold, growthMb, windowMinutes);
     }
-    if (memBg.isValid()) {
-        m_table->item(row, 3)->setBackground(memBg);
-        m_table->item(row, 3)->setForeground(FormatUtils::getTextColorForBackground(memBg));
-    }
-    if (stateBg.isValid()) {
-        m_table->item(row, 5)->setBackground(stateBg);
-        m_table->item(row, 5)->setForeground(FormatUtils::getTextColorForBackground(stateBg));
+    m_table->viewport()->update();
+    m_cgroupTree->viewport()->update();
+}
+
+bool ProcessTab::filterTreeItem(QTreeWidgetItem *item, const QString &text)
+{
+    // A row stays visible if it or anything below it matches
+    bool match = text.isEmpty()
+        || item->text(NameColumn).contains(text, Qt::CaseInsensitive)
+        || item->data(NameColumn, Qt::UserRole).toString().contains(text, Qt::CaseInsensitive);
+    for (int i = 0; i < item->childCount(); ++i) {
+        if (filterTreeItem(item->child(i), text)) match = true;
     }
+    item->setHidden(!match);
+    return match;
 }
 
 void ProcessTab::filterTable(const QString &text)
 {
+    for (int i = 0; i < m_cgroupTree->topLevelItemCount(); ++i) {
+        filterTreeItem(m_cgroupTree->topLevelItem(i), text);
+    }
     for (int i = 0; i < m_table->rowCount(); ++i) {
         bool match = text.isEmpty();
         if (!match) {
@@ -3,23 +3,39 @@
 
 #include <QWidget>
 #include <QTableWidget>
+#include <QTreeWidget>
+#include <QCheckBox>
+#include <QHash>
+#include <QJsonObject>
 #include <QJsonArray>
 #include <QMenu>
 #include <QLineEdit>
+#include <QListWidget>
+#include <QLabel>
 #include <QSettings>
 
+class HeatMapDelegate;
+
 class ProcessTab : public QWidget
 {
     Q_OBJECT
 public:
     explicit ProcessTab(QWidget *parent = nullptr);
+    // Sequence number to pass as "since" on the next get_process_events
+    qint64 lastEventSeq() const { return m_lastEventSeq; }
 
 signals:
     void killProcessRequested(int pid, const QString &signal);
     void addWhitelistRequested(const QString &pattern, const QString &matchType);
+    void processDetailsRequested(int pid);
 
 public slots:
     void updateProcessList(const QJsonArray &processes);
+    // Empty when the daemon is not monitoring cgroups; hides the grouping toggle
+    void updateCgroupList(const QJsonArray &cgroups);
+    void appendProcessEvents(const QJsonObject &response);
+    // Detection config (get_config layout); moves the heat-map ranges
+    void setDetectionThresholds(const QJsonObject &config);
 
 private slots:
     void showContextMenu(const QPoint &pos);
@@ -28,18 +44,32 @@ private slots:
     void onStopProcess();
     void onContinueProcess();
     void onAddToWhitelist();
+    void onShowDetails();
+    void setGroupedView(bool grouped);
 
 private:
     void setupUi();
+    void rebuildCgroupTree();
+    bool filterTreeItem(QTreeWidgetItem *item, const QString &text);
     int getSelectedPid() const;
     QString getSelectedName() const;
-    void applyRowColors(int row, double cpu, double memory, const QString &state);
     void filterTable(const QString &text);
     QString getSelectedCmdline() const;
 
     QTableWidget *m_table;
+    QTreeWidget *m_cgroupTree;
+    HeatMapDelegate *m_tableHeat;
+    HeatMapDelegate *m_treeHeat;
+    QCheckBox *m_groupCheck;
     QMenu *m_contextMenu;
     QLineEdit *m_searchEdit;
+    QLabel *m_activityLabel;
+    QListWidget *m_activityList;
+    qint64 m_lastEventSeq = 0;
+    // Latest snapshot, for nesting processes under their cgroup
+    QHash<int, QJsonObject> m_processesByPid;
+    QJsonArray m_cgroups;
+    static const int MAX_ACTIVITY_ITEMS = 200;
 };
 
 #endif
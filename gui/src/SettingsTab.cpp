@@ -3,8 +3,8 @@
 #include <QHBoxLayout>
 #include <QFormLayout>
 #include <QGroupBox>
-#include <QLabel>
 #include <QSettings>
+#include "FormatUtils.h"
 
 SettingsTab::SettingsTab(QWidget *parent)
     : QWidget(parent)
@@ -20,6 +20,13 @@ SettingsTab::SettingsTab(QWidget *parent)
     , m_normalInterval(new QSpinBox(this))
     , m_alertInterval(new QSpinBox(this))
     , m_notificationMethod(new QComboBox(this))
+    , m_collectorWorkers(new QSpinBox(this))
+    , m_retentionEnabled(new QCheckBox(tr("Roll up old alerts into hourly summaries"), this))
+    , m_rawAlertDays(new QSpinBox(this))
+    , m_rollupDays(new QSpinBox(this))
+    , m_dbSizeLabel(new QLabel(tr("-"), this))
+    , m_dbRowsLabel(new QLabel(tr("-"), this))
+    , m_compactButton(new QPushButton(tr("Compact Now"), this))
     , m_applyButton(new QPushButton(tr("Apply"), this))
     , m_resetButton(new QPushButton(tr("Reset"), this))
     , m_isModified(false)
@@ -94,8 +101,32 @@ void SettingsTab::setupUi()
     m_notificationMethod->addItem(tr("System only"), "system");
     m_notificationMethod->addItem(tr("Popup only"), "popup");
     generalLayout->addRow(tr("Notification:"), m_notificationMethod);
+    m_collectorWorkers->setRange(0, 64);
+    m_collectorWorkers->setSpecialValueText(tr("Auto"));
+    m_collectorWorkers->setToolTip(tr("Threads used to scan /proc; 1 scans serially"));
+    generalLayout->addRow(tr("Scan threads:"), m_collectorWorkers);
     mainLayout->addWidget(generalGroup);
 
+    // Data Retention Group
+    auto *retentionGroup = new QGroupBox(tr("Data Retention"), this);
+    auto *retentionLayout = new QFormLayout(retentionGroup);
+    retentionLayout->setContentsMargins(12, 12, 12, 12);
+    retentionLayout->addRow(m_retentionEnabled);
+    m_rawAlertDays->setRange(1, 3650);
+    m_rawAlertDays->setSuffix(tr(" days"));
+    retentionLayout->addRow(tr("Keep raw alerts:"), m_rawAlertDays);
+    m_rollupDays->setRange(0, 3650);
+    m_rollupDays->setSuffix(tr(" days"));
+    m_rollupDays->setSpecialValueText(tr("Forever"));
+    retentionLayout->addRow(tr("Keep summaries:"), m_rollupDays);
+    retentionLayout->addRow(tr("Database size:"), m_dbSizeLabel);
+    retentionLayout->addRow(tr("Stored rows:"), m_dbRowsLabel);
+    auto *compactLayout = new QHBoxLayout();
+    compactLayout->addStretch();
+    compactLayout->addWidget(m_compactButton);
+    retentionLayout->addRow(compactLayout);
+    mainLayout->addWidget(retentionGroup);
+
     // Buttons
     auto *buttonLayout = new QHBoxLayout();
     buttonLayout->addStretch();
@@ -124,6 +155,13 @@ void SettingsTab::setupUi()
     connect(m_normalInterval, QOverload<int>::of(&QSpinBox::valueChanged), this, &SettingsTab::onSettingChanged);
     connect(m_alertInterval, QOverload<int>::of(&QSpinBox::valueChanged), this, &SettingsTab::onSettingChanged);
     connect(m_notificationMethod, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &SettingsTab::onSettingChanged);
+    connect(m_collectorWorkers, QOverload<int>::of(&QSpinBox::valueChanged), this, &SettingsTab::onSettingChanged);
+
+    connect(m_retentionEnabled, &QCheckBox::toggled, this, &SettingsTab::onSettingChanged);
+    connect(m_rawAlertDays, QOverload<int>::of(&QSpinBox::valueChanged), this, &SettingsTab::onSettingChanged);
+    connect(m_rollupDays, QOverload<int>::of(&QSpinBox::valueChanged), this, &SettingsTab::onSettingChanged);
+
+    connect(m_compactButton, &QPushButton::clicked, this, &SettingsTab::compactDatabaseRequested);
 }
 
 void SettingsTab::loadGuiSettings()
@@ -156,6 +194,11 @@ void SettingsTab::loadSettings()
     m_normalInterval->setValue(10);
     m_alertInterval->setValue(2);
     m_notificationMethod->setCurrentIndex(0);
+    m_collectorWorkers->setValue(0);
+
+    m_retentionEnabled->setChecked(true);
+    m_rawAlertDays->setValue(30);
+    m_rollupDays->setValue(365);
 }
 
 void SettingsTab::loadConfig(const QJsonObject &config)
@@ -175,6 +218,10 @@ void SettingsTab::loadConfig(const QJsonObject &config)
     m_normalInterval->blockSignals(true);
     m_alertInterval->blockSignals(true);
     m_notificationMethod->blockSignals(true);
+    m_collectorWorkers->blockSignals(true);
+    m_retentionEnabled->blockSignals(true);
+    m_rawAlertDays->blockSignals(true);
+    m_rollupDays->blockSignals(true);
 
     // Load CPU High Detection settings
     if (config.contains("cpu_high")) {
@@ -210,6 +257,15 @@ void SettingsTab::loadConfig(const QJsonObject &config)
         if (index >= 0) {
             m_notificationMethod->setCurrentIndex(index);
         }
+        m_collectorWorkers->setValue(general["collector_workers"].toInt(0));
+    }
+
+    // Load Data Retention settings
+    if (config.contains("retention")) {
+        QJsonObject retention = config["retention"].toObject();
+        m_retentionEnabled->setChecked(retention["enabled"].toBool(true));
+        m_rawAlertDays->setValue(retention["raw_alert_days"].toInt(30));
+        m_rollupDays->setValue(retention["rollup_days"].toInt(365));
     }
 
     // Restore signals
@@ -224,6 +280,10 @@ void SettingsTab::loadConfig(const QJsonObject &config)
     m_normalInterval->blockSignals(false);
     m_alertInterval->blockSignals(false);
     m_notificationMethod->blockSignals(false);
+    m_collectorWorkers->blockSignals(false);
+    m_retentionEnabled->blockSignals(false);
+    m_rawAlertDays->blockSignals(false);
+    m_rollupDays->blockSignals(false);
 
     // Reset modified state after loading
     setModified(false);
@@ -248,6 +308,16 @@ void SettingsTab::setConnected(bool connected)
     m_normalInterval->setEnabled(connected);
     m_alertInterval->setEnabled(connected);
     m_notificationMethod->setEnabled(connected);
+    m_collectorWorkers->setEnabled(connected);
+
+    m_retentionEnabled->setEnabled(connected);
+    m_rawAlertDays->setEnabled(connected);
+    m_rollupDays->setEnabled(connected);
+    m_compactButton->setEnabled(connected);
+    if (!connected) {
+        m_dbSizeLabel->setText(tr("-"));
+        m_dbRowsLabel->setText(tr("-"));
+    }
 
     // Buttons depend on both connection state and modification state
     m_applyButton->setEnabled(connected && m_isModified);
@@ -297,11 +367,31 @@ QJsonObject SettingsTab::collectConfig() const
     general["sample_interval_normal"] = m_normalInterval->value();
     general["sample_interval_alert"] = m_alertInterval->value();
     general["notification_method"] = m_notificationMethod->currentData().toString();
+    general["collector_workers"] = m_collectorWorkers->value();
     config["general"] = general;
 
+    // Data Retention
+    QJsonObject retention;
+    retention["enabled"] = m_retentionEnabled->isChecked();
+    retention["raw_alert_days"] = m_rawAlertDays->value();
+    retention["rollup_days"] = m_rollupDays->value();
+    config["retention"] = retention;
+
     return config;
 }
 
+void SettingsTab::updateDbStats(const QJsonObject &stats)
+{
+    double sizeMb = stats["db_size_bytes"].toDouble() / (1024.0 * 1024.0);
+    double freeMb = stats["db_free_bytes"].toDouble() / (1024.0 * 1024.0);
+    m_dbSizeLabel->setText(tr("%1 (%2 reclaimable)")
+        .arg(FormatUtils::formatMemory(sizeMb), FormatUtils::formatMemory(freeMb)));
+    m_dbRowsLabel->setText(tr("%1 alerts, %2 hourly summaries, %3 samples")
+        .arg(stats["alert_count"].toInteger())
+        .arg(stats["rollup_count"].toInteger())
+        .arg(stats["sample_count"].toInteger()));
+}
+
 void SettingsTab::onApplyClicked()
 {
     QJsonObject config = collectConfig();
@@ -6,6 +6,7 @@
 #include <QCheckBox>
 #include <QComboBox>
 #include <QPushButton>
+#include <QLabel>
 #include <QJsonObject>
 
 class SettingsTab : public QWidget
@@ -17,10 +18,12 @@ public:
 signals:
     void settingsChanged();
     void configUpdateRequested(const QJsonObject &config);
+    void compactDatabaseRequested();
 
 public slots:
     void loadConfig(const QJsonObject &config);
     void setConnected(bool connected);
+    void updateDbStats(const QJsonObject &stats);
 
 private slots:
     void onApplyClicked();
@@ -53,6 +56,15 @@ private:
     QSpinBox *m_normalInterval;
     QSpinBox *m_alertInterval;
     QComboBox *m_notificationMethod;
+    QSpinBox *m_collectorWorkers;
+
+    // Data retention settings
+    QCheckBox *m_retentionEnabled;
+    QSpinBox *m_rawAlertDays;
+    QSpinBox *m_rollupDays;
+    QLabel *m_dbSizeLabel;
+    QLabel *m_dbRowsLabel;
+    QPushButton *m_compactButton;
 
     QPushButton *m_applyButton;
     QPushButton *m_resetButton;
@@ -0,0 +1,211 @@
+#include "TimeSeriesChart.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <algorithm>
+#include <cmath>
+
+TimeSeriesChart::TimeSeriesChart(const QString &title, QWidget *parent)
+    : QWidget(parent)
+    , m_title(title)
+    , m_format([](double value) { return QString::number(value, 'f', 1); })
+{
+    setMinimumSize(240, 140);
+    m_times.resize(CAPACITY);
+}
+
+void TimeSeriesChart::setSeries(const QStringList &names, const QVector<QColor> &colors)
+{
+    m_names = names;
+    m_colors = colors;
+    m_values = QVector<QVector<double>>(names.size(), QVector<double>(CAPACITY));
+    clear();
+}
+
+void TimeSeriesChart::setValueRange(double min, double max)
+{
+    m_fixedMin = min;
+    m_fixedMax = max;
+    m_dirty = true;
+    update();
+}
+
+void TimeSeriesChart::setValueFormatter(std::function<QString(double)> format)
+{
+    m_format = std::move(format);
+    update();
+}
+
+void TimeSeriesChart::append(qint64 timestamp, const QVector<double> &values)
+{
+    int slot;
+    if (m_count < CAPACITY) {
+        slot = ringIndex(m_count++);
+    } else {
+        slot = m_head;
+        m_head = (m_head + 1) % CAPACITY;
+    }
+    m_times[slot] = timestamp;
+    for (int s = 0; s < m_values.size(); ++s) {
+        m_values[s][slot] = s < values.size() ? values[s] : 0.0;
+    }
+    m_dirty = true;
+    update();  // No-op while the tab is hidden; the paths are rebuilt on the next paint
+}
+
+void TimeSeriesChart::clear()
+{
+    m_head = 0;
+    m_count = 0;
+    m_paths.clear();
+    m_dirty = true;
+    update();
+}
+
+QVector<QPointF> TimeSeriesChart::downsample(const QVector<QPointF> &points, int threshold)
+{
+    const int n = points.size();
+    if (threshold < 3 || threshold >= n) return points;
+
+    QVector<QPointF> sampled;
+    sampled.reserve(threshold);
+    sampled.append(points[0]);
+    const double every = double(n - 2) / (threshold - 2);
+    int previous = 0;
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Average of the next bucket
+        int avgStart = int((bucket + 1) * every) + 1;
+        int avgEnd = std::min(int((bucket + 2) * every) + 1, n);
+        double avgX = 0.0, avgY = 0.0;
+        for (int i = avgStart; i < avgEnd; ++i) {
+            avgX += points[i].x();
+            avgY += points[i].y();
+        }
+        int avgCount = std::max(1, avgEnd - avgStart);
+        avgX /= avgCount;
+        avgY /= avgCount;
+
+        // Point of this bucket with the largest triangle
+        int start = int(bucket * every) + 1;
+        int end = int((bucket + 1) * every) + 1;
+        const QPointF &a = points[previous];
+        double maxArea = -1.0;
+        int chosen = start;
+        for (int i = start; i < end; ++i) {
+            double area = std::abs((a.x() - avgX) * (points[i].y() - a.y())
+                                   - (a.x() - points[i].x()) * (avgY - a.y()));
+            if (area > maxArea) {
+                maxArea = area;
+                chosen = i;
+            }
+        }
+        sampled.append(points[chosen]);
+        previous = chosen;
+    }
+    sampled.append(points[n - 1]);
+    return sampled;
+}
+
+void TimeSeriesChart::rebuildPaths(const QRectF &plot)
+{
+    m_paths.clear();
+    m_pathsRect = plot;
+    m_dirty = false;
+    if (m_count == 0) return;
+
+    const qint64 newest = m_times[ringIndex(m_count - 1)];
+    const qint64 oldest = newest - SPAN_SECS;
+    int first = 0;
+    while (first < m_count && m_times[ringIndex(first)] < oldest) ++first;
+
+    if (m_fixedMax > m_fixedMin) {
+        m_yMin = m_fixedMin;
+        m_yMax = m_fixedMax;
+    } else {
+        double max = 0.0;
+        for (const QVector<double> &series : m_values) {
+            for (int i = first; i < m_count; ++i) max = std::max(max, series[ringIndex(i)]);
+        }
+        m_yMin = 0.0;
+        m_yMax = max > 0.0 ? max * 1.15 : 1.0;
+    }
+
+    const int threshold = std::max(3, int(plot.width() / 2));
+    QVector<QPointF> points;
+    points.reserve(m_count - first);
+    for (const QVector<double> &series : m_values) {
+        points.clear();
+        for (int i = first; i < m_count; ++i) {
+            int slot = ringIndex(i);
+            points.append(QPointF(double(m_times[slot] - newest), series[slot]));
+        }
+        QPolygonF path;
+        const QVector<QPointF> reduced = downsample(points, threshold);
+        path.reserve(reduced.size());
+        for (const QPointF &p : reduced) {
+            double y = std::clamp((p.y() - m_yMin) / (m_yMax - m_yMin), 0.0, 1.0);
+            path.append(QPointF(plot.right() + p.x() / SPAN_SECS * plot.width(),
+                                plot.bottom() - y * plot.height()));
+        }
+        m_paths.append(path);
+    }
+}
+
+void TimeSeriesChart::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    const QFontMetrics fm = fontMetrics();
+
+    // Title and legend with the latest values
+    int x = 4;
+    painter.setPen(palette().text().color());
+    QFont bold = font();
+    bold.setBold(true);
+    painter.setFont(bold);
+    painter.drawText(x, fm.ascent() + 2, m_title);
+    x += QFontMetrics(bold).horizontalAdvance(m_title) + 12;
+    painter.setFont(font());
+    for (int s = 0; s < m_names.size(); ++s) {
+        if (m_names[s].isEmpty()) continue;
+        QString label = m_count > 0 ? QStringLiteral("%1 %2").arg(m_names[s], m_format(m_values[s][ringIndex(m_count - 1)]))
+                                    : m_names[s];
+        painter.fillRect(x, 2 + fm.ascent() - 8, 8, 8, m_colors.value(s));
+        painter.drawText(x + 11, fm.ascent() + 2, label);
+        x += 11 + fm.horizontalAdvance(label) + 10;
+    }
+
+    const int leftMargin = fm.horizontalAdvance(m_format(m_yMax)) + 8;
+    QRectF plot = QRectF(rect()).adjusted(leftMargin, fm.height() + 8, -6, -(fm.height() + 6));
+    if (plot.width() < 10 || plot.height() < 10) return;
+    if (m_dirty || plot != m_pathsRect) rebuildPaths(plot);
+
+    // Grid at 0, 50 and 100% of the range
+    painter.setPen(palette().mid().color());
+    painter.drawRect(plot);
+    for (int step = 0; step <= 2; ++step) {
+        double y = plot.bottom() - plot.height() * step / 2.0;
+        if (step == 1) painter.drawLine(QPointF(plot.left(), y), QPointF(plot.right(), y));
+        QRectF labelRect(0, y - fm.height() / 2.0, leftMargin - 4, fm.height());
+        painter.setPen(palette().text().color());
+        painter.drawText(labelRect, Qt::AlignRight | Qt::AlignVCenter,
+                         m_format(m_yMin + (m_yMax - m_yMin) * step / 2.0));
+        painter.setPen(palette().mid().color());
+    }
+    painter.setPen(palette().text().color());
+    QRectF timeRect(plot.left(), plot.bottom() + 2, plot.width(), fm.height() + 2);
+    painter.drawText(timeRect, Qt::AlignLeft, tr("-%1 min").arg(SPAN_SECS / 60));
+    painter.drawText(timeRect, Qt::AlignRight, tr("now"));
+
+    if (m_count < 2) {
+        painter.drawText(plot, Qt::AlignCenter, tr("Collecting samples..."));
+        return;
+    }
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setClipRect(plot);
+    for (int s = 0; s < m_paths.size(); ++s) {
+        // Named series on top and thicker than the per-core lines
+        painter.setPen(QPen(m_colors.value(s), m_names[s].isEmpty() ? 1.0 : 1.8));
+        painter.drawPolyline(m_paths[s]);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef TIMESERIESCHART_H
+#define TIMESERIESCHART_H
+
+#include <QWidget>
+#include <QColor>
+#include <QPointF>
+#include <QPolygonF>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+// Scrolling line chart over the last hour. Samples go into a fixed ring of
+// CAPACITY entries; on append (or resize) each series is reduced with
+// Largest-Triangle-Three-Buckets to about one point per two pixels and cached
+// as a polyline, so painting costs the same after a minute or a day.
+class TimeSeriesChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TimeSeriesChart(const QString &title, QWidget *parent = nullptr);
+
+    // Replaces the series and drops all samples. Series with an empty name
+    // are drawn but left out of the legend.
+    void setSeries(const QStringList &names, const QVector<QColor> &colors);
+    int seriesCount() const { return m_names.size(); }
+    // Fixed y range; without one the range grows to fit the visible data
+    void setValueRange(double min, double max);
+    void setValueFormatter(std::function<QString(double)> format);
+    // One value per series
+    void append(qint64 timestamp, const QVector<double> &values);
+    void clear();
+
+    // Keeps the first and last point and, per bucket, the point forming the
+    // largest triangle with the previous pick and the next bucket's average
+    static QVector<QPointF> downsample(const QVector<QPointF> &points, int threshold);
+
+    static const int CAPACITY = 3600;
+    static const qint64 SPAN_SECS = 3600;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void rebuildPaths(const QRectF &plot);
+    int ringIndex(int i) const { return (m_head + i) % CAPACITY; }
+
+    QString m_title;
+    QStringList m_names;
+    QVector<QColor> m_colors;
+    // Ring: sample i (0 = oldest) is at ringIndex(i)
+    QVector<qint64> m_times;
+    QVector<QVector<double>> m_values;
+    int m_head = 0;
+    int m_count = 0;
+    double m_fixedMin = 0.0;
+    double m_fixedMax = -1.0;
+    std::function<QString(double)> m_format;
+
+    // Cached polylines in widget coordinates and the range they were built for
+    QVector<QPolygonF> m_paths;
+    QRectF m_pathsRect;
+    double m_yMax = 1.0;
+    double m_yMin = 0.0;
+    bool m_dirty = true;
+};
+
+#endif
@@ -1,6 +1,11 @@
 #include "TrayIcon.h"
 #include "MainWindow.h"
 #include <QApplication>
+#include <QJsonObject>
+#include <QMap>
+#include <QPainter>
+#include <QPixmap>
+#include <QScreen>
 
 TrayIcon::TrayIcon(MainWindow *mainWindow, QObject *parent)
     : QSystemTrayIcon(parent)
@@ -10,12 +15,22 @@ TrayIcon::TrayIcon(MainWindow *mainWindow, QObject *parent)
     , m_isPaused(false)
     , m_processCount(0)
     , m_alertCount(0)
+    , m_pressure(0)
+    , m_stalled(false)
+    , m_shownKey(~quint64(0))
     , m_statusAction(nullptr)
     , m_pauseAction(nullptr)
     , m_clearAlertsAction(nullptr)
 {
+    m_statusIcons[int(Status::Normal)] = QIcon(":/icons/tray_normal.png");
+    m_statusIcons[int(Status::Warning)] = QIcon(":/icons/tray_warning.png");
+    m_statusIcons[int(Status::Critical)] = QIcon(":/icons/tray_critical.png");
+    m_statusIcons[int(Status::Paused)] = QIcon(":/icons/tray_paused.png");
+
     setupMenu();
-    updateIcon();
+    // Renders the icon for the current scale
+    watchScreen(QGuiApplication::primaryScreen());
+    connect(qApp, &QGuiApplication::primaryScreenChanged, this, &TrayIcon::watchScreen);
     updateTooltip();
     connect(this, &QSystemTrayIcon::activated, this, &TrayIcon::onActivated);
 }
@@ -31,9 +46,71 @@ void TrayIcon::setStatus(Status status)
 
 void TrayIcon::updateStatusInfo(int processCount, int alertCount)
 {
+    if (processCount == m_processCount && alertCount == m_alertCount) return;
+
+    bool alertsChanged = alertCount != m_alertCount;
     m_processCount = processCount;
     m_alertCount = alertCount;
-    m_clearAlertsAction->setEnabled(alertCount > 0);
+    if (alertsChanged) {
+        m_clearAlertsAction->setEnabled(alertCount > 0);
+        updateIcon();
+        updateTooltip();
+    }
+}
+
+void TrayIcon::setPressure(int percent, bool stalled)
+{
+    // Repaint in 10% steps; the tray does not need every percent
+    int bucket = qBound(0, (percent + 5) / 10 * 10, 100);
+    if (bucket == m_pressure && stalled == m_stalled) return;
+    m_pressure = bucket;
+    m_stalled = stalled;
+    updateIcon();
+    updateTooltip();
+}
+
+void TrayIcon::showAlertDigest(const QJsonArray &alerts)
+{
+    if (alerts.isEmpty()) return;
+
+    if (alerts.size() == 1) {
+        QJsonObject alert = alerts.first().toObject();
+        showMessage(tr("RunawayGuard: %1 (%2)").arg(alert["name"].toString(), alert["severity"].toString()),
+                    tr("PID %1 - %2").arg(alert["pid"].toInt()).arg(alert["reason"].toString()),
+                    QSystemTrayIcon::Warning, 5000);
+        return;
+    }
+
+    // Group by reason: "37 processes exceeded CPU"
+    QMap<QString, int> countByReason;
+    int criticalCount = 0;
+    for (const auto &val : alerts) {
+        QJsonObject alert = val.toObject();
+        countByReason[alert["reason"].toString()]++;
+        if (alert["severity"].toString() == "critical") {
+            criticalCount++;
+        }
+    }
+
+    QStringList lines;
+    for (auto it = countByReason.constBegin(); it != countByReason.constEnd(); ++it) {
+        QString processes = it.value() == 1 ? tr("process") : tr("processes");
+        if (it.key() == "cpu_high") {
+            lines.append(tr("%1 %2 exceeded CPU").arg(it.value()).arg(processes));
+        } else if (it.key() == "memory_leak") {
+            lines.append(tr("%1 %2 leaking memory").arg(it.value()).arg(processes));
+        } else if (it.key() == "hang") {
+            lines.append(tr("%1 %2 hung").arg(it.value()).arg(processes));
+        } else {
+            lines.append(tr("%1 %2: %3").arg(it.value()).arg(processes, it.key()));
+        }
+    }
+
+    QString title = criticalCount > 0
+        ? tr("RunawayGuard: %1 alerts (%2 critical)").arg(alerts.size()).arg(criticalCount)
+        : tr("RunawayGuard: %1 alerts").arg(alerts.size());
+    showMessage(title, lines.join("\n"),
+                criticalCount > 0 ? QSystemTrayIcon::Critical : QSystemTrayIcon::Warning, 5000);
 }
 
 void TrayIcon::onActivated(QSystemTrayIcon::ActivationReason reason)
@@ -106,24 +183,79 @@ void TrayIcon::onPauseToggled()
     }
 }
 
+quint64 TrayIcon::badgeKey(qreal dpr) const
+{
+    // No badge or bar while disconnected (the counts are stale) or paused
+    bool live = m_status == Status::Normal || m_status == Status::Warning;
+    quint64 count = live ? quint64(qMin(m_alertCount, MAX_BADGE_COUNT + 1)) : 0;
+    quint64 pressure = live ? quint64(m_pressure / 10) : 0;
+    quint64 stalled = live && m_stalled ? 1 : 0;
+    return quint64(m_status) | count << 2 | pressure << 6 | stalled << 10 | quint64(qRound(dpr * 100)) << 11;
+}
+
+QIcon TrayIcon::renderIcon(qreal dpr) const
+{
+    const QIcon &base = m_statusIcons[int(m_status)];
+    bool live = m_status == Status::Normal || m_status == Status::Warning;
+    if (!live || (m_alertCount == 0 && m_pressure == 0)) return base;
+
+    const int size = 32;
+    QPixmap pixmap = base.pixmap(QSize(size, size), dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    if (m_pressure > 0) {
+        // Pressure gauge: a thin bar along the bottom, red while stalling
+        QRectF bar(0, size - size / 8.0, size * m_pressure / 100.0, size / 8.0);
+        painter.fillRect(bar, m_stalled ? QColor(0xd9, 0x53, 0x4f) : QColor(0xf0, 0xad, 0x4e));
+    }
+
+    if (m_alertCount > 0) {
+        QString text = m_alertCount > MAX_BADGE_COUNT ? QStringLiteral("%1+").arg(MAX_BADGE_COUNT)
+                                                      : QString::number(m_alertCount);
+        QFont font = QApplication::font();
+        font.setBold(true);
+        font.setPixelSize(size * 9 / 16);
+        painter.setFont(font);
+        const qreal height = size * 0.6;
+        const qreal width = qMax(height, QFontMetricsF(font).horizontalAdvance(text) + size / 8.0);
+        QRectF badge(size - width, 0, width, height);
+        painter.setPen(QPen(Qt::white, 1.5));
+        painter.setBrush(QColor(0xd9, 0x53, 0x4f));
+        painter.drawRoundedRect(badge, height / 2, height / 2);
+        painter.drawText(badge, Qt::AlignCenter, text);
+    }
+    painter.end();
+    return QIcon(pixmap);
+}
+
 void TrayIcon::updateIcon()
 {
-    QString iconPath;
-    switch (m_status) {
-        case Status::Normal:
-            iconPath = ":/icons/tray_normal.png";
-            break;
-        case Status::Warning:
-            iconPath = ":/icons/tray_warning.png";
-            break;
-        case Status::Critical:
-            iconPath = ":/icons/tray_critical.png";
-            break;
-        case Status::Paused:
-            iconPath = ":/icons/tray_paused.png";
-            break;
+    QScreen *screen = QGuiApplication::primaryScreen();
+    const qreal dpr = screen ? screen->devicePixelRatio() : 1.0;
+    const quint64 key = badgeKey(dpr);
+    if (key == m_shownKey) return;  // Nothing visible changed; leave the tray host alone
+
+    auto it = m_iconCache.constFind(key);
+    if (it == m_iconCache.constEnd()) {
+        if (m_iconCache.size() >= ICON_CACHE_LIMIT) m_iconCache.clear();
+        it = m_iconCache.insert(key, renderIcon(dpr));
     }
-    setIcon(QIcon(iconPath));
+    m_shownKey = key;
+    setIcon(it.value());
+}
+
+void TrayIcon::watchScreen(QScreen *screen)
+{
+    if (m_watchedScreen) disconnect(m_watchedScreen, nullptr, this, nullptr);
+    m_watchedScreen = screen;
+    if (screen) {
+        // Scale changes on the same screen (display settings, monitor hotplug)
+        connect(screen, &QScreen::logicalDotsPerInchChanged, this, &TrayIcon::updateIcon);
+        connect(screen, &QScreen::physicalDotsPerInchChanged, this, &TrayIcon::updateIcon);
+    }
+    updateIcon();
 }
 
 void TrayIcon::updateTooltip()
@@ -143,5 +275,9 @@ void TrayIcon::updateTooltip()
             tooltip = tr("RunawayGuard - Monitoring paused");
             break;
     }
+    if (m_pressure > 0) {
+        tooltip += m_stalled ? tr("\nSystem stalling (pressure %1%)").arg(m_pressure)
+                             : tr("\nPressure %1%").arg(m_pressure);
+    }
     setToolTip(tooltip);
 }
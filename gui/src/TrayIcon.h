@@ -4,9 +4,19 @@
 #include <QSystemTrayIcon>
 #include <QMenu>
 #include <QAction>
+#include <QJsonArray>
+#include <QHash>
+#include <QIcon>
+#include <QPointer>
 
 class MainWindow;
+class QScreen;
 
+// Tray icon with a live badge: the status icon, the unacknowledged alert
+// count in a corner and a pressure bar along the bottom. Rendered icons are
+// cached by what they show (status, count bucket, pressure step, device
+// pixel ratio) and handed to the tray host only when that changes, so
+// status frames that change nothing visible cost nothing.
 class TrayIcon : public QSystemTrayIcon
 {
     Q_OBJECT
@@ -17,6 +27,11 @@ public:
     enum class Status { Normal, Warning, Critical, Paused };
     void setStatus(Status status);
     void updateStatusInfo(int processCount, int alertCount);
+    // Worst resource stall share (percent), drawn as a bar on the icon
+    void setPressure(int percent, bool stalled);
+    // Counts shown on the badge; more show as "9+"
+    static const int MAX_BADGE_COUNT = 9;
+    void showAlertDigest(const QJsonArray &alerts);
 
 signals:
     void pauseRequested();
@@ -32,6 +47,11 @@ private:
     void setupMenu();
     void updateIcon();
     void updateTooltip();
+    // Re-render when this screen's scale changes; follows the primary screen
+    void watchScreen(QScreen *screen);
+    // Everything the icon shows, packed; equal keys render identical icons
+    quint64 badgeKey(qreal dpr) const;
+    QIcon renderIcon(qreal dpr) const;
 
     MainWindow *m_mainWindow;
     QMenu *m_menu;
@@ -39,6 +59,15 @@ private:
     bool m_isPaused;
     int m_processCount;
     int m_alertCount;
+    int m_pressure;
+    bool m_stalled;
+    // Base icon per Status, loaded from resources once
+    QIcon m_statusIcons[4];
+    QHash<quint64, QIcon> m_iconCache;
+    quint64 m_shownKey;
+    QPointer<QScreen> m_watchedScreen;
+    // Enough for every status and count at one DPI several times over
+    static const int ICON_CACHE_LIMIT = 128;
 
     QAction *m_statusAction;
     QAction *m_pauseAction;
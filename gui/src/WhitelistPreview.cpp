@@ -0,0 +1,148 @@
+#include "WhitelistPreview.h"
+#include <QJsonObject>
+
+WhitelistPreviewWorker::WhitelistPreviewWorker(QObject *parent)
+    : QObject(parent)
+    , m_latestRequest(0)
+{
+}
+
+quint64 WhitelistPreviewWorker::nextRequest()
+{
+    return m_latestRequest.fetchAndAddRelaxed(1) + 1;
+}
+
+bool WhitelistPreviewWorker::isCurrent(quint64 requestId) const
+{
+    return m_latestRequest.loadRelaxed() == requestId;
+}
+
+void WhitelistPreviewWorker::setProcesses(const QJsonArray &processes)
+{
+    // Converted once per snapshot so keystrokes only pay for the matching
+    m_processes.clear();
+    m_processes.reserve(processes.size());
+    for (const QJsonValue &value : processes) {
+        QJsonObject proc = value.toObject();
+        m_processes.append({proc["pid"].toInt(), proc["name"].toString(), proc["cmdline"].toString()});
+    }
+}
+
+QString WhitelistPreviewWorker::unsupportedSyntax(const QString &pattern)
+{
+    bool inClass = false;
+    for (int i = 0; i < pattern.size(); ++i) {
+        const QChar c = pattern[i];
+        const QChar next = i + 1 < pattern.size() ? pattern[i + 1] : QChar();
+
+        if (c == '\\') {
+            if ((next >= '1' && next <= '9') || next == 'g' || next == 'k') {
+                return tr("backreferences are not supported");
+            }
+            if (next == 'K' || next == 'G' || next == 'Z') {
+                return tr("\\%1 is not supported").arg(next);
+            }
+            ++i;
+            continue;
+        }
+        if (inClass) {
+            // A ']' right after '[' or '[^' is a literal, not the end
+            if (c == ']' && pattern[i - 1] != '[' && !(pattern[i - 1] == '^' && pattern[i - 2] == '[')) {
+                inClass = false;
+            }
+            continue;
+        }
+        if (c == '[') {
+            inClass = true;
+            continue;
+        }
+        if (c == '(' && next == '?') {
+            const QStringView group = QStringView(pattern).mid(i + 2);
+            if (group.startsWith('=') || group.startsWith('!')
+                || group.startsWith(u"<=") || group.startsWith(u"<!")) {
+                return tr("lookahead and lookbehind are not supported");
+            }
+            if (group.startsWith('>')) {
+                return tr("atomic groups are not supported");
+            }
+            if (group.startsWith('(')) {
+                return tr("conditionals are not supported");
+            }
+            const bool numbered = !group.isEmpty() && (group[0].isDigit()
+                || ((group[0] == '+' || group[0] == '-') && group.size() > 1 && group[1].isDigit()));
+            if (numbered || group.startsWith('R') || group.startsWith('&') || group.startsWith(u"P>")) {
+                return tr("recursion is not supported");
+            }
+            if (group.startsWith('|')) {
+                return tr("branch reset groups are not supported");
+            }
+            ++i;  // the '?' opens a group, it is not a quantifier
+            continue;
+        }
+        if ((c == '*' || c == '+' || c == '?' || c == '}') && next == '+') {
+            return tr("possessive quantifiers are not supported");
+        }
+    }
+    return QString();
+}
+
+const QRegularExpression &WhitelistPreviewWorker::compiled(const QString &pattern)
+{
+    auto it = m_regexCache.find(pattern);
+    if (it == m_regexCache.end()) {
+        if (m_regexCache.size() >= REGEX_CACHE_SIZE) {
+            m_regexCache.clear();
+        }
+        QRegularExpression re(pattern);
+        re.optimize();
+        it = m_regexCache.insert(pattern, re);
+    }
+    return it.value();
+}
+
+void WhitelistPreviewWorker::match(quint64 requestId, const QString &pattern, const QString &matchType)
+{
+    // Requests queued behind a slow scan are dropped without running
+    if (!isCurrent(requestId)) return;
+
+    const QRegularExpression *re = nullptr;
+    if (matchType == "regex") {
+        re = &compiled(pattern);
+        if (!re->isValid()) {
+            emit previewReady(requestId, {}, 0, re->errorString());
+            return;
+        }
+        // Never preview matches for a pattern the daemon will refuse
+        QString unsupported = unsupportedSyntax(pattern);
+        if (!unsupported.isEmpty()) {
+            emit previewReady(requestId, {}, 0, unsupported);
+            return;
+        }
+    }
+
+    QStringList rows;
+    int total = 0;
+    for (int i = 0; i < m_processes.size(); ++i) {
+        if (i % CANCEL_CHECK_INTERVAL == 0 && !isCurrent(requestId)) return;
+
+        const Process &proc = m_processes[i];
+        bool matched;
+        if (matchType == "name") {
+            matched = proc.name == pattern;
+        } else if (matchType == "cmdline") {
+            matched = proc.cmdline.contains(pattern);
+        } else {
+            matched = re->match(proc.name).hasMatch()
+                || (!proc.cmdline.isEmpty() && re->match(proc.cmdline).hasMatch());
+        }
+        if (!matched) continue;
+
+        ++total;
+        if (rows.size() < MAX_PREVIEW_ROWS) {
+            rows.append(QStringLiteral("%1  %2  %3").arg(proc.pid).arg(proc.name, proc.cmdline));
+        }
+    }
+    if (isCurrent(requestId)) {
+        emit previewReady(requestId, rows, total, QString());
+    }
+}
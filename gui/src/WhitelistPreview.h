@@ -0,0 +1,61 @@
+#ifndef WHITELISTPREVIEW_H
+#define WHITELISTPREVIEW_H
+
+#include <QObject>
+#include <QJsonArray>
+#include <QHash>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVector>
+#include <QAtomicInteger>
+
+// Matches a whitelist pattern against the latest process snapshot the same
+// way the daemon will (name: exact, cmdline: substring, regex: name or
+// command line). Lives on its own thread so a slow pattern over tens of
+// thousands of command lines never blocks the UI. Every request gets an id
+// from nextRequest(); a newer id cancels the scan in progress.
+class WhitelistPreviewWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WhitelistPreviewWorker(QObject *parent = nullptr);
+
+    // Thread-safe; call before queuing match(). Supersedes any running scan.
+    quint64 nextRequest();
+
+    // Why the daemon's regex engine (Rust `regex`, no backtracking) would
+    // refuse a pattern QRegularExpression accepts: lookarounds,
+    // backreferences, atomic groups, possessive quantifiers, recursion and
+    // conditionals. Empty if there is no such construct.
+    static QString unsupportedSyntax(const QString &pattern);
+
+    // Rows listed in previewReady; the total is always exact
+    static const int MAX_PREVIEW_ROWS = 200;
+
+public slots:
+    void setProcesses(const QJsonArray &processes);
+    void match(quint64 requestId, const QString &pattern, const QString &matchType);
+
+signals:
+    // error is set (and rows empty) when the regex does not compile
+    void previewReady(quint64 requestId, const QStringList &rows, int total, const QString &error);
+
+private:
+    struct Process {
+        int pid;
+        QString name;
+        QString cmdline;
+    };
+
+    bool isCurrent(quint64 requestId) const;
+    const QRegularExpression &compiled(const QString &pattern);
+
+    QVector<Process> m_processes;
+    QHash<QString, QRegularExpression> m_regexCache;
+    QAtomicInteger<quint64> m_latestRequest;
+    static const int REGEX_CACHE_SIZE = 32;
+    static const int CANCEL_CHECK_INTERVAL = 256;
+};
+
+#endif
@@ -1,9 +1,12 @@
 #include "WhitelistTab.h"
+#include "WhitelistPreview.h"
+#include <QThread>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QLabel>
 #include <QJsonObject>
+#include <QRegularExpression>
 
 WhitelistTab::WhitelistTab(QWidget *parent)
     : QWidget(parent)
@@ -12,10 +15,25 @@ WhitelistTab::WhitelistTab(QWidget *parent)
     , m_matchTypeCombo(new QComboBox(this))
     , m_addButton(new QPushButton(tr("Add"), this))
     , m_removeButton(new QPushButton(tr("Remove"), this))
+    , m_previewLabel(new QLabel(this))
+    , m_previewList(new QListWidget(this))
+    , m_previewThread(new QThread(this))
+    , m_previewWorker(new WhitelistPreviewWorker)
 {
+    m_previewWorker->moveToThread(m_previewThread);
+    connect(m_previewThread, &QThread::finished, m_previewWorker, &QObject::deleteLater);
+    connect(m_previewWorker, &WhitelistPreviewWorker::previewReady, this, &WhitelistTab::onPreviewReady);
+    m_previewThread->start();
     setupUi();
 }
 
+WhitelistTab::~WhitelistTab()
+{
+    m_previewWorker->nextRequest();  // Abandon any scan in progress
+    m_previewThread->quit();
+    m_previewThread->wait();
+}
+
 void WhitelistTab::setupUi()
 {
     auto *layout = new QVBoxLayout(this);
@@ -33,6 +51,10 @@ void WhitelistTab::setupUi()
     m_matchTypeCombo->addItem(tr("Name"), "name");
     m_matchTypeCombo->addItem(tr("Command"), "cmdline");
     m_matchTypeCombo->addItem(tr("Regex"), "regex");
+    m_matchTypeCombo->setItemData(0, tr("Exact process name"), Qt::ToolTipRole);
+    m_matchTypeCombo->setItemData(1, tr("Text anywhere in the command line"), Qt::ToolTipRole);
+    m_matchTypeCombo->setItemData(2, tr("Regular expression tested against the name and the command line"),
+                                  Qt::ToolTipRole);
     inputLayout->addWidget(m_matchTypeCombo);
 
     inputLayout->addWidget(m_addButton);
@@ -51,12 +73,82 @@ void WhitelistTab::setupUi()
     m_table->setColumnWidth(1, 100);
     m_table->setAlternatingRowColors(true);
     m_table->verticalHeader()->setDefaultSectionSize(m_table->verticalHeader()->defaultSectionSize() + 4);
-    layout->addWidget(m_table);
+    layout->addWidget(m_table, 1);
+
+    // Processes the pattern would silence, updated as you type
+    layout->addWidget(m_previewLabel);
+    m_previewList->setMaximumHeight(150);
+    m_previewList->setSelectionMode(QAbstractItemView::NoSelection);
+    layout->addWidget(m_previewList);
+    m_previewLabel->setVisible(false);
+    m_previewList->setVisible(false);
 
     // Connections
     connect(m_addButton, &QPushButton::clicked, this, &WhitelistTab::onAddClicked);
     connect(m_removeButton, &QPushButton::clicked, this, &WhitelistTab::onRemoveClicked);
     connect(m_patternEdit, &QLineEdit::returnPressed, this, &WhitelistTab::onAddClicked);
+    connect(m_patternEdit, &QLineEdit::textChanged, this, &WhitelistTab::requestPreview);
+    connect(m_matchTypeCombo, &QComboBox::currentIndexChanged, this, &WhitelistTab::requestPreview);
+}
+
+void WhitelistTab::setProcessSnapshot(const QJsonArray &processes)
+{
+    WhitelistPreviewWorker *worker = m_previewWorker;
+    QMetaObject::invokeMethod(worker, [worker, processes]() { worker->setProcesses(processes); },
+                              Qt::QueuedConnection);
+    if (!m_patternEdit->text().trimmed().isEmpty()) {
+        requestPreview();
+    }
+}
+
+void WhitelistTab::requestPreview()
+{
+    setPatternError(QString());
+    QString pattern = m_patternEdit->text().trimmed();
+    // Taking a new id cancels whatever the worker is matching now
+    m_previewRequest = m_previewWorker->nextRequest();
+    if (pattern.isEmpty()) {
+        m_previewLabel->setVisible(false);
+        m_previewList->setVisible(false);
+        m_previewList->clear();
+        return;
+    }
+    m_previewLabel->setText(tr("Matching..."));
+    m_previewLabel->setVisible(true);
+    WhitelistPreviewWorker *worker = m_previewWorker;
+    quint64 requestId = m_previewRequest;
+    QString matchType = m_matchTypeCombo->currentData().toString();
+    QMetaObject::invokeMethod(worker, [worker, requestId, pattern, matchType]() {
+        worker->match(requestId, pattern, matchType);
+    }, Qt::QueuedConnection);
+}
+
+void WhitelistTab::onPreviewReady(quint64 requestId, const QStringList &rows, int total, const QString &error)
+{
+    if (requestId != m_previewRequest) return;
+
+    m_previewList->clear();
+    if (!error.isEmpty()) {
+        setPatternError(tr("Invalid regular expression: %1").arg(error));
+        m_previewLabel->setText(tr("Invalid regular expression: %1").arg(error));
+        m_previewList->setVisible(false);
+        return;
+    }
+    if (total == 0) {
+        m_previewLabel->setText(tr("No running process matches"));
+    } else if (total > rows.size()) {
+        m_previewLabel->setText(tr("%1 running processes match (showing %2)").arg(total).arg(rows.size()));
+    } else {
+        m_previewLabel->setText(tr("%n running process(es) match", nullptr, total));
+    }
+    m_previewList->addItems(rows);
+    m_previewList->setVisible(total > 0);
+}
+
+void WhitelistTab::setPatternError(const QString &error)
+{
+    m_patternEdit->setStyleSheet(error.isEmpty() ? QString() : QStringLiteral("border: 1px solid #c62828;"));
+    m_patternEdit->setToolTip(error);
 }
 
 void WhitelistTab::updateWhitelistDisplay(const QJsonArray &whitelist)
@@ -91,6 +183,19 @@ void WhitelistTab::onAddClicked()
     if (pattern.isEmpty()) return;
 
     QString matchType = m_matchTypeCombo->currentData().toString();
+    if (matchType == "regex") {
+        QRegularExpression re(pattern);
+        if (!re.isValid()) {
+            // The daemon rejects it too; say why instead of silently dropping it
+            setPatternError(tr("Invalid regular expression: %1").arg(re.errorString()));
+            return;
+        }
+        QString unsupported = WhitelistPreviewWorker::unsupportedSyntax(pattern);
+        if (!unsupported.isEmpty()) {
+            setPatternError(tr("Invalid regular expression: %1").arg(unsupported));
+            return;
+        }
+    }
     emit addWhitelistRequested(pattern, matchType);
     m_patternEdit->clear();
 }
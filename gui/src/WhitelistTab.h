@@ -6,13 +6,19 @@
 #include <QLineEdit>
 #include <QComboBox>
 #include <QPushButton>
+#include <QListWidget>
+#include <QLabel>
 #include <QJsonArray>
 
+class QThread;
+class WhitelistPreviewWorker;
+
 class WhitelistTab : public QWidget
 {
     Q_OBJECT
 public:
     explicit WhitelistTab(QWidget *parent = nullptr);
+    ~WhitelistTab() override;
 
 signals:
     void addWhitelistRequested(const QString &pattern, const QString &matchType);
@@ -21,19 +27,29 @@ signals:
 public slots:
     void updateWhitelistDisplay(const QJsonArray &whitelist);
     void addEntry(const QString &pattern, const QString &matchType);
+    // Latest process list, used for the live preview
+    void setProcessSnapshot(const QJsonArray &processes);
 
 private slots:
     void onAddClicked();
     void onRemoveClicked();
+    void requestPreview();
+    void onPreviewReady(quint64 requestId, const QStringList &rows, int total, const QString &error);
 
 private:
     void setupUi();
+    void setPatternError(const QString &error);
 
     QTableWidget *m_table;
     QLineEdit *m_patternEdit;
     QComboBox *m_matchTypeCombo;
     QPushButton *m_addButton;
     QPushButton *m_removeButton;
+    QLabel *m_previewLabel;
+    QListWidget *m_previewList;
+    QThread *m_previewThread;
+    WhitelistPreviewWorker *m_previewWorker;
+    quint64 m_previewRequest = 0;
 };
 
 #endif
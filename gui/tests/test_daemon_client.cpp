@@ -36,6 +36,13 @@ private slots:
         QVERIFY(spy.isValid());
     }
 
+    void testAlertsBatchReceivedSignal()
+    {
+        DaemonClient client;
+        QSignalSpy spy(&client, &DaemonClient::alertsBatchReceived);
+        QVERIFY(spy.isValid());
+    }
+
     void testStatusReceivedSignal()
     {
         DaemonClient client;